@@ -0,0 +1,103 @@
+/**
+ * Random lookups into a big hash map, with it's arrays from malloc and then
+ * from huge page mappings, counting the time and the dTLB load misses.
+ * Build: gcc -O2 -DDS_BIGALLOC -Iinclude bench/bench_bigalloc.c src/primes.c src/bigalloc.c -o bench_bigalloc
+ * Usage: ./bench_bigalloc [amount of keys]
+ * @note The misses are read with perf_event_open, where it's not permitted
+ * only the time is shown. Huge pages need transparent huge pages enabled, see
+ * /sys/kernel/mm/transparent_hugepage/enabled.
+*/
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include<string.h>
+#include<time.h>
+#include<unistd.h>
+#include<sys/ioctl.h>
+#include<sys/syscall.h>
+#include<linux/perf_event.h>
+#include "hashmap.h"
+
+uint64_t hash(const uint64_t *key) {
+  uint64_t h = *key * 0x9e3779b97f4a7c15ull;
+  return h ^ (h >> 29);
+}
+bool keycmp(const uint64_t *key1, const uint64_t *key2) {
+  return *key1 == *key2;
+}
+
+HashMap(Map, uint64_t, uint64_t, uint64_t, hash, keycmp)
+
+static double now_sec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t next_random(uint64_t *state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+/**Open a counter of dTLB load misses of this thread, -1 if not permitted.*/
+static int open_dtlb_counter() {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static uint64_t sink;
+
+/* Fill a map with `n` keys, then look up `n` random keys of it. */
+static void run(const char *name, size_t n, int counter) {
+  Map *map = Map_snew(n + 1);
+  for (uint64_t key = 0; key < n; key++) Map_put(map, &key, &key);
+
+  uint64_t state = 7, misses = 0;
+  if (counter >= 0) {
+    ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+    ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+  }
+  double start = now_sec();
+  for (size_t i = 0; i < n; i++) {
+    uint64_t key = next_random(&state) % n;
+    sink += *Map_get(map, &key);
+  }
+  double end = now_sec();
+  if (counter >= 0) {
+    ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(counter, &misses, sizeof(misses)) != sizeof(misses)) misses = 0;
+  }
+
+  printf("%-12s %6.1f ns/get", name, (end - start) * 1e9 / n);
+  if (counter >= 0) printf("   %6.3f dTLB misses/get", (double)misses / n);
+  printf("\n");
+  Map_free(map);
+}
+
+int main(int argc, char *argv[]) {
+  size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 20000000;
+  int counter = open_dtlb_counter();
+  if (counter < 0) printf("dTLB misses can't be counted here, only time is shown.\n");
+  printf("Random gets, %zu keys, %zu MB of entries:\n", n,
+    n * sizeof(Map_entry_t) >> 20);
+
+  ds_bigalloc_set_threshold(SIZE_MAX);
+  run("malloc", n, counter);
+  ds_bigalloc_set_threshold(0);
+  run("huge pages", n, counter);
+  ds_bigalloc_set_numa(DS_NUMA_INTERLEAVE);
+  run("interleaved", n, counter);
+
+  if (counter >= 0) close(counter);
+  return sink == 42;
+}
@@ -0,0 +1,120 @@
+/**
+ * Lookup latency of the chained hash map against the cuckoo hash map.
+ * Every lookup is timed on it's own, and the percentiles are printed for hits
+ * and for misses.
+ * Build: gcc -O2 -Iinclude bench/bench_cuckoomap.c src/primes.c -o bench_cuckoomap
+ * Usage: ./bench_cuckoomap [amount of keys]
+*/
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include<time.h>
+#include "hashmap.h"
+#include "cuckoomap.h"
+
+uint64_t hash(const uint64_t *key) {
+  uint64_t h = *key * 0x9e3779b97f4a7c15ull;
+  return h ^ (h >> 29);
+}
+bool keycmp(const uint64_t *key1, const uint64_t *key2) {
+  return *key1 == *key2;
+}
+
+HashMap(Chained, uint64_t, uint64_t, uint64_t, hash, keycmp)
+CuckooMap(Cuckoo, uint64_t, uint64_t, uint64_t, hash, keycmp)
+
+static uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static uint64_t next_random(uint64_t *state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+static int compare(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+  return (x > y) - (x < y);
+}
+
+static void report(const char *name, uint64_t *times, size_t n, uint64_t overhead) {
+  qsort(times, n, sizeof(uint64_t), compare);
+  #define PCT(p) (times[(size_t)((n - 1) * (p))] > overhead ? \
+    times[(size_t)((n - 1) * (p))] - overhead : 0)
+  printf("%-16s p50 %5llu  p99 %5llu  p99.9 %5llu  max %7llu ns\n", name,
+    (unsigned long long)PCT(0.5), (unsigned long long)PCT(0.99),
+    (unsigned long long)PCT(0.999), (unsigned long long)(times[n - 1] - overhead));
+  #undef PCT
+}
+
+int main(int argc, char *argv[]) {
+  size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+  uint64_t *keys = malloc(n * sizeof(uint64_t));
+  uint64_t *misses = malloc(n * sizeof(uint64_t));
+  uint64_t *times = malloc(n * sizeof(uint64_t));
+  uint64_t state = 1, sum = 0;
+  for (size_t i = 0; i < n; i++) keys[i] = next_random(&state) | 1;
+  for (size_t i = 0; i < n; i++) misses[i] = next_random(&state) & ~1ull;
+
+  /* The cost of reading the clock, subtracted from every sample. */
+  uint64_t overhead = UINT64_MAX;
+  for (int i = 0; i < 1000; i++) {
+    uint64_t start = now_ns(), t = now_ns() - start;
+    if (t < overhead) overhead = t;
+  }
+
+  Chained *chained = Chained_new();
+  Cuckoo *cuckoo = Cuckoo_new();
+  uint64_t start = now_ns();
+  for (size_t i = 0; i < n; i++) Chained_put(chained, &keys[i], &keys[i]);
+  printf("chained insert   %.1f ns/op, load %.2f\n",
+    (double)(now_ns() - start) / n, (double)chained->size / chained->cap);
+  start = now_ns();
+  for (size_t i = 0; i < n; i++) Cuckoo_put(cuckoo, &keys[i], &keys[i]);
+  printf("cuckoo insert    %.1f ns/op, load %.2f\n",
+    (double)(now_ns() - start) / n, (double)cuckoo->size / cuckoo->cap);
+
+  for (size_t i = 0; i < n; i++) {
+    start = now_ns();
+    sum += *Chained_get(chained, &keys[i]);
+    times[i] = now_ns() - start;
+  }
+  report("chained hit", times, n, overhead);
+  for (size_t i = 0; i < n; i++) {
+    start = now_ns();
+    sum += *Cuckoo_get(cuckoo, &keys[i]);
+    times[i] = now_ns() - start;
+  }
+  report("cuckoo hit", times, n, overhead);
+  for (size_t i = 0; i < n; i++) {
+    start = now_ns();
+    sum += Chained_has(chained, &misses[i]);
+    times[i] = now_ns() - start;
+  }
+  report("chained miss", times, n, overhead);
+  for (size_t i = 0; i < n; i++) {
+    start = now_ns();
+    sum += Cuckoo_has(cuckoo, &misses[i]);
+    times[i] = now_ns() - start;
+  }
+  report("cuckoo miss", times, n, overhead);
+
+  /* Longest chain, the worst case lookup of the chained map. */
+  size_t longest = 0;
+  for (size_t b = 0; b < chained->cap; b++) {
+    size_t length = 0;
+    for (ssize_t i = chained->buckets[b]; i != -1; i = chained->entries[i].next) length++;
+    if (length > longest) longest = length;
+  }
+  printf("longest chain %zu entries, cuckoo always 2 buckets (%d slots)\n",
+    longest, 2 * CUCKOOMAP_WAYS);
+
+  Chained_free(chained);
+  Cuckoo_free(cuckoo);
+  free(keys); free(misses); free(times);
+  return sum == 42;
+}
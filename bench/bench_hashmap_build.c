@@ -0,0 +1,68 @@
+/**
+ * Time of loading a hash map from arrays of keys and values, with a put()
+ * for every pair against from_arrays() on one thread and on more threads.
+ * Build: gcc -O2 -pthread -Iinclude bench/bench_hashmap_build.c src/primes.c src/parallel.c -o bench_hashmap_build
+ * Usage: ./bench_hashmap_build [amount of keys] [amount of threads]
+*/
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include<time.h>
+#include "hashmap_build.h"
+
+uint64_t hash(const uint64_t *key) {
+  uint64_t h = *key * 0x9e3779b97f4a7c15ull;
+  return h ^ (h >> 29);
+}
+bool keycmp(const uint64_t *key1, const uint64_t *key2) {
+  return *key1 == *key2;
+}
+
+HashMap(Index, uint64_t, uint64_t, uint64_t, hash, keycmp)
+HashMap_from_arrays(Index, uint64_t, uint64_t, uint64_t)
+
+static double now_sec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t next_random(uint64_t *state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+int main(int argc, char *argv[]) {
+  size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+  size_t nthreads = ds_parallel_threads(argc > 2 ? strtoull(argv[2], NULL, 10) : 0);
+  uint64_t *keys = malloc(n * sizeof(uint64_t));
+  uint64_t *vals = malloc(n * sizeof(uint64_t));
+  uint64_t state = 42;
+  for (size_t i = 0; i < n; i++) {
+    keys[i] = next_random(&state);
+    vals[i] = i;
+  }
+  printf("%zu keys\n", n);
+
+  double start = now_sec();
+  Index *map = Index_new();
+  for (size_t i = 0; i < n; i++) Index_put(map, &keys[i], &vals[i]);
+  printf("put loop              %7.1f ms\n", (now_sec() - start) * 1e3);
+  Index_free(map);
+
+  start = now_sec();
+  map = Index_from_arrays(keys, vals, n, 1);
+  printf("from_arrays 1 thread  %7.1f ms\n", (now_sec() - start) * 1e3);
+  Index_free(map);
+
+  start = now_sec();
+  map = Index_from_arrays(keys, vals, n, nthreads);
+  printf("from_arrays %zu threads %6.1f ms\n", nthreads, (now_sec() - start) * 1e3);
+  Index_free(map);
+
+  free(keys);
+  free(vals);
+  return 0;
+}
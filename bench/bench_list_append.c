@@ -0,0 +1,58 @@
+/**
+ * Appending ints one by one to a list, with the old growth that allocates a
+ * new array, copies and frees the old one, against the realloc growth of
+ * list.h, doubling and growing by half.
+ * Build: gcc -O2 -Iinclude bench/bench_list_append.c -o bench_list_append
+ * Usage: ./bench_list_append [amount of ints]
+ * @note The default, 10^9 ints, needs about 8GB of memory for the doubling
+ * lists. Build with -DDS_BIGALLOC and src/bigalloc.c to grow big lists with
+ * mremap on huge pages.
+*/
+#include<stdio.h>
+#include<stdlib.h>
+#include<time.h>
+#include "list.h"
+
+STRUCT_LIST(int, ListInt)
+STRUCT_LIST_GROWTH(int, ListIntHalf, 3, 2)
+
+static double now_sec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* The growth list.h had before, every enlarge copies the whole array. */
+static void copy_add(ListInt *list, int element) {
+  if (list->_size == list->_maxSize) {
+    list->_maxSize *= 2;
+    int *newArr = DS_MALLOC(sizeof(int) * list->_maxSize);
+    if (!newArr) exit(EXIT_FAILURE);
+    memcpy(newArr, list->_arr, list->_size * sizeof(int));
+    DS_FREE(list->_arr);
+    list->_arr = newArr;
+  }
+  list->_arr[list->_size++] = element;
+}
+
+static long sink;
+
+#define APPEND(label, List_name, add) { \
+  List_name *list = List_name##_new(); \
+  double start = now_sec(); \
+  for (size_t i = 0; i < n; i++) add(list, (int)i); \
+  double end = now_sec(); \
+  sink += list->_arr[n / 2]; \
+  printf("%-16s %6.2f ns/add  %7.3f s  capacity %zu\n", label, \
+    (end - start) * 1e9 / n, end - start, list->_maxSize); \
+  List_name##_delete(list); \
+}
+
+int main(int argc, char *argv[]) {
+  size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000000;
+  printf("Appending %zu ints:\n", n);
+  APPEND("malloc+memcpy", ListInt, copy_add)
+  APPEND("realloc x2", ListInt, ListInt_add)
+  APPEND("realloc x1.5", ListIntHalf, ListIntHalf_add)
+  return sink == 42;
+}
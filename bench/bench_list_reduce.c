@@ -0,0 +1,65 @@
+/**
+ * Reducing a list of doubles, with a plain loop against the reductions of
+ * list_reduce.h, on one thread and on one thread per processor.
+ * Build: gcc -O2 -march=native -Iinclude bench/bench_list_reduce.c src/parallel.c -o bench_list_reduce -pthread
+ * Usage: ./bench_list_reduce [amount of doubles]
+*/
+#include<stdio.h>
+#include<stdlib.h>
+#include<time.h>
+#include "list.h"
+#include "list_reduce.h"
+
+STRUCT_LIST(double, ListDouble)
+LIST_REDUCE_FLOAT(double, ListDouble, double)
+LIST_REDUCE_PARALLEL(double, ListDouble, double)
+
+static double now_sec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static size_t n;
+static double sink;
+
+#define ROUNDS 20
+
+/* Time an expression over the list, in GB/s of the list it reads. */
+#define BENCH(name, expression) { \
+  double start = now_sec(); \
+  for (int r = 0; r < ROUNDS; r++) sink += (expression); \
+  double end = now_sec(); \
+  printf("%-14s %7.2f GB/s\n", name, (double)n * sizeof(double) * ROUNDS / (end - start) * 1e-9); \
+}
+
+static double plain_sum(const ListDouble *list) {
+  double sum = 0;
+  for (size_t i = 0; i < list->_size; i++) sum += list->_arr[i];
+  return sum;
+}
+
+static double plain_min(const ListDouble *list) {
+  double min = list->_arr[0];
+  for (size_t i = 1; i < list->_size; i++) if (list->_arr[i] < min) min = list->_arr[i];
+  return min;
+}
+
+int main(int argc, char *argv[]) {
+  n = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+  ListDouble *list = ListDouble_news(n);
+  for (size_t i = 0; i < n; i++) ListDouble_add(list, (double)rand() / RAND_MAX);
+
+  printf("Reducing %zu doubles:\n", n);
+  BENCH("loop sum", plain_sum(list))
+  BENCH("sum", ListDouble_sum(list))
+  BENCH("sumPairwise", ListDouble_sumPairwise(list))
+  BENCH("sumKahan", ListDouble_sumKahan(list))
+  BENCH("parallelSum", ListDouble_parallelSum(list, 0))
+  BENCH("loop min", plain_min(list))
+  BENCH("min", ListDouble_min(list))
+  BENCH("argmin", ListDouble_argmin(list))
+  BENCH("dot", ListDouble_dot(list, list))
+  ListDouble_delete(list);
+  return sink == 42;
+}
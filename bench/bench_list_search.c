@@ -0,0 +1,48 @@
+/**
+ * Scanning a big list of ints for a value, with a loop over get() against
+ * the vectorized count and indexOf of list_search.h.
+ * Build: gcc -O2 -march=native -Iinclude bench/bench_list_search.c -o bench_list_search
+ * Usage: ./bench_list_search [amount of ints]
+*/
+#include<stdio.h>
+#include<stdlib.h>
+#include<time.h>
+#include "list.h"
+#include "list_search.h"
+
+STRUCT_LIST(int, ListInt)
+LIST_SEARCH_INT(int, ListInt)
+
+static double now_sec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#define ROUNDS 10
+
+int main(int argc, char *argv[]) {
+  size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 50000000;
+  ListInt *list = ListInt_news(n);
+  for (size_t i = 0; i < n; i++) ListInt_add(list, (int)(i % 1000));
+  double bytes = (double)n * sizeof(int) * ROUNDS;
+  size_t sink = 0;
+
+  double start = now_sec();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (size_t i = 0; i < n; i++) sink += ListInt_get(list, i) == 7;
+  }
+  double loop = now_sec();
+  for (int r = 0; r < ROUNDS; r++) sink += ListInt_count(list, 7);
+  double count = now_sec();
+  /* A missing value, indexOf scans the whole list. */
+  for (int r = 0; r < ROUNDS; r++) sink += ListInt_indexOf(list, -1);
+  double index = now_sec();
+
+  printf("Scanning %zu ints:\n", n);
+  printf("get() loop %7.2f GB/s\n", bytes / (loop - start) * 1e-9);
+  printf("count      %7.2f GB/s\n", bytes / (count - loop) * 1e-9);
+  printf("indexOf    %7.2f GB/s\n", bytes / (index - count) * 1e-9);
+  ListInt_delete(list);
+  return sink == 42;
+}
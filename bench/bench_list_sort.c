@@ -0,0 +1,68 @@
+/**
+ * Sorting a list of random longs with qsort, against the sorts of
+ * list_sort.h, the introsort, the radix sort and the parallel merge sort.
+ * Build: gcc -O2 -Iinclude bench/bench_list_sort.c src/parallel.c -o bench_list_sort -pthread
+ * Usage: ./bench_list_sort [amount of longs] [threads]
+*/
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include<time.h>
+#include "list.h"
+#include "list_sort.h"
+
+STRUCT_LIST(long, ListLong)
+LIST_SORT(long, ListLong, LIST_LESS)
+LIST_RADIX_SORT_INT(long, ListLong)
+LIST_SORT_PARALLEL(long, ListLong, LIST_LESS)
+
+static double now_sec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t next_random(uint64_t *state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+static int compare_longs(const void *a, const void *b) {
+  long x = *(const long*)a, y = *(const long*)b;
+  return (x > y) - (x < y);
+}
+
+static ListLong *list;
+static long *original;
+static size_t n;
+
+/* Time a sort of a fresh copy of the random longs. */
+#define BENCH(name, sort) { \
+  memcpy(list->_arr, original, n * sizeof(long)); \
+  double start = now_sec(); \
+  sort; \
+  double end = now_sec(); \
+  printf("%-14s %7.1f ns/element\n", name, (end - start) * 1e9 / n); \
+}
+
+int main(int argc, char *argv[]) {
+  n = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+  size_t nthreads = argc > 2 ? strtoull(argv[2], NULL, 10) : 0;
+  original = malloc(n * sizeof(long));
+  uint64_t state = 11;
+  for (size_t i = 0; i < n; i++) original[i] = (long)next_random(&state);
+  list = ListLong_news(n);
+  list->_size = n;
+
+  printf("Sorting %zu longs:\n", n);
+  BENCH("qsort", qsort(list->_arr, n, sizeof(long), compare_longs))
+  BENCH("sort", ListLong_sort(list))
+  BENCH("radixSort", ListLong_radixSort(list))
+  BENCH("parallelSort", ListLong_parallelSort(list, nthreads))
+
+  ListLong_delete(list);
+  free(original);
+  return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ * Searching a sorted list of unsigned ints with bsearch against lowerBound and an
+ * Eytzinger copy, and intersecting posting lists with a plain merge against intersection,
+ * of similar lengths and of lengths that gallop.
+ * Build: gcc -O2 -march=native -Iinclude bench/bench_list_sorted.c -o bench_list_sorted
+ * Usage: ./bench_list_sorted [amount of elements]
+*/
+#include<stdio.h>
+#include<stdlib.h>
+#include<time.h>
+#include "list.h"
+#include "list_sorted.h"
+
+STRUCT_LIST(unsigned int, ListUInt)
+LIST_SORTED_INT(unsigned int, ListUInt)
+
+static double now_sec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static size_t sink;
+
+#define QUERIES 2000000
+#define ROUNDS 20
+
+/* Time an expression per query, in ns. */
+#define BENCH_SEARCH(name, expression) { \
+  double start = now_sec(); \
+  for (size_t q = 0; q < QUERIES; q++) { \
+    unsigned int x = queries[q]; \
+    sink += (size_t)(expression); \
+  } \
+  double end = now_sec(); \
+  printf("%-18s %7.1f ns/query\n", name, (end - start) / QUERIES * 1e9); \
+}
+
+/* Time an intersection of 'a' and 'b', in ns per element of both lists. */
+#define BENCH_INTERSECT(name, expression) { \
+  double start = now_sec(); \
+  for (int r = 0; r < ROUNDS; r++) sink += (expression); \
+  double end = now_sec(); \
+  printf("%-18s %7.2f ns/element\n", name, (end - start) / ROUNDS / (a->_size + b->_size) * 1e9); \
+}
+
+static int compare_uints(const void *a, const void *b) {
+  unsigned int x = *(const unsigned int*)a, y = *(const unsigned int*)b;
+  return (x > y) - (x < y);
+}
+
+/* A posting list, the documents from 0 to 'range' that have a word with a chance of 1 in 'odds'. */
+static ListUInt *postings(size_t range, int odds) {
+  ListUInt *list = ListUInt_new();
+  for (size_t doc = 0; doc < range; doc++) if (rand() % odds == 0) ListUInt_add(list, doc);
+  return list;
+}
+
+static size_t plain_intersect(const ListUInt *a, const ListUInt *b) {
+  size_t count = 0, i = 0, j = 0;
+  while (i < a->_size && j < b->_size) {
+    if (a->_arr[i] < b->_arr[j]) i++;
+    else if (b->_arr[j] < a->_arr[i]) j++;
+    else { count++; i++; j++; }
+  }
+  return count;
+}
+
+static size_t fast_intersect(const ListUInt *a, const ListUInt *b) {
+  ListUInt *result = ListUInt_intersection(a, b);
+  size_t count = result->_size;
+  ListUInt_delete(result);
+  return count;
+}
+
+int main(int argc, char *argv[]) {
+  size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+  ListUInt *list = postings(n * 2, 2);
+  unsigned int *queries = malloc(QUERIES * sizeof(unsigned int));
+  for (size_t q = 0; q < QUERIES; q++) queries[q] = (unsigned int)(((size_t)rand() << 16 ^ rand()) % (n * 2));
+
+  printf("Searching %zu unsigned ints:\n", list->_size);
+  BENCH_SEARCH("bsearch", bsearch(&x, list->_arr, list->_size, sizeof(unsigned int), compare_uints) != NULL)
+  BENCH_SEARCH("lowerBound", ListUInt_lowerBound(list, x))
+  ListUInt_eytzinger_t *tree = ListUInt_newEytzinger(list);
+  BENCH_SEARCH("eytzinger", ListUInt_eytzingerLowerBound(tree, x) != NULL)
+  ListUInt_deleteEytzinger(tree);
+  ListUInt_delete(list);
+  free(queries);
+
+  ListUInt *a = postings(n, 4), *b = postings(n, 3);
+  printf("Intersecting %zu and %zu postings:\n", a->_size, b->_size);
+  BENCH_INTERSECT("plain merge", plain_intersect(a, b))
+  BENCH_INTERSECT("intersection", fast_intersect(a, b))
+  ListUInt_delete(a);
+  a = postings(n, 1000);
+  printf("Intersecting %zu and %zu postings:\n", a->_size, b->_size);
+  BENCH_INTERSECT("plain merge", plain_intersect(a, b))
+  BENCH_INTERSECT("intersection", fast_intersect(a, b))
+  ListUInt_delete(a);
+  ListUInt_delete(b);
+  return sink == 42;
+}
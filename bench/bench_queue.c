@@ -0,0 +1,124 @@
+/**
+ * Throughput of passing longs from a producer thread to a consumer thread,
+ * through a list behind a mutex, the SPSC queue and the MPMC queue, one by
+ * one and in batches.
+ * Build: gcc -O2 -pthread -Iinclude bench/bench_queue.c -o bench_queue
+ * Usage: ./bench_queue [amount of items]
+*/
+#include<stdio.h>
+#include<stdlib.h>
+#include<time.h>
+#include<pthread.h>
+#include<sched.h>
+#include "list.h"
+#include "queue.h"
+
+STRUCT_LIST(long, ListLong)
+STRUCT_SPSC_QUEUE(long, SpscLong)
+STRUCT_MPMC_QUEUE(long, MpmcLong)
+
+#define QUEUE_SIZE 4096
+#define BATCH 64
+
+static size_t n;
+static long sink;
+
+static double now_sec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* The baseline, a list used as a queue under a lock, the consumer takes
+ * everything at once and the producer appends to the end. */
+static ListLong *locked;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void* locked_producer(void *arg) {
+  for (size_t i = 0; i < n; i++) {
+    pthread_mutex_lock(&lock);
+    ListLong_add(locked, i);
+    pthread_mutex_unlock(&lock);
+  }
+  return NULL;
+}
+
+static void locked_consume() {
+  ListLong *taken = ListLong_new();
+  for (size_t got = 0; got < n;) {
+    pthread_mutex_lock(&lock);
+    ListLong *tmp = locked;
+    locked = taken;
+    taken = tmp;
+    pthread_mutex_unlock(&lock);
+    for (size_t i = 0; i < taken->_size; i++) sink += taken->_arr[i];
+    got += taken->_size;
+    ListLong_resize(taken, 0, 0);
+  }
+  ListLong_delete(taken);
+}
+
+/* A producer and a consumer of a queue, one by one or in batches. */
+#define QUEUE_BENCH(Queue_name) \
+static Queue_name *Queue_name##_queue; \
+static void* Queue_name##_producer(void *arg) { \
+  size_t batch = *(size_t*)arg; \
+  long items[BATCH]; \
+  for (size_t i = 0; i < n;) { \
+    size_t sent; \
+    if (batch == 1) { \
+      sent = Queue_name##_enqueue(Queue_name##_queue, i); \
+    } else { \
+      size_t size = n - i < batch ? n - i : batch; \
+      for (size_t j = 0; j < size; j++) items[j] = i + j; \
+      sent = Queue_name##_enqueueArray(Queue_name##_queue, items, size); \
+    } \
+    /* Let the consumer run when the queue is full, if they share a core. */ \
+    if (!sent) sched_yield(); \
+    i += sent; \
+  } \
+  return NULL; \
+} \
+static void Queue_name##_consume(size_t batch) { \
+  long items[BATCH]; \
+  for (size_t got = 0; got < n;) { \
+    size_t size = batch == 1 ? (size_t)Queue_name##_dequeue(Queue_name##_queue, items) : \
+      Queue_name##_dequeueArray(Queue_name##_queue, items, batch); \
+    if (!size) sched_yield(); \
+    for (size_t j = 0; j < size; j++) sink += items[j]; \
+    got += size; \
+  } \
+}
+
+QUEUE_BENCH(SpscLong)
+QUEUE_BENCH(MpmcLong)
+
+#define RUN(label, producer, consume, arg) { \
+  pthread_t thread; \
+  double start = now_sec(); \
+  pthread_create(&thread, NULL, producer, arg); \
+  consume; \
+  pthread_join(thread, NULL); \
+  double end = now_sec(); \
+  printf("%-16s %7.1f M items/s\n", label, n / (end - start) * 1e-6); \
+}
+
+int main(int argc, char *argv[]) {
+  n = argc > 1 ? strtoull(argv[1], NULL, 10) : 20000000;
+  size_t one = 1, batch = BATCH;
+  printf("Passing %zu items between two threads:\n", n);
+  locked = ListLong_new();
+  RUN("mutex + list", locked_producer, locked_consume(), NULL)
+  ListLong_delete(locked);
+
+  SpscLong_queue = SpscLong_new(QUEUE_SIZE);
+  RUN("spsc", SpscLong_producer, SpscLong_consume(1), &one)
+  RUN("spsc batch", SpscLong_producer, SpscLong_consume(BATCH), &batch)
+  SpscLong_delete(SpscLong_queue);
+
+  MpmcLong_queue = MpmcLong_new(QUEUE_SIZE);
+  RUN("mpmc", MpmcLong_producer, MpmcLong_consume(1), &one)
+  RUN("mpmc batch", MpmcLong_producer, MpmcLong_consume(BATCH), &batch)
+  MpmcLong_delete(MpmcLong_queue);
+  return sink == 42;
+}
@@ -0,0 +1,95 @@
+/**
+ * Throughput of the chained, robin hood and cuckoo hash maps on an insert
+ * heavy and on a miss heavy workload. The three maps have the same API, each
+ * workload is written once as a macro over the map name.
+ * Build: gcc -O2 -Iinclude bench/bench_robinmap.c src/primes.c -o bench_robinmap
+ * Usage: ./bench_robinmap [amount of keys]
+*/
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include<time.h>
+#include "hashmap.h"
+#include "robinmap.h"
+#include "cuckoomap.h"
+
+uint64_t hash(const uint64_t *key) {
+  uint64_t h = *key * 0x9e3779b97f4a7c15ull;
+  return h ^ (h >> 29);
+}
+bool keycmp(const uint64_t *key1, const uint64_t *key2) {
+  return *key1 == *key2;
+}
+
+HashMap(Chained, uint64_t, uint64_t, uint64_t, hash, keycmp)
+RobinMap(Robin, uint64_t, uint64_t, uint64_t, hash, keycmp)
+CuckooMap(Cuckoo, uint64_t, uint64_t, uint64_t, hash, keycmp)
+
+static double now_sec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t next_random(uint64_t *state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+static uint64_t *keys, *others;
+static size_t n;
+static uint64_t sink;
+
+/* Insert heavy: fill an empty map, then replace half of it, every round
+ * removes an old key and inserts a new one. */
+#define INSERT_HEAVY(hm_name) { \
+  double start = now_sec(); \
+  hm_name *map = hm_name##_new(); \
+  for (size_t i = 0; i < n; i++) hm_name##_put(map, &keys[i], &keys[i]); \
+  double fill = now_sec(); \
+  for (size_t i = 0; i < n / 2; i++) { \
+    hm_name##_remove(map, &keys[i]); \
+    hm_name##_put(map, &others[i], &others[i]); \
+  } \
+  double churn = now_sec(); \
+  printf("%-8s fill %6.1f ns/put   churn %6.1f ns/(remove+put)\n", #hm_name, \
+    (fill - start) * 1e9 / n, (churn - fill) * 1e9 / (n / 2)); \
+  hm_name##_free(map); \
+}
+
+/* Miss heavy: 9 out of 10 lookups are for keys that are not in the map. */
+#define MISS_HEAVY(hm_name) { \
+  hm_name *map = hm_name##_new(); \
+  for (size_t i = 0; i < n; i++) hm_name##_put(map, &keys[i], &keys[i]); \
+  double start = now_sec(); \
+  for (size_t i = 0; i < n; i++) { \
+    sink += hm_name##_has(map, i % 10 ? &others[i] : &keys[i]); \
+  } \
+  double end = now_sec(); \
+  printf("%-8s %6.1f ns/has, 90%% misses\n", #hm_name, (end - start) * 1e9 / n); \
+  hm_name##_free(map); \
+}
+
+int main(int argc, char *argv[]) {
+  n = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+  keys = malloc(n * sizeof(uint64_t));
+  others = malloc(n * sizeof(uint64_t));
+  uint64_t state = 7;
+  for (size_t i = 0; i < n; i++) keys[i] = next_random(&state) | 1;
+  for (size_t i = 0; i < n; i++) others[i] = next_random(&state) & ~1ull;
+
+  printf("Insert heavy, %zu keys:\n", n);
+  INSERT_HEAVY(Chained)
+  INSERT_HEAVY(Robin)
+  INSERT_HEAVY(Cuckoo)
+  printf("Miss heavy, %zu keys:\n", n);
+  MISS_HEAVY(Chained)
+  MISS_HEAVY(Robin)
+  MISS_HEAVY(Cuckoo)
+
+  free(keys);
+  free(others);
+  return sink == 42;
+}
@@ -0,0 +1,50 @@
+/**
+ * Sorting log keys, strings with long common prefixes, with qsort and
+ * strcmp against the multikey quicksort of strsort.h.
+ * Build: gcc -O2 -Iinclude bench/bench_strsort.c src/strsort.c -o bench_strsort
+ * Usage: ./bench_strsort [amount of strings]
+*/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include "strsort.h"
+
+static double now_sec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int compare_strings(const void *a, const void *b) {
+  return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+int main(int argc, char *argv[]) {
+  size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 2000000;
+  char **original = malloc(n * sizeof(char*)), **strings = malloc(n * sizeof(char*));
+  srand(1);
+  for (size_t i = 0; i < n; i++) {
+    original[i] = malloc(64);
+    snprintf(original[i], 64, "2024-06-%02d host-%03d service-%d request-%d",
+      rand() % 30 + 1, rand() % 200, rand() % 20, rand());
+  }
+
+  printf("Sorting %zu log keys:\n", n);
+  memcpy(strings, original, n * sizeof(char*));
+  double start = now_sec();
+  qsort(strings, n, sizeof(char*), compare_strings);
+  double end = now_sec();
+  printf("qsort+strcmp %7.1f ns/string\n", (end - start) * 1e9 / n);
+
+  memcpy(strings, original, n * sizeof(char*));
+  start = now_sec();
+  ds_strsort(strings, n);
+  end = now_sec();
+  printf("ds_strsort   %7.1f ns/string\n", (end - start) * 1e9 / n);
+
+  for (size_t i = 0; i < n; i++) free(original[i]);
+  free(original);
+  free(strings);
+  return 0;
+}
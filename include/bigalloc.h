@@ -0,0 +1,89 @@
+#ifndef __BIGALLOC_H__
+#define __BIGALLOC_H__
+
+/**
+ * @file bigalloc.h
+ * @brief An allocator for the big arrays of the data structures. Blocks
+ * above a threshold are mapped directly with mmap, aligned to a huge page
+ * and advised to use transparent huge pages, so random accesses into them
+ * miss the TLB far less. The pages of such blocks can also be interleaved
+ * across the NUMA nodes. Smaller blocks come from malloc.
+ *
+ * The data structures use it through DS_MALLOC, DS_REALLOC and DS_FREE, which
+ * are plain malloc, realloc and free unless DS_BIGALLOC is defined. Define it
+ * for the whole program, -DDS_BIGALLOC, and build with src/bigalloc.c. Arrays
+ * of the data structures, like a list's `_arr`, must then be freed with
+ * DS_FREE and not with free.
+*/
+
+#include<stddef.h>
+#include<stdlib.h>
+
+/**The default size from which blocks are mapped with huge pages.*/
+#define DS_BIGALLOC_THRESHOLD ((size_t)64 << 20)
+/**The size of a huge page, the alignment of mapped blocks.*/
+#define DS_BIGALLOC_HUGE_PAGE ((size_t)2 << 20)
+
+/**How the pages of mapped blocks are placed on NUMA nodes.*/
+typedef enum ds_numa_policy_t {
+  /**Leave the placement to the system, usually the node that first touches
+   * a page.*/
+  DS_NUMA_DEFAULT,
+  /**Interleave the pages across all the nodes, for blocks that every thread
+   * reads at random.*/
+  DS_NUMA_INTERLEAVE,
+  /**Place the pages on the node of the thread that touches them.*/
+  DS_NUMA_LOCAL
+} ds_numa_policy_t;
+
+/**
+ * Set the size from which blocks are mapped with huge pages.
+ * @param threshold The size in bytes, 0 for DS_BIGALLOC_THRESHOLD, SIZE_MAX to
+ * allocate every block with malloc.
+ * @note Not thread safe, set it before allocating.
+*/
+void ds_bigalloc_set_threshold(size_t threshold);
+
+/**
+ * Set the NUMA placement of the blocks that are mapped from now on.
+ * @param policy The placement policy.
+ * @note Not thread safe, set it before allocating. The placement is a hint,
+ * on systems without NUMA it does nothing.
+*/
+void ds_bigalloc_set_numa(ds_numa_policy_t policy);
+
+/**
+ * Allocate a block of memory.
+ * @param size The size of the block in bytes.
+ * @return A pointer to the block, aligned for any type. NULL on failure.
+*/
+void* ds_bigalloc(size_t size);
+
+/**
+ * Change the size of a block, keeping it's contents up to the smaller size.
+ * Mapped blocks are grown and shrunk with mremap, moving their pages rather
+ * than copying them.
+ * @param ptr The block, or NULL to allocate a new one.
+ * @param size The new size of the block in bytes.
+ * @return A pointer to the block. NULL on failure, the old block is then
+ * left as it was.
+*/
+void* ds_bigrealloc(void *ptr, size_t size);
+
+/**
+ * Free a block that was allocated with ds_bigalloc or ds_bigrealloc.
+ * @param ptr The block, or NULL.
+*/
+void ds_bigfree(void *ptr);
+
+#ifdef DS_BIGALLOC
+#define DS_MALLOC(size) ds_bigalloc(size)
+#define DS_REALLOC(ptr, size) ds_bigrealloc(ptr, size)
+#define DS_FREE(ptr) ds_bigfree(ptr)
+#else
+#define DS_MALLOC(size) malloc(size)
+#define DS_REALLOC(ptr, size) realloc(ptr, size)
+#define DS_FREE(ptr) free(ptr)
+#endif
+
+#endif
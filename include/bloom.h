@@ -0,0 +1,169 @@
+#ifndef __BLOOM_H__
+#define __BLOOM_H__
+
+/**
+ * @file bloom.h
+ * @brief A blocked bloom filter over 64 bit hashes. Every key sets and tests
+ * bits in a single block the size of a cache line, so a lookup touches one
+ * cache line no matter how many bits it tests. Used by the hash maps to
+ * answer most lookups of missing keys without reading the table.
+ * All the functions are static inline, so maps that never enable a filter
+ * don't need anything linked for it.
+*/
+
+#include<stddef.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<stdbool.h>
+#include "errors.h"
+
+/**The amount of 64 bit words in a block, a block is one cache line.*/
+#define BLOOM_BLOCK_WORDS 8
+/**The amount of bits in a block.*/
+#define BLOOM_BLOCK_BITS (BLOOM_BLOCK_WORDS * 64)
+/**The bits per key used when 0 is requested, about 1% false positives.*/
+#define BLOOM_DEFAULT_BITS_PER_KEY 10
+/**The alignment of the blocks, a cache line.*/
+#define BLOOM_ALIGN (BLOOM_BLOCK_WORDS * sizeof(uint64_t))
+
+/**A blocked bloom filter.*/
+typedef struct BloomFilter {
+  /**The blocks of the filter, aligned to a cache line.*/
+  uint64_t *blocks;
+  /**The amount of blocks in the filter.*/
+  size_t block_count;
+  /**The bits per key the filter was sized with.*/
+  unsigned bits_per_key;
+  /**The amount of keys that were added to the filter.*/
+  size_t count;
+  /**The amount of added keys that were since removed from the owner, their
+   * bits are still set and only make false positives.*/
+  size_t stale;
+} BloomFilter;
+
+/**
+ * Removes all the keys from the filter.
+ * @param filter The filter.
+*/
+static inline void BloomFilter_clear(BloomFilter* filter) {
+  memset(filter->blocks, 0, filter->block_count * BLOOM_ALIGN);
+  filter->count = 0;
+  filter->stale = 0;
+}
+
+/**
+ * Initialize an empty bloom filter.
+ * @param filter The filter to initialize.
+ * @param capacity The amount of keys the filter is sized for.
+ * @param bits_per_key The amount of bits per key, 0 for the default.
+ * @return DS_SUCCESS on success, an error code on failure.
+ * @note Errors:
+ * ERR_MEM - Memory allocation error.
+*/
+static inline DS_codes_t BloomFilter_init(BloomFilter* filter, size_t capacity,
+  unsigned bits_per_key) {
+  if (bits_per_key == 0) bits_per_key = BLOOM_DEFAULT_BITS_PER_KEY;
+
+  size_t blocks = (capacity * bits_per_key + BLOOM_BLOCK_BITS - 1) / BLOOM_BLOCK_BITS;
+  if (blocks == 0) blocks = 1;
+  filter->blocks = aligned_alloc(BLOOM_ALIGN, blocks * BLOOM_ALIGN);
+  if (!filter->blocks) return ERR_MEM;
+
+  filter->block_count = blocks;
+  filter->bits_per_key = bits_per_key;
+  BloomFilter_clear(filter);
+  return DS_SUCCESS;
+}
+
+/**
+ * Allocates a new empty bloom filter and returns a pointer to it.
+ * @param capacity The amount of keys the filter is sized for.
+ * @param bits_per_key The amount of bits per key, 0 for the default.
+ * @return A pointer to the new filter, NULL on failed memory allocation.
+*/
+static inline BloomFilter* BloomFilter_new(size_t capacity, unsigned bits_per_key) {
+  BloomFilter* filter = malloc(sizeof(BloomFilter));
+  if (!filter) return NULL;
+
+  if (BloomFilter_init(filter, capacity, bits_per_key) != DS_SUCCESS) {
+    free(filter);
+    return NULL;
+  }
+  return filter;
+}
+
+/**
+ * Releases all the memory the filter uses.
+ * @param filter The filter.
+ * @note For filters that were created with new() use free() instead.
+*/
+static inline void BloomFilter_destroy(BloomFilter* filter) {
+  if (filter->blocks) free(filter->blocks);
+  filter->blocks = NULL;
+}
+
+/**
+ * Releases all the memory the filter uses.
+ * @param filter The filter.
+ * @note For filters that were not created with new() use destroy() instead.
+*/
+static inline void BloomFilter_free(BloomFilter* filter) {
+  if (!filter) return;
+  BloomFilter_destroy(filter);
+  free(filter);
+}
+
+/**Scramble a hash so that weak hashes spread over all the bits.*/
+static inline uint64_t bloom_mix(uint64_t hash) {
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+/**The odd multipliers that pick one bit in each word of a block.*/
+static const uint32_t bloom_salts[BLOOM_BLOCK_WORDS] = {
+  0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+  0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+/**Get the block of a mixed hash, from it's high 32 bits.*/
+static inline uint64_t * bloom_block(const BloomFilter* filter, uint64_t mixed) {
+  return filter->blocks +
+    ((mixed >> 32) * filter->block_count >> 32) * BLOOM_BLOCK_WORDS;
+}
+
+/**
+ * Add a hash to the filter.
+ * @param filter The filter.
+ * @param hash The hash of the key.
+*/
+static inline void BloomFilter_add(BloomFilter* filter, uint64_t hash) {
+  uint64_t mixed = bloom_mix(hash);
+  uint64_t *block = bloom_block(filter, mixed);
+  for (int i = 0; i < BLOOM_BLOCK_WORDS; i++) {
+    block[i] |= (uint64_t)1 << ((uint32_t)mixed * bloom_salts[i] >> 26);
+  }
+  filter->count++;
+}
+
+/**
+ * Check if a hash may have been added to the filter.
+ * @param filter The filter.
+ * @param hash The hash of the key.
+ * @return False if the hash was definitely not added, true if it may have been.
+*/
+static inline bool BloomFilter_may_contain(const BloomFilter* filter, uint64_t hash) {
+  uint64_t mixed = bloom_mix(hash);
+  const uint64_t *block = bloom_block(filter, mixed);
+  uint64_t missing = 0;
+  for (int i = 0; i < BLOOM_BLOCK_WORDS; i++) {
+    missing |= ~block[i] & (uint64_t)1 << ((uint32_t)mixed * bloom_salts[i] >> 26);
+  }
+  return missing == 0;
+}
+
+#endif
@@ -0,0 +1,375 @@
+#ifndef __CUCKOO_MAP_H__
+#define __CUCKOO_MAP_H__
+
+/**
+ * @file cuckoomap.h
+ * @brief A bucketized cuckoo hash map, with the same API as the hash map in
+ * hashmap.h. Every key has two candidate buckets of CUCKOOMAP_WAYS slots each,
+ * both taken from one mixed 64 bit hash, so a lookup never inspects more than
+ * two buckets. An insert into two full buckets moves other keys to their
+ * alternate buckets, along the shortest path found by a breadth first search.
+*/
+
+#include<stdint.h>
+#include "hashmap.h"
+
+/**The amount of slots in each bucket.*/
+#define CUCKOOMAP_WAYS 4
+/**The default amount of buckets.*/
+#define CUCKOOMAP_DEFAULT_BUCKETS 4
+/**The maximum amount of buckets the insert search visits.*/
+#define CUCKOOMAP_SEARCH_SIZE 256
+/**How many times put() doubles the map before giving up on a key.*/
+#define CUCKOOMAP_MAX_GROWS 4
+
+/**
+ * Mix the bits of a hash, splitmix64's finalizer.
+ * @param hash The hash to mix.
+ * @return The mixed hash.
+*/
+static inline uint64_t cuckoomap_mix(uint64_t hash) {
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ull;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebull;
+  hash ^= hash >> 31;
+  return hash;
+}
+
+/**Get the tag of a mixed hash, a non zero byte, 0 marks an empty slot.*/
+#define cuckoomap_tag(mixed) ((unsigned char)((mixed) >> 56 | 1))
+/**Get the first bucket of a mixed hash.*/
+#define cuckoomap_bucket1(map, mixed) ((size_t)(mixed) & ((map)->nbuckets - 1))
+/**Get the second bucket of a mixed hash.*/
+#define cuckoomap_bucket2(map, mixed) \
+  ((size_t)((mixed) >> 32) & ((map)->nbuckets - 1))
+
+/**
+ * Iterate over every entry in a cuckoo map.
+ * @param map A pointer to the map to iterate over.
+ * @param entry A pointer for iterating over entries.
+ * @param slot An indexer for iterating over slots.
+ * @note Accesses the entries directly, overwriting anything except the value
+ * is unsafe and should not be done.
+*/
+#define cuckoomap_for_each_entry(map, entry, slot) \
+  for ((slot) = 0; (slot) < (map)->cap; (slot)++) \
+  for ((entry) = (map)->buckets[(slot) / CUCKOOMAP_WAYS].tags[(slot) % CUCKOOMAP_WAYS] \
+    ? &(map)->buckets[(slot) / CUCKOOMAP_WAYS].slots[(slot) % CUCKOOMAP_WAYS] : NULL; \
+    (entry) != NULL; (entry) = NULL)
+
+/* ========================= DECLARATIONS ========================= */
+
+#define CuckooMap_entry_declare(hm_name) \
+  typedef struct hm_name##_entry_t hm_name##_entry_t; \
+  typedef struct hm_name##_bucket_t hm_name##_bucket_t;
+
+/* ========================= DEFINITIONS ========================= */
+
+#define CuckooMap_entry_define(hm_name, key_t, val_t, hash_t) \
+/**Represents an entry in the cuckoo map.*/ \
+struct hm_name##_entry_t { \
+  /**The key of the entry*/ \
+  const key_t key; \
+  /**The hash of the key.*/ \
+  const hash_t key_hash; \
+  /**The value of the entry.*/ \
+  val_t val; \
+}; \
+/**Represents a bucket of the cuckoo map.*/ \
+struct hm_name##_bucket_t { \
+  /**The tag of the entry in each slot, 0 for an empty slot.*/ \
+  unsigned char tags[CUCKOOMAP_WAYS]; \
+  /**The entries of the bucket.*/ \
+  hm_name##_entry_t slots[CUCKOOMAP_WAYS]; \
+};
+
+#define CuckooMap_struct_define(hm_name) \
+/**Represents a cuckoo hash map data structure.*/ \
+struct hm_name { \
+  /**The buckets of the map, a power of 2 amount.*/ \
+  hm_name##_bucket_t *buckets; \
+  /**The amount of buckets.*/ \
+  size_t nbuckets; \
+  /**The amount of entries in the map.*/ \
+  size_t size; \
+  /**The amount of slots in the map.*/ \
+  size_t cap; \
+};
+
+#define CuckooMap_find_define(hm_name, key_t, hash_t) \
+/**Find the entry of a key, NULL if the key is not in the map.*/ \
+static hm_name##_entry_t * hm_name##_find(const hm_name *map, const key_t *key, \
+  hash_t hash) { \
+  uint64_t mixed = cuckoomap_mix((uint64_t)hash); \
+  unsigned char tag = cuckoomap_tag(mixed); \
+  hm_name##_bucket_t *bucket = map->buckets + cuckoomap_bucket1(map, mixed); \
+  for (int i = 0; i < 2; i++) { \
+    for (int way = 0; way < CUCKOOMAP_WAYS; way++) { \
+      hm_name##_entry_t *entry = bucket->slots + way; \
+      if (bucket->tags[way] == tag && entry->key_hash == hash && \
+        hm_name##_keycmp(key, &entry->key)) return entry; \
+    } \
+    bucket = map->buckets + cuckoomap_bucket2(map, mixed); \
+  } \
+  return NULL; \
+}
+
+#define CuckooMap_place_define(hm_name, key_t, val_t, hash_t) \
+/**Place a new entry in one of it's buckets, moving other entries if needed. \
+ * Returns false if no free slot was found.*/ \
+static bool hm_name##_place(hm_name *map, const key_t *key, hash_t hash, \
+  const val_t *value) { \
+  /* A node of the search, a bucket and how it was reached. */ \
+  struct { size_t bucket; int parent; int way; } nodes[CUCKOOMAP_SEARCH_SIZE]; \
+  uint64_t mixed = cuckoomap_mix((uint64_t)hash); \
+  int count = 2, found = -1, free_way = -1; \
+  nodes[0].bucket = cuckoomap_bucket1(map, mixed); \
+  nodes[1].bucket = cuckoomap_bucket2(map, mixed); \
+  nodes[0].parent = nodes[1].parent = -1; \
+ \
+  /* Breadth first search for a bucket with a free slot. */ \
+  for (int n = 0; n < count && found == -1; n++) { \
+    hm_name##_bucket_t *bucket = map->buckets + nodes[n].bucket; \
+    for (int way = 0; way < CUCKOOMAP_WAYS; way++) { \
+      if (bucket->tags[way] == 0) { \
+        found = n; \
+        free_way = way; \
+        break; \
+      } \
+    } \
+    for (int way = 0; found == -1 && way < CUCKOOMAP_WAYS; way++) { \
+      if (count == CUCKOOMAP_SEARCH_SIZE) break; \
+      uint64_t other = cuckoomap_mix((uint64_t)bucket->slots[way].key_hash); \
+      size_t alt = cuckoomap_bucket1(map, other); \
+      if (alt == nodes[n].bucket) alt = cuckoomap_bucket2(map, other); \
+      if (alt == nodes[n].bucket) continue; \
+      /* A bucket can only be on the path once, or a move overwrites another. */ \
+      bool visited = false; \
+      for (int v = 0; v < count && !visited; v++) visited = nodes[v].bucket == alt; \
+      if (visited) continue; \
+      nodes[count].bucket = alt; \
+      nodes[count].parent = n; \
+      nodes[count].way = way; \
+      count++; \
+    } \
+  } \
+  if (found == -1) return false; \
+ \
+  /* Move the entries along the path, from the free slot back to the start. */ \
+  int n = found, way = free_way; \
+  while (nodes[n].parent != -1) { \
+    hm_name##_bucket_t *to = map->buckets + nodes[n].bucket; \
+    hm_name##_bucket_t *from = map->buckets + nodes[nodes[n].parent].bucket; \
+    memcpy(to->slots + way, from->slots + nodes[n].way, sizeof(hm_name##_entry_t)); \
+    to->tags[way] = from->tags[nodes[n].way]; \
+    way = nodes[n].way; \
+    n = nodes[n].parent; \
+  } \
+  hm_name##_bucket_t *bucket = map->buckets + nodes[n].bucket; \
+  hm_name##_entry_t new_entry = { \
+    .key = *key, \
+    .key_hash = hash, \
+    .val = *value \
+  }; \
+  memcpy(bucket->slots + way, &new_entry, sizeof(hm_name##_entry_t)); \
+  bucket->tags[way] = cuckoomap_tag(mixed); \
+  map->size++; \
+  return true; \
+}
+
+#define CuckooMap_init_define(hm_name) \
+DS_codes_t hm_name##_init(hm_name *map, size_t size) { \
+  size_t nbuckets = CUCKOOMAP_DEFAULT_BUCKETS; \
+  while (nbuckets * CUCKOOMAP_WAYS < size) nbuckets *= 2; \
+ \
+  map->buckets = calloc(nbuckets, sizeof(hm_name##_bucket_t)); \
+  if (map->buckets == NULL) return ERR_MEM; \
+  map->nbuckets = nbuckets; \
+  map->size = 0; \
+  map->cap = nbuckets * CUCKOOMAP_WAYS; \
+ \
+  return DS_SUCCESS; \
+}
+
+#define CuckooMap_put_define(hm_name, key_t, val_t, hash_t) \
+DS_codes_t hm_name##_put(hm_name *map, const key_t *key, const val_t *value) { \
+  hash_t hash = hm_name##_hash(key); \
+  hm_name##_entry_t *entry = hm_name##_find(map, key, hash); \
+  if (entry != NULL) { \
+    entry->val = *value; \
+    return HMP_SET; \
+  } \
+ \
+  /* Grow when the search finds no free slot, the path search is bounded, \
+   * so a map that is too full grows before inserts get slow. */ \
+  for (int grows = 0; !hm_name##_place(map, key, hash, value); grows++) { \
+    if (grows == CUCKOOMAP_MAX_GROWS) return ERR_TOOBIG; \
+    DS_codes_t res = hm_name##_resize(map, map->cap * 2); \
+    if (res != DS_SUCCESS) return res; \
+  } \
+  return HMP_ADD; \
+}
+
+#define CuckooMap_has_define(hm_name, key_t) \
+bool hm_name##_has(const hm_name *map, const key_t *key) { \
+  return hm_name##_find(map, key, hm_name##_hash(key)) != NULL; \
+}
+
+#define CuckooMap_get_define(hm_name, key_t, val_t) \
+val_t * hm_name##_get(const hm_name *map, const key_t *key) { \
+  hm_name##_entry_t *entry = hm_name##_find(map, key, hm_name##_hash(key)); \
+  return entry != NULL ? &entry->val : NULL; \
+}
+
+#define CuckooMap_remove_define(hm_name, key_t) \
+DS_codes_t hm_name##_remove(hm_name *map, const key_t *key) { \
+  hm_name##_entry_t *entry = hm_name##_find(map, key, hm_name##_hash(key)); \
+  if (entry == NULL) return ERR_KEYNOTFOUND; \
+ \
+  size_t index = ((char*)entry - (char*)map->buckets) / sizeof(hm_name##_bucket_t); \
+  hm_name##_bucket_t *bucket = map->buckets + index; \
+  bucket->tags[entry - bucket->slots] = 0; \
+  map->size--; \
+  return DS_SUCCESS; \
+}
+
+#define CuckooMap_clear_define(hm_name) \
+void hm_name##_clear(hm_name *map) { \
+  for (size_t i = 0; i < map->nbuckets; i++) { \
+    memset(map->buckets[i].tags, 0, sizeof(map->buckets[i].tags)); \
+  } \
+  map->size = 0; \
+}
+
+#define CuckooMap_resize_define(hm_name) \
+DS_codes_t hm_name##_resize(hm_name *map, size_t new_size) { \
+  if (new_size < map->size) return ERR_TOOSMALL; \
+ \
+  size_t nbuckets = CUCKOOMAP_DEFAULT_BUCKETS; \
+  while (nbuckets * CUCKOOMAP_WAYS < new_size) { \
+    if (nbuckets > SIZE_MAX / 2 / sizeof(hm_name##_bucket_t)) return ERR_TOOBIG; \
+    nbuckets *= 2; \
+  } \
+ \
+  /* Place every entry again in the new buckets, if one of them doesn't fit \
+   * try again with twice as many buckets. */ \
+  hm_name old = *map; \
+  while (true) { \
+    map->buckets = calloc(nbuckets, sizeof(hm_name##_bucket_t)); \
+    if (map->buckets == NULL) { \
+      *map = old; \
+      return ERR_MEM; \
+    } \
+    map->nbuckets = nbuckets; \
+    map->cap = nbuckets * CUCKOOMAP_WAYS; \
+    map->size = 0; \
+ \
+    bool placed = true; \
+    for (size_t i = 0; i < old.nbuckets && placed; i++) { \
+      hm_name##_bucket_t *bucket = old.buckets + i; \
+      for (int way = 0; way < CUCKOOMAP_WAYS && placed; way++) { \
+        if (bucket->tags[way] == 0) continue; \
+        hm_name##_entry_t *entry = bucket->slots + way; \
+        placed = hm_name##_place(map, &entry->key, entry->key_hash, &entry->val); \
+      } \
+    } \
+    if (placed) break; \
+    free(map->buckets); \
+    if (nbuckets > SIZE_MAX / 2 / sizeof(hm_name##_bucket_t)) { \
+      *map = old; \
+      return ERR_TOOBIG; \
+    } \
+    nbuckets *= 2; \
+  } \
+ \
+  free(old.buckets); \
+  return DS_SUCCESS; \
+}
+
+#define CuckooMap_destroy_define(hm_name) \
+void hm_name##_destroy(hm_name *map) { \
+  if (map->buckets != NULL) free(map->buckets); \
+}
+
+/* ========================= ALL ========================= */
+
+/**
+ * Generate the declarations for a cuckoo hash map data structure for a given
+ * key and value types.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @param hash_t The data type of the hash.
+ * @note It's best to put this macro in a header file.
+*/
+#define CuckooMap_declare(hm_name, key_t, val_t, hash_t) \
+CuckooMap_entry_declare(hm_name) \
+HashMap_struct_declare(hm_name) \
+HashMap_hash_declare(hm_name, key_t, hash_t) \
+HashMap_keycmp_declare(hm_name, key_t) \
+HashMap_new_declare(hm_name) \
+HashMap_snew_declare(hm_name) \
+HashMap_init_declare(hm_name) \
+HashMap_put_declare(hm_name, key_t, val_t) \
+HashMap_has_declare(hm_name, key_t) \
+HashMap_get_declare(hm_name, key_t, val_t) \
+HashMap_remove_declare(hm_name, key_t) \
+HashMap_clear_declare(hm_name) \
+HashMap_resize_declare(hm_name) \
+HashMap_destroy_declare(hm_name) \
+HashMap_free_declare(hm_name)
+
+/**
+ * Generate the definitions for the cuckoo hash map data structure for a given
+ * key and value types.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @param hash_t The data type of the hash.
+ * @param hash A pointer to the hash function for hashing keys.
+ * @param keycmp A pointer to a function for comparing keys.
+ * @note It's best to put this macro in a code file.
+*/
+#define CuckooMap_define(hm_name, key_t, val_t, hash_t, hash, keycmp) \
+CuckooMap_entry_define(hm_name, key_t, val_t, hash_t) \
+CuckooMap_struct_define(hm_name) \
+HashMap_hash_define(hm_name, key_t, hash_t, hash) \
+HashMap_keycmp_define(hm_name, key_t, keycmp) \
+CuckooMap_find_define(hm_name, key_t, hash_t) \
+CuckooMap_place_define(hm_name, key_t, val_t, hash_t) \
+HashMap_new_define(hm_name) \
+HashMap_snew_define(hm_name) \
+CuckooMap_init_define(hm_name) \
+CuckooMap_put_define(hm_name, key_t, val_t, hash_t) \
+CuckooMap_has_define(hm_name, key_t) \
+CuckooMap_get_define(hm_name, key_t, val_t) \
+CuckooMap_remove_define(hm_name, key_t) \
+CuckooMap_clear_define(hm_name) \
+CuckooMap_resize_define(hm_name) \
+CuckooMap_destroy_define(hm_name) \
+HashMap_free_define(hm_name)
+
+/**
+ * Generate a full cuckoo hash map data structure implementation for a given
+ * key and value types. Has the same functions as the HashMap macro, so the
+ * two can be swapped by changing the macro.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @param hash_t The data type of the hash.
+ * @param hash A pointer to the hash function for hashing keys.
+ * @param keycmp A pointer to a function for comparing keys.
+ * @note Entries move between buckets on insert, pointers returned by get()
+ * are only valid until the next put().
+ * @note More than 2 * CUCKOOMAP_WAYS keys with the same hash can't be stored,
+ * put() returns ERR_TOOBIG for them.
+*/
+#define CuckooMap(hm_name, key_t, val_t, hash_t, hash, keycmp) \
+CuckooMap_declare(hm_name, key_t, val_t, hash_t) \
+CuckooMap_define(hm_name, key_t, val_t, hash_t, hash, keycmp)
+
+#endif
@@ -0,0 +1,372 @@
+#ifndef __DEQUE_H__
+#define __DEQUE_H__
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include "bigalloc.h"
+
+/*A deque is a ring buffer, it's size is always a power of 2 so indices wrap with a mask.*/
+#define DEQUE_DEFAULT_SIZE 8
+
+/* ========================= DECLARATIONS ========================= */
+
+#define Deque_struct_declare(Deque_name) typedef struct Deque_name Deque_name;
+
+#define Deque_new_declare(Deque_name) \
+/** \
+ * Create a new deque with the default size(See 'DEQUE_DEFAULT_SIZE'). \
+ * @return A new(malloc'd) deque. \
+*/ \
+Deque_name* Deque_name##_new();
+
+#define Deque_news_declare(Deque_name) \
+/** \
+ * Create a new deque with room for a given amount of elements. \
+ * @param size The initial size of the deque, rounded up to a power of 2. \
+ * @return A new(malloc'd) deque. \
+*/ \
+Deque_name* Deque_name##_news(size_t size);
+
+#define Deque_init_declare(Deque_name) \
+/** \
+ * Initializes a deque. \
+ * @note not free memory! If the deque is already initialized, free before calling. \
+ * @param deque The pointer to the deque. \
+ * @param size The initial size of the deque, rounded up to a power of 2. \
+*/ \
+void Deque_name##_init(Deque_name* deque, size_t size);
+
+#define Deque_size_declare(Deque_name) \
+/** \
+ * Returns the amount of elements in the deque. \
+ * @param deque The pointer to the deque. \
+ * @return The amount of elements. \
+*/ \
+size_t Deque_name##_size(const Deque_name* deque);
+
+#define Deque_at_declare(Deque_name, type) \
+/** \
+ * Returns a pointer to an element at a given index, counted from the front. \
+ * @param deque The pointer to the deque. \
+ * @param index The index of the element to return. \
+ * @return A pointer to the element at 'index'. \
+*/ \
+type* Deque_name##_at(Deque_name* deque, size_t index);
+
+#define Deque_get_declare(Deque_name, type) \
+/** \
+ * Returns an element at a given index, counted from the front. \
+ * @param deque The pointer to the deque. \
+ * @param index The index of the element to return. \
+ * @return The element at 'index'. \
+*/ \
+type Deque_name##_get(const Deque_name* deque, size_t index);
+
+#define Deque_set_declare(Deque_name, type) \
+/** \
+ * Sets an element at a given index, counted from the front. \
+ * @param deque The pointer to the deque. \
+ * @param element The element to place at 'index'. \
+ * @param index The index of the element to set. \
+*/ \
+void Deque_name##_set(Deque_name* deque, type element, size_t index);
+
+#define Deque_reserve_declare(Deque_name) \
+/** \
+ * Makes room for at least a given amount of elements. \
+ * @param deque The pointer to the deque. \
+ * @param size The amount of elements the deque must be able to store, rounded up to a power of 2. \
+*/ \
+void Deque_name##_reserve(Deque_name* deque, size_t size);
+
+#define Deque_pushBack_declare(Deque_name, type) \
+/** \
+ * Adds an element to the back of the deque. \
+ * @param deque The pointer to the deque. \
+ * @param element The element to add. \
+*/ \
+void Deque_name##_pushBack(Deque_name* deque, type element);
+
+#define Deque_pushFront_declare(Deque_name, type) \
+/** \
+ * Adds an element to the front of the deque. \
+ * @param deque The pointer to the deque. \
+ * @param element The element to add. \
+*/ \
+void Deque_name##_pushFront(Deque_name* deque, type element);
+
+#define Deque_pushArray_declare(Deque_name, type) \
+/** \
+ * Copies an array to the back of the deque, with at most two memcpy's. \
+ * @param deque The pointer to the deque. \
+ * @param arr The array to copy. \
+ * @param size The size of the array, or the amount of elements to copy. \
+*/ \
+void Deque_name##_pushArray(Deque_name* deque, const type* arr, size_t size);
+
+#define Deque_popBack_declare(Deque_name, type) \
+/** \
+ * Removes the element at the back of the deque and returns it. \
+ * @param deque The pointer to the deque. \
+ * @return The removed element. \
+*/ \
+type Deque_name##_popBack(Deque_name* deque);
+
+#define Deque_popFront_declare(Deque_name, type) \
+/** \
+ * Removes the element at the front of the deque and returns it. \
+ * @param deque The pointer to the deque. \
+ * @return The removed element. \
+*/ \
+type Deque_name##_popFront(Deque_name* deque);
+
+#define Deque_segments_declare(Deque_name, type) \
+/** \
+ * Get the elements as two contiguous segments of the ring buffer, the first \
+ * segment starts at the front and the second continues it. \
+ * @param deque The pointer to the deque. \
+ * @param first Set to the first segment. \
+ * @param firstSize Set to the amount of elements in the first segment. \
+ * @param second Set to the second segment. \
+ * @param secondSize Set to the amount of elements in the second segment, 0 if the elements don't wrap. \
+*/ \
+void Deque_name##_segments(Deque_name* deque, type** first, size_t* firstSize, \
+	type** second, size_t* secondSize);
+
+#define Deque_clear_declare(Deque_name) \
+/** \
+ * Removes all the elements, keeping the memory. \
+ * @param deque The pointer to the deque. \
+*/ \
+void Deque_name##_clear(Deque_name* deque);
+
+#define Deque_delete_declare(Deque_name) \
+/** \
+ * Free all the memory used by the deque. \
+ * @param deque The pointer to the deque. \
+ * @note Do not call with deques that aren't malloc'd! Call `DS_FREE(deque->_arr)` instead. \
+*/ \
+void Deque_name##_delete(Deque_name* deque);
+
+
+/* ========================= DEFINITIONS ========================= */
+
+
+#define Deque_struct_define(Deque_name, type) \
+struct Deque_name { \
+	type* _arr; \
+	/*the index of the front element in '_arr'*/ \
+	size_t _head; \
+	size_t _size; \
+	/*always a power of 2*/ \
+	size_t _maxSize; \
+};
+
+#define Deque_new_define(Deque_name) \
+Deque_name* Deque_name##_new() { \
+	return Deque_name##_news(DEQUE_DEFAULT_SIZE); \
+}
+
+#define Deque_news_define(Deque_name) \
+Deque_name* Deque_name##_news(size_t size) { \
+	Deque_name* deque = (Deque_name*)malloc(sizeof(Deque_name)); \
+	if (!deque){ \
+		fprintf(stderr, "Error at Deque_name##_news: malloc returned NULL\n"); \
+		exit(EXIT_FAILURE); \
+	} \
+	Deque_name##_init(deque, size); \
+	return deque; \
+}
+
+#define Deque_init_define(Deque_name, type) \
+/*Returns the smallest power of 2 that's at least 'size'.*/ \
+static inline size_t Deque_name##_roundSize(size_t size) { \
+	size_t round = 1; \
+	while (round < size) round *= 2; \
+	return round; \
+} \
+ \
+void Deque_name##_init(Deque_name* deque, size_t size) { \
+	size = Deque_name##_roundSize(size); \
+	deque->_arr = (type*)DS_MALLOC(size * sizeof(type)); \
+	if (!deque->_arr){ \
+		fprintf(stderr, "Error at Deque_name##_init: malloc returned NULL\n"); \
+		exit(EXIT_FAILURE); \
+	} \
+	deque->_head = 0; \
+	deque->_size = 0; \
+	deque->_maxSize = size; \
+}
+
+#define Deque_size_define(Deque_name) \
+size_t Deque_name##_size(const Deque_name* deque) { return deque->_size; }
+
+#define Deque_at_define(Deque_name, type) \
+type* Deque_name##_at(Deque_name* deque, size_t index) { \
+	if (index >= deque->_size){ \
+		fprintf(stderr, "Error at Deque_name##_at: index(%zu) is out of bounds(%zu)\n", \
+			index, deque->_size); \
+		exit(EXIT_FAILURE); \
+		return NULL; \
+	} \
+	return deque->_arr + ((deque->_head + index) & (deque->_maxSize - 1)); \
+}
+
+#define Deque_get_define(Deque_name, type) \
+type Deque_name##_get(const Deque_name* deque, size_t index) { \
+	if (index >= deque->_size){ \
+		fprintf(stderr, "Error at Deque_name##_get: index(%zu) is out of bounds(%zu)\n", \
+			index, deque->_size); \
+		exit(EXIT_FAILURE); \
+	} \
+	return deque->_arr[(deque->_head + index) & (deque->_maxSize - 1)]; \
+}
+
+#define Deque_set_define(Deque_name, type) \
+void Deque_name##_set(Deque_name* deque, type element, size_t index) { \
+	*Deque_name##_at(deque, index) = element; \
+}
+
+#define Deque_reserve_define(Deque_name, type) \
+void Deque_name##_reserve(Deque_name* deque, size_t size) { \
+	if (size <= deque->_maxSize) return; \
+	size_t oldSize = deque->_maxSize; \
+	size_t newSize = Deque_name##_roundSize(size); \
+	type* newArr = (type*)DS_REALLOC(deque->_arr, newSize * sizeof(type)); \
+	if (!newArr){ \
+		fprintf(stderr, "Error at Deque_name##_reserve: realloc returned NULL\n"); \
+		exit(EXIT_FAILURE); \
+	} \
+	deque->_arr = newArr; \
+	deque->_maxSize = newSize; \
+	/*the elements that wrapped to the start move to right after the old end,*/ \
+	/*the new size is at least double so they fit there*/ \
+	if (deque->_head + deque->_size > oldSize) { \
+		memcpy(newArr + oldSize, newArr, (deque->_head + deque->_size - oldSize) * sizeof(type)); \
+	} \
+}
+
+#define Deque_pushBack_define(Deque_name, type) \
+void Deque_name##_pushBack(Deque_name* deque, type element) { \
+	if (deque->_size == deque->_maxSize) Deque_name##_reserve(deque, deque->_maxSize * 2); \
+	deque->_arr[(deque->_head + deque->_size) & (deque->_maxSize - 1)] = element; \
+	deque->_size++; \
+}
+
+#define Deque_pushFront_define(Deque_name, type) \
+void Deque_name##_pushFront(Deque_name* deque, type element) { \
+	if (deque->_size == deque->_maxSize) Deque_name##_reserve(deque, deque->_maxSize * 2); \
+	deque->_head = (deque->_head - 1) & (deque->_maxSize - 1); \
+	deque->_arr[deque->_head] = element; \
+	deque->_size++; \
+}
+
+#define Deque_pushArray_define(Deque_name, type) \
+void Deque_name##_pushArray(Deque_name* deque, const type* arr, size_t size) { \
+	Deque_name##_reserve(deque, deque->_size + size); \
+	size_t tail = (deque->_head + deque->_size) & (deque->_maxSize - 1); \
+	size_t firstSize = deque->_maxSize - tail; \
+	if (firstSize > size) firstSize = size; \
+	memcpy(deque->_arr + tail, arr, firstSize * sizeof(type)); \
+	memcpy(deque->_arr, arr + firstSize, (size - firstSize) * sizeof(type)); \
+	deque->_size += size; \
+}
+
+#define Deque_popBack_define(Deque_name, type) \
+type Deque_name##_popBack(Deque_name* deque) { \
+	if (!deque->_size){ \
+		fprintf(stderr, "Error at Deque_name##_popBack: the deque is empty\n"); \
+		exit(EXIT_FAILURE); \
+	} \
+	deque->_size--; \
+	return deque->_arr[(deque->_head + deque->_size) & (deque->_maxSize - 1)]; \
+}
+
+#define Deque_popFront_define(Deque_name, type) \
+type Deque_name##_popFront(Deque_name* deque) { \
+	if (!deque->_size){ \
+		fprintf(stderr, "Error at Deque_name##_popFront: the deque is empty\n"); \
+		exit(EXIT_FAILURE); \
+	} \
+	type element = deque->_arr[deque->_head]; \
+	deque->_head = (deque->_head + 1) & (deque->_maxSize - 1); \
+	deque->_size--; \
+	return element; \
+}
+
+#define Deque_segments_define(Deque_name, type) \
+void Deque_name##_segments(Deque_name* deque, type** first, size_t* firstSize, \
+	type** second, size_t* secondSize) { \
+	size_t untilEnd = deque->_maxSize - deque->_head; \
+	*first = deque->_arr + deque->_head; \
+	*firstSize = deque->_size < untilEnd ? deque->_size : untilEnd; \
+	*second = deque->_arr; \
+	*secondSize = deque->_size - *firstSize; \
+}
+
+#define Deque_clear_define(Deque_name) \
+void Deque_name##_clear(Deque_name* deque) { \
+	deque->_head = 0; \
+	deque->_size = 0; \
+}
+
+#define Deque_delete_define(Deque_name) \
+void Deque_name##_delete(Deque_name* deque) { \
+	DS_FREE(deque->_arr); \
+	deque->_arr = NULL; \
+	free(deque); \
+}
+
+
+/* ========================= ALL ========================= */
+
+
+#define Deque_declare(Deque_name, type) \
+Deque_struct_declare(Deque_name) \
+Deque_new_declare(Deque_name) \
+Deque_news_declare(Deque_name) \
+Deque_init_declare(Deque_name) \
+Deque_size_declare(Deque_name) \
+Deque_at_declare(Deque_name, type) \
+Deque_get_declare(Deque_name, type) \
+Deque_set_declare(Deque_name, type) \
+Deque_reserve_declare(Deque_name) \
+Deque_pushBack_declare(Deque_name, type) \
+Deque_pushFront_declare(Deque_name, type) \
+Deque_pushArray_declare(Deque_name, type) \
+Deque_popBack_declare(Deque_name, type) \
+Deque_popFront_declare(Deque_name, type) \
+Deque_segments_declare(Deque_name, type) \
+Deque_clear_declare(Deque_name) \
+Deque_delete_declare(Deque_name)
+
+#define Deque_define(Deque_name, type) \
+Deque_struct_define(Deque_name, type) \
+Deque_new_define(Deque_name) \
+Deque_news_define(Deque_name) \
+Deque_init_define(Deque_name, type) \
+Deque_size_define(Deque_name) \
+Deque_at_define(Deque_name, type) \
+Deque_get_define(Deque_name, type) \
+Deque_set_define(Deque_name, type) \
+Deque_reserve_define(Deque_name, type) \
+Deque_pushBack_define(Deque_name, type) \
+Deque_pushFront_define(Deque_name, type) \
+Deque_pushArray_define(Deque_name, type) \
+Deque_popBack_define(Deque_name, type) \
+Deque_popFront_define(Deque_name, type) \
+Deque_segments_define(Deque_name, type) \
+Deque_clear_define(Deque_name) \
+Deque_delete_define(Deque_name)
+
+/**
+ * Generate a deque, a ring buffer with O(1) push and pop at both ends.
+ * @param type The type of the elements.
+ * @param Deque_name The name of the deque.
+*/
+#define STRUCT_DEQUE(type, Deque_name) \
+Deque_declare(Deque_name, type) \
+Deque_define(Deque_name, type)
+
+#endif
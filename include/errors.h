@@ -1,5 +1,10 @@
+#ifndef __ERRORS_H__
+#define __ERRORS_H__
+
 /**The various return codes for the data structures.*/
 typedef enum DataStructs_codes_t {
+  /**The hashmap's put method added an entry and evicted the oldest one.*/
+  HMP_EVICT = 3,
   /**The hashmap's put method overwrote an entry(set mode).*/
   HMP_SET = 2,
   /**The hashmap's put method added an entry.*/
@@ -17,5 +22,11 @@ typedef enum DataStructs_codes_t {
   /**A value of a paremeter is out of the range of valid values.*/
   ERR_OUTOFRANGE = -5,
   /**A key was not found in the hashmap.*/
-  ERR_KEYNOTFOUND = -6
-} DS_codes_t;
\ No newline at end of file
+  ERR_KEYNOTFOUND = -6,
+  /**The data structure is empty.*/
+  ERR_EMPTY = -7,
+  /**An input/output error, reading or writing a file failed.*/
+  ERR_IO = -8
+} DS_codes_t;
+
+#endif
\ No newline at end of file
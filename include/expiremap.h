@@ -0,0 +1,514 @@
+#ifndef __EXPIRE_MAP_H__
+#define __EXPIRE_MAP_H__
+
+/**
+ * @file expiremap.h
+ * @brief A hash map where every entry has a deadline. Same layout and API as
+ * the hash map in hashmap.h, but the entries are also linked into the lists of
+ * a hierarchical timing wheel, so advancing the clock only touches the lists
+ * that are due, instead of sweeping over the whole map.
+ *
+ * The wheel has EXPIREMAP_LEVELS levels of EXPIREMAP_SLOTS slots, a slot in
+ * level l spans 64^l ticks. An entry is placed in the lowest level in which
+ * it's deadline and the current time differ, when the clock reaches the start
+ * of it's slot the entry is moved to a lower level, or expired. Deadlines that
+ * are too far for the wheel wait in an overflow list. A tick is whatever unit
+ * the caller uses for time, for example milliseconds.
+*/
+
+#include<stdint.h>
+#include "hashmap.h"
+
+/**The amount of levels in the timing wheel.*/
+#define EXPIREMAP_LEVELS 4
+/**The amount of bits of the time that each level of the wheel covers.*/
+#define EXPIREMAP_SLOT_BITS 6
+/**The amount of slots in each level of the timing wheel.*/
+#define EXPIREMAP_SLOTS (1 << EXPIREMAP_SLOT_BITS)
+/**The list of entries with deadlines too far for the wheel.*/
+#define EXPIREMAP_OVERFLOW (EXPIREMAP_LEVELS * EXPIREMAP_SLOTS)
+/**The list of entries that expired and wait to be returned by advance().*/
+#define EXPIREMAP_DUE (EXPIREMAP_OVERFLOW + 1)
+/**The amount of lists in the timing wheel, including overflow and due.*/
+#define EXPIREMAP_LISTS (EXPIREMAP_DUE + 1)
+/**The wheel list of an entry that isn't linked into any list.*/
+#define EXPIREMAP_NONE ((unsigned short)-1)
+/**A deadline that never expires.*/
+#define EXPIREMAP_NEVER UINT64_MAX
+
+/**
+ * Returns the level of the timing wheel for a deadline.
+ * @param deadline The deadline, must be bigger than `now`.
+ * @param now The current time of the wheel.
+ * @return The level, EXPIREMAP_LEVELS or more if it's too far for the wheel.
+*/
+static inline unsigned expiremap_level(uint64_t deadline, uint64_t now) {
+  uint64_t diff = deadline ^ now;
+  unsigned level = 0;
+  while (diff >>= EXPIREMAP_SLOT_BITS) level++;
+  return level;
+}
+
+/**
+ * Returns the index of the lowest set bit in a non zero word.
+*/
+static inline unsigned expiremap_lowest_bit(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(word);
+#else
+  unsigned bit = 0;
+  while (!(word & 1)) { word >>= 1; bit++; }
+  return bit;
+#endif
+}
+
+/* ========================= DECLARATIONS ========================= */
+
+#define ExpireMap_put_declare(hm_name, key_t, val_t) \
+/** \
+ * Adds or overwrites a key value pair to the map, with a deadline. \
+ * @param map The expiring map. \
+ * @param key The key by which to map the pair. \
+ * @param value The value to map to the key. \
+ * @param deadline The time at which the pair expires, EXPIREMAP_NEVER for \
+ * a pair that doesn't expire. \
+ * @return HMP_ADD if a new pair was added, HMP_SET if the key already exists \
+ * and it's paired value and deadline were overwritten. An error code on \
+ * failure. Can only while adding a new pair, not when setting. \
+ * @note Errors:  \
+ * ERR_MEM - Memory allocation error. \
+*/ \
+DS_codes_t hm_name##_put(hm_name *map, const key_t *key, const val_t *value, \
+  uint64_t deadline);
+
+#define ExpireMap_set_deadline_declare(hm_name, key_t) \
+/** \
+ * Change the deadline of a key, for example to extend a session. \
+ * @param map The expiring map. \
+ * @param key The key to change the deadline of. \
+ * @param deadline The new deadline, EXPIREMAP_NEVER to never expire. \
+ * @return DS_SUCCESS on success, an error code otherwise. \
+ * @note Errors: \
+ * ERR_KEYNOTFOUND - If the key was not found in the map. \
+*/ \
+DS_codes_t hm_name##_set_deadline(hm_name *map, const key_t *key, \
+  uint64_t deadline);
+
+#define ExpireMap_advance_declare(hm_name, key_t, val_t) \
+/** \
+ * Advance the clock of the map, and remove the entries that expired, \
+ * entries expire when the clock reaches their deadline. At most `max` \
+ * entries are removed per call, call again with the same time while the \
+ * return value is `max` to get the rest of the batch. \
+ * @param map The expiring map. \
+ * @param now The new time, times before the current time are ignored. \
+ * @param keys An array to copy the keys of the removed entries into, can be \
+ * NULL. \
+ * @param values An array to copy the values of the removed entries into, \
+ * can be NULL. \
+ * @param max The size of the arrays, the maximum amount of entries to remove. \
+ * @return The amount of entries removed. \
+*/ \
+size_t hm_name##_advance(hm_name *map, uint64_t now, key_t *keys, \
+  val_t *values, size_t max);
+
+/* ========================= DEFINITIONS ========================= */
+
+#define ExpireMap_entry_define(hm_name, key_t, val_t, hash_t) \
+/**Represents an entry in the expiring map.*/ \
+struct hm_name##_entry_t { \
+  /**The key of the entry*/ \
+  const key_t key; \
+  /**The hash of the key.*/ \
+  const hash_t key_hash; \
+  /**The index of the next entry in case of hash collisions.*/ \
+  ssize_t next; \
+  /**The time at which the entry expires.*/ \
+  uint64_t deadline; \
+  /**The index of the previous entry in the wheel list, -1 if first.*/ \
+  ssize_t wheel_prev; \
+  /**The index of the next entry in the wheel list, -1 if last.*/ \
+  ssize_t wheel_next; \
+  /**The wheel list the entry is linked to, EXPIREMAP_NONE if none.*/ \
+  unsigned short wheel_list; \
+  /**The value of the entry.*/ \
+  val_t val; \
+};
+
+#define ExpireMap_struct_define(hm_name) \
+/**Represents an expiring hash map data structure.*/ \
+struct hm_name { \
+  /**The entries of the map, all the Key-Value pairs.*/ \
+  hm_name##_entry_t *entries; \
+  /**An array of indices that maps a normalized hash to an entry index. \
+   * Index -1 means there is no such entry.*/ \
+  ssize_t* buckets; \
+  /**The amount of entries in the map.*/ \
+  size_t size; \
+  /**The next empty cell in the entries array.*/ \
+  size_t next_empty; \
+  /**The maximum capacity of the map.*/ \
+  size_t cap; \
+  /**The current time of the map.*/ \
+  uint64_t now; \
+  /**The smallest deadline in the overflow list, may be too small.*/ \
+  uint64_t overflow_min; \
+  /**A bit for every slot in every level that isn't empty.*/ \
+  uint64_t occupied[EXPIREMAP_LEVELS]; \
+  /**The index of the first entry of every wheel list, -1 if empty.*/ \
+  ssize_t wheel[EXPIREMAP_LISTS]; \
+};
+
+#define ExpireMap_wheel_define(hm_name) \
+/**Unlink the entry at index `i` from it's wheel list.*/ \
+static void hm_name##_wheel_unlink(hm_name *map, ssize_t i) { \
+  hm_name##_entry_t *entry = map->entries + i; \
+  unsigned short list = entry->wheel_list; \
+  if (list == EXPIREMAP_NONE) return; \
+  if (entry->wheel_prev == -1) map->wheel[list] = entry->wheel_next; \
+  else map->entries[entry->wheel_prev].wheel_next = entry->wheel_next; \
+  if (entry->wheel_next != -1) \
+    map->entries[entry->wheel_next].wheel_prev = entry->wheel_prev; \
+  if (list < EXPIREMAP_OVERFLOW && map->wheel[list] == -1) { \
+    map->occupied[list / EXPIREMAP_SLOTS] &= \
+      ~((uint64_t)1 << (list % EXPIREMAP_SLOTS)); \
+  } \
+  entry->wheel_list = EXPIREMAP_NONE; \
+} \
+/**Link the entry at index `i` to the wheel list that fits it's deadline.*/ \
+static void hm_name##_wheel_place(hm_name *map, ssize_t i) { \
+  hm_name##_entry_t *entry = map->entries + i; \
+  unsigned short list; \
+  if (entry->deadline == EXPIREMAP_NEVER) { \
+    entry->wheel_list = EXPIREMAP_NONE; \
+    return; \
+  } \
+  if (entry->deadline <= map->now) list = EXPIREMAP_DUE; \
+  else { \
+    unsigned level = expiremap_level(entry->deadline, map->now); \
+    if (level >= EXPIREMAP_LEVELS) { \
+      list = EXPIREMAP_OVERFLOW; \
+      if (entry->deadline < map->overflow_min) \
+        map->overflow_min = entry->deadline; \
+    } else { \
+      unsigned slot = (entry->deadline >> (level * EXPIREMAP_SLOT_BITS)) \
+        % EXPIREMAP_SLOTS; \
+      list = level * EXPIREMAP_SLOTS + slot; \
+      map->occupied[level] |= (uint64_t)1 << slot; \
+    } \
+  } \
+  entry->wheel_list = list; \
+  entry->wheel_prev = -1; \
+  entry->wheel_next = map->wheel[list]; \
+  if (entry->wheel_next != -1) map->entries[entry->wheel_next].wheel_prev = i; \
+  map->wheel[list] = i; \
+} \
+/**Detach a whole wheel list and place each of it's entries again.*/ \
+static void hm_name##_wheel_cascade(hm_name *map, unsigned list) { \
+  ssize_t i = map->wheel[list]; \
+  map->wheel[list] = -1; \
+  if (list < EXPIREMAP_OVERFLOW) { \
+    map->occupied[list / EXPIREMAP_SLOTS] &= \
+      ~((uint64_t)1 << (list % EXPIREMAP_SLOTS)); \
+  } \
+  while (i != -1) { \
+    ssize_t next = map->entries[i].wheel_next; \
+    hm_name##_wheel_place(map, i); \
+    i = next; \
+  } \
+}
+
+#define ExpireMap_relocate_define(hm_name) \
+/**Called when shrinking moves an entry to a different index, after it was \
+ * copied to it's new index. Points it's neighbours in it's wheel list at it.*/ \
+static inline void hm_name##_relocate(hm_name *map, ssize_t from, ssize_t to) { \
+  hm_name##_entry_t *entry = map->entries + to; \
+  (void)from; \
+  if (entry->wheel_list == EXPIREMAP_NONE) return; \
+  if (entry->wheel_prev == -1) map->wheel[entry->wheel_list] = to; \
+  else map->entries[entry->wheel_prev].wheel_next = to; \
+  if (entry->wheel_next != -1) map->entries[entry->wheel_next].wheel_prev = to; \
+}
+
+#define ExpireMap_init_define(hm_name) \
+DS_codes_t hm_name##_init(hm_name *map, size_t size) { \
+  size_t initial = nearest_prime(size); \
+ \
+  map->buckets = DS_MALLOC(initial*sizeof(size_t)); \
+  if (map->buckets == NULL) return ERR_MEM; \
+  for(size_t i = 0; i < initial; i++) map->buckets[i] = -1; \
+ \
+  map->entries = DS_MALLOC(initial*sizeof(hm_name##_entry_t)); \
+  if (map->entries == NULL) { \
+    DS_FREE(map->buckets); \
+    return ERR_MEM; \
+  } \
+  for(size_t i = 0; i < initial; i++) { \
+    map->entries[i].next = i+1; \
+  } \
+ \
+  map->cap = initial; \
+  map->size = 0; \
+  map->next_empty = 0; \
+  map->now = 0; \
+  map->overflow_min = EXPIREMAP_NEVER; \
+  for (size_t i = 0; i < EXPIREMAP_LEVELS; i++) map->occupied[i] = 0; \
+  for (size_t i = 0; i < EXPIREMAP_LISTS; i++) map->wheel[i] = -1; \
+ \
+  return DS_SUCCESS; \
+}
+
+#define ExpireMap_put_define(hm_name, key_t, val_t, hash_t) \
+DS_codes_t hm_name##_put(hm_name *map, const key_t *key, const val_t *value, \
+  uint64_t deadline) { \
+  hash_t hash = hm_name##_hash(key); \
+  size_t bucket = hash % map->cap; \
+ \
+  /* If the key exists, overwrite it and move it to it's new deadline. */ \
+  for(ssize_t i = map->buckets[bucket]; i != -1; i = map->entries[i].next) { \
+    hm_name##_entry_t *entry = map->entries + i; \
+    if (entry->key_hash == hash && hm_name##_keycmp(key, &entry->key)) { \
+      entry->val = *value; \
+      hm_name##_wheel_unlink(map, i); \
+      entry->deadline = deadline; \
+      hm_name##_wheel_place(map, i); \
+      return HMP_SET; \
+    } \
+  } \
+ \
+  /* Key doesn't exist. Insert */ \
+  size_t empty = map->next_empty; \
+  map->next_empty = map->entries[map->next_empty].next; \
+  hm_name##_entry_t new_entry = { \
+    .key = *key, \
+    .key_hash = hash, \
+    .next = map->buckets[bucket], \
+    .deadline = deadline, \
+    .val = *value \
+  }; \
+  map->buckets[bucket] = empty; \
+  memcpy(map->entries + empty, &new_entry, sizeof(hm_name##_entry_t)); \
+  hm_name##_wheel_place(map, empty); \
+ \
+  /* Check if resize needed. */ \
+  map->size++; \
+  if (map->size == map->cap) { \
+    DS_codes_t res = hm_name##_resize(map, map->cap + 1); \
+    if (res != DS_SUCCESS) return res; \
+  } \
+ \
+  return HMP_ADD; \
+}
+
+#define ExpireMap_set_deadline_define(hm_name, key_t, hash_t) \
+DS_codes_t hm_name##_set_deadline(hm_name *map, const key_t *key, \
+  uint64_t deadline) { \
+  hash_t hash = hm_name##_hash(key); \
+  size_t bucket = hash % map->cap; \
+ \
+  for (ssize_t i = map->buckets[bucket]; i != -1; i = map->entries[i].next) { \
+    hm_name##_entry_t *entry = map->entries + i; \
+    if (entry->key_hash == hash && hm_name##_keycmp(key, &entry->key)) { \
+      hm_name##_wheel_unlink(map, i); \
+      entry->deadline = deadline; \
+      hm_name##_wheel_place(map, i); \
+      return DS_SUCCESS; \
+    } \
+  } \
+ \
+  return ERR_KEYNOTFOUND; \
+}
+
+#define ExpireMap_remove_define(hm_name, key_t, hash_t) \
+DS_codes_t hm_name##_remove(hm_name *map, const key_t *key) { \
+  hash_t hash = hm_name##_hash(key); \
+  size_t bucket = hash % map->cap; \
+  ssize_t prev = -1; \
+ \
+  for (ssize_t i = map->buckets[bucket]; i != -1; i = map->entries[i].next) { \
+    hm_name##_entry_t *entry = map->entries + i; \
+    if (entry->key_hash == hash && hm_name##_keycmp(key, &entry->key)) { \
+      /* Unlink entry from the bucket and from the wheel. */ \
+      if (prev == -1) map->buckets[bucket] = entry->next; \
+      else map->entries[prev].next = entry->next; \
+      hm_name##_wheel_unlink(map, i); \
+      /* Set the entry's index as the next empty slot. */ \
+      entry->next = map->next_empty; \
+      map->next_empty = i; \
+      map->size--; \
+      return DS_SUCCESS; \
+    } \
+    prev = i; \
+  } \
+ \
+  return ERR_KEYNOTFOUND; \
+}
+
+#define ExpireMap_advance_define(hm_name, key_t, val_t) \
+size_t hm_name##_advance(hm_name *map, uint64_t now, key_t *keys, \
+  val_t *values, size_t max) { \
+  size_t count = 0; \
+ \
+  while (true) { \
+    /* Remove the entries that are due. */ \
+    while (count < max && map->wheel[EXPIREMAP_DUE] != -1) { \
+      ssize_t i = map->wheel[EXPIREMAP_DUE]; \
+      hm_name##_entry_t *entry = map->entries + i; \
+      hm_name##_wheel_unlink(map, i); \
+ \
+      size_t bucket = entry->key_hash % map->cap; \
+      if (map->buckets[bucket] == i) map->buckets[bucket] = entry->next; \
+      else { \
+        ssize_t prev = map->buckets[bucket]; \
+        while (map->entries[prev].next != i) prev = map->entries[prev].next; \
+        map->entries[prev].next = entry->next; \
+      } \
+      if (keys != NULL) memcpy(keys + count, &entry->key, sizeof(key_t)); \
+      if (values != NULL) values[count] = entry->val; \
+      entry->next = map->next_empty; \
+      map->next_empty = i; \
+      map->size--; \
+      count++; \
+    } \
+    if (count == max) return count; \
+ \
+    /* Find the next time a list needs to be cascaded, the first occupied \
+     * slot of every level starts at a time after the current time. */ \
+    uint64_t next = EXPIREMAP_NEVER; \
+    for (unsigned level = 0; level < EXPIREMAP_LEVELS; level++) { \
+      if (!map->occupied[level]) continue; \
+      unsigned shift = level * EXPIREMAP_SLOT_BITS; \
+      uint64_t start = map->now >> (shift + EXPIREMAP_SLOT_BITS) \
+        << (shift + EXPIREMAP_SLOT_BITS); \
+      start |= (uint64_t)expiremap_lowest_bit(map->occupied[level]) << shift; \
+      if (start < next) next = start; \
+    } \
+    uint64_t overflow = EXPIREMAP_NEVER; \
+    if (map->wheel[EXPIREMAP_OVERFLOW] != -1) { \
+      unsigned shift = EXPIREMAP_LEVELS * EXPIREMAP_SLOT_BITS; \
+      overflow = map->overflow_min >> shift << shift; \
+      if (overflow < map->now) overflow = map->now; \
+      if (overflow < next) next = overflow; \
+    } \
+    if (next > now || next == EXPIREMAP_NEVER) { \
+      if (now > map->now) map->now = now; \
+      return count; \
+    } \
+ \
+    /* Move the clock to the next time, and cascade the lists that start at \
+     * it, entries that reached their deadline go to the due list. */ \
+    map->now = next; \
+    if (overflow == next) { \
+      map->overflow_min = EXPIREMAP_NEVER; \
+      hm_name##_wheel_cascade(map, EXPIREMAP_OVERFLOW); \
+    } \
+    for (unsigned level = EXPIREMAP_LEVELS; level-- > 0;) { \
+      if (!map->occupied[level]) continue; \
+      unsigned shift = level * EXPIREMAP_SLOT_BITS; \
+      unsigned slot = expiremap_lowest_bit(map->occupied[level]); \
+      if ((next >> shift) % EXPIREMAP_SLOTS != slot) continue; \
+      if (next % ((uint64_t)1 << shift) != 0) continue; \
+      hm_name##_wheel_cascade(map, level * EXPIREMAP_SLOTS + slot); \
+    } \
+  } \
+}
+
+#define ExpireMap_clear_define(hm_name) \
+void hm_name##_clear(hm_name *map) { \
+  for (size_t i = 0; i < map->cap; i++) { \
+    map->buckets[i] = -1; \
+    map->entries[i].next = i + 1; \
+  } \
+  map->next_empty = 0; \
+  map->size = 0; \
+  map->overflow_min = EXPIREMAP_NEVER; \
+  for (size_t i = 0; i < EXPIREMAP_LEVELS; i++) map->occupied[i] = 0; \
+  for (size_t i = 0; i < EXPIREMAP_LISTS; i++) map->wheel[i] = -1; \
+}
+
+/* ========================= ALL ========================= */
+
+/**
+ * Generate the declarations for an expiring hash map data structure for a
+ * given key and value types.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @param hash_t The data type of the hash.
+ * @note It's best to put this macro in a header file.
+*/
+#define ExpireMap_declare(hm_name, key_t, val_t, hash_t) \
+HashMap_entry_declare(hm_name) \
+HashMap_struct_declare(hm_name) \
+HashMap_hash_declare(hm_name, key_t, hash_t) \
+HashMap_keycmp_declare(hm_name, key_t) \
+HashMap_new_declare(hm_name) \
+HashMap_snew_declare(hm_name) \
+HashMap_init_declare(hm_name) \
+ExpireMap_put_declare(hm_name, key_t, val_t) \
+ExpireMap_set_deadline_declare(hm_name, key_t) \
+HashMap_has_declare(hm_name, key_t) \
+HashMap_get_declare(hm_name, key_t, val_t) \
+HashMap_remove_declare(hm_name, key_t) \
+ExpireMap_advance_declare(hm_name, key_t, val_t) \
+HashMap_clear_declare(hm_name) \
+HashMap_resize_declare(hm_name) \
+HashMap_destroy_declare(hm_name) \
+HashMap_free_declare(hm_name)
+
+/**
+ * Generate the definitions for the expiring hash map data structure for a
+ * given key and value types.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @param hash_t The data type of the hash.
+ * @param hash A pointer to the hash function for hashing keys.
+ * @param keycmp A pointer to a function for comparing keys.
+ * @note It's best to put this macro in a code file.
+*/
+#define ExpireMap_define(hm_name, key_t, val_t, hash_t, hash, keycmp) \
+ExpireMap_entry_define(hm_name, key_t, val_t, hash_t) \
+ExpireMap_struct_define(hm_name) \
+HashMap_no_filter_define(hm_name) \
+HashMap_hash_define(hm_name, key_t, hash_t, hash) \
+HashMap_keycmp_define(hm_name, key_t, keycmp) \
+ExpireMap_wheel_define(hm_name) \
+HashMap_new_define(hm_name) \
+HashMap_snew_define(hm_name) \
+ExpireMap_init_define(hm_name) \
+ExpireMap_put_define(hm_name, key_t, val_t, hash_t) \
+ExpireMap_set_deadline_define(hm_name, key_t, hash_t) \
+HashMap_has_define(hm_name, key_t, hash_t) \
+HashMap_get_define(hm_name, key_t, val_t, hash_t) \
+ExpireMap_remove_define(hm_name, key_t, hash_t) \
+ExpireMap_advance_define(hm_name, key_t, val_t) \
+ExpireMap_clear_define(hm_name) \
+ExpireMap_relocate_define(hm_name) \
+HashMap_shrink_define(hm_name) \
+HashMap_resize_define(hm_name) \
+HashMap_destroy_define(hm_name) \
+HashMap_free_define(hm_name)
+
+/**
+ * Generate a full expiring hash map data structure implementation for a given
+ * key and value types. Every entry has a deadline, and advance() removes the
+ * entries whose deadline passed at a cost proportional to the amount of
+ * expired entries, not to the size of the map.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @param hash_t The data type of the hash.
+ * @param hash A pointer to the hash function for hashing keys.
+ * @param keycmp A pointer to a function for comparing keys.
+ * @note The clock of a new map starts at 0, entries don't expire until
+ * advance() is called, until then has() and get() still find them.
+*/
+#define ExpireMap(hm_name, key_t, val_t, hash_t, hash, keycmp) \
+ExpireMap_declare(hm_name, key_t, val_t, hash_t) \
+ExpireMap_define(hm_name, key_t, val_t, hash_t, hash, keycmp)
+
+#endif
@@ -0,0 +1,346 @@
+#ifndef __FROZEN_MAP_H__
+#define __FROZEN_MAP_H__
+
+/**
+ * @file frozenmap.h
+ * @brief Immutable snapshots of a hash map from hashmap.h, indexed by a
+ * minimal perfect hash function. The keys are split into buckets by their
+ * hash, and every bucket gets a pilot, a number that when mixed with the
+ * hashes of the keys in the bucket sends each of them to a different slot
+ * (PTHash style). A lookup reads one pilot and one slot, and never follows a
+ * collision chain. The slots only hold the keys and values.
+*/
+
+#include<stdio.h>
+#include<stdint.h>
+#include "hashmap.h"
+
+/**The average amount of keys in each bucket of the pilots array.*/
+#define FROZENMAP_BUCKET_LOAD 4
+
+/**
+ * Mix the bits of a hash, splitmix64's finalizer.
+ * @param hash The hash to mix.
+ * @return The mixed hash.
+*/
+static inline uint64_t frozenmap_mix(uint64_t hash) {
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ull;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebull;
+  hash ^= hash >> 31;
+  return hash;
+}
+
+/**
+ * Get the bucket of a mixed hash in a frozen map.
+ * @param frozen A pointer to a frozen map.
+ * @param mixed The mixed hash of the key.
+*/
+#define frozenmap_bucket(frozen, mixed) \
+  ((size_t)(((mixed) >> 32) * (frozen)->nbuckets >> 32))
+
+/**
+ * Get the slot of a mixed hash in a frozen map, given the pilot of it's bucket.
+ * @param frozen A pointer to a frozen map.
+ * @param mixed The mixed hash of the key.
+ * @param pilot The pilot of the key's bucket.
+*/
+#define frozenmap_slot(frozen, mixed, pilot) \
+  ((size_t)(frozenmap_mix((mixed) ^ ((uint64_t)(pilot) * 0x9e3779b97f4a7c15ull)) \
+    % (frozen)->size))
+
+/* ========================= DECLARATIONS ========================= */
+
+#define FrozenMap_entry_declare(hm_name) \
+  typedef struct hm_name##_frozen_entry_t hm_name##_frozen_entry_t;
+#define FrozenMap_struct_declare(hm_name) \
+  typedef struct hm_name##_frozen_t hm_name##_frozen_t;
+
+#define FrozenMap_freeze_declare(hm_name) \
+/** \
+ * Build an immutable copy of a hash map, with a minimal perfect hash. \
+ * @param map The hash map to copy, it is not changed. \
+ * @return A pointer to the new frozen map, NULL on failure. \
+ * @note Returns NULL on failed memory allocation, or if two different keys \
+ * have the same hash, since no hash function can tell them apart. \
+*/ \
+hm_name##_frozen_t * hm_name##_freeze(const hm_name *map);
+
+#define FrozenMap_has_declare(hm_name, key_t) \
+/** \
+ * Check if the frozen map has a specified key stored. \
+ * @param frozen The frozen map. \
+ * @param key The key to search for. \
+ * @return True if the key is in the map, false otherwise. \
+*/ \
+bool hm_name##_frozen_has(const hm_name##_frozen_t *frozen, const key_t *key);
+
+#define FrozenMap_get_declare(hm_name, key_t, val_t) \
+/** \
+ * Get the value mapped to a specified key in the frozen map. \
+ * @param frozen The frozen map. \
+ * @param key The key that the value was mapped to. \
+ * @return A pointer to the value, or NULL if it was not found. \
+*/ \
+const val_t * hm_name##_frozen_get(const hm_name##_frozen_t *frozen, \
+  const key_t *key);
+
+#define FrozenMap_write_c_declare(hm_name, key_t, val_t) \
+/** \
+ * Write a frozen map as C source code, so it can be compiled into a program \
+ * instead of being built at startup. The source defines a constant \
+ * hm_name##_frozen_t called `name`, and needs the declarations of the \
+ * frozen map(FrozenMap_declare) to be included before it. \
+ * @param frozen The frozen map. \
+ * @param out The file to write to. \
+ * @param name The name of the variable to define. \
+ * @param write_key A function that writes a key as a C constant expression. \
+ * @param write_val A function that writes a value as a C constant expression. \
+ * @return DS_SUCCESS on success, an error code on failure. \
+ * @note Errors: \
+ * ERR_NULL - One of the parameters is NULL. \
+ * ERR_IO - Failed to write to `out`. \
+*/ \
+DS_codes_t hm_name##_frozen_write_c(const hm_name##_frozen_t *frozen, \
+  FILE *out, const char *name, void (*write_key)(FILE*, const key_t*), \
+  void (*write_val)(FILE*, const val_t*));
+
+#define FrozenMap_free_declare(hm_name) \
+/** \
+ * Releases all the memory the frozen map uses. \
+ * @param frozen The frozen map. \
+ * @note Only for frozen maps that were created with freeze(), not for ones \
+ * that were written with write_c(). \
+*/ \
+void hm_name##_frozen_free(hm_name##_frozen_t *frozen);
+
+/* ========================= DEFINITIONS ========================= */
+
+#define FrozenMap_entry_define(hm_name, key_t, val_t) \
+/**Represents a slot of a frozen map.*/ \
+struct hm_name##_frozen_entry_t { \
+  /**The key of the entry.*/ \
+  const key_t key; \
+  /**The value of the entry.*/ \
+  const val_t val; \
+};
+
+#define FrozenMap_struct_define(hm_name) \
+/**Represents an immutable hash map with a minimal perfect hash.*/ \
+struct hm_name##_frozen_t { \
+  /**The amount of entries in the map, every slot holds an entry.*/ \
+  size_t size; \
+  /**The amount of buckets, the size of the pilots array.*/ \
+  size_t nbuckets; \
+  /**The pilot of every bucket.*/ \
+  const uint32_t *pilots; \
+  /**The entries of the map, in the order of their slots.*/ \
+  const hm_name##_frozen_entry_t *entries; \
+};
+
+#define FrozenMap_freeze_define(hm_name) \
+hm_name##_frozen_t * hm_name##_freeze(const hm_name *map) { \
+  size_t n = map->size; \
+  hm_name##_frozen_t *frozen = malloc(sizeof(hm_name##_frozen_t)); \
+  if (frozen == NULL) return NULL; \
+  frozen->size = n; \
+  frozen->nbuckets = n / FROZENMAP_BUCKET_LOAD + 1; \
+  size_t nbuckets = frozen->nbuckets; \
+ \
+  uint32_t *pilots = calloc(nbuckets, sizeof(uint32_t)); \
+  hm_name##_frozen_entry_t *entries = malloc(n * sizeof(*entries) + 1); \
+  const hm_name##_entry_t **sources = malloc(n * sizeof(*sources) + 1); \
+  uint64_t *mixed = malloc(n * sizeof(uint64_t) + 1); \
+  size_t *starts = calloc(nbuckets + 1, sizeof(size_t)); \
+  size_t *order = malloc(n * sizeof(size_t) + 1); \
+  size_t *by_size = malloc(nbuckets * sizeof(size_t)); \
+  bool *taken = calloc(n + 1, sizeof(bool)); \
+  if (!pilots || !entries || !sources || !mixed || !starts || !order || \
+    !by_size || !taken) goto fail; \
+ \
+  /* Collect the entries and mix their hashes. */ \
+  size_t count = 0, bucket; \
+  hm_name##_entry_t *entry; \
+  map_for_each_entry(map, entry, bucket) { \
+    sources[count] = entry; \
+    mixed[count] = frozenmap_mix((uint64_t)entry->key_hash); \
+    count++; \
+  } \
+ \
+  /* Group the keys by bucket, with a counting sort. */ \
+  for (size_t i = 0; i < n; i++) starts[frozenmap_bucket(frozen, mixed[i]) + 1]++; \
+  size_t largest = 0; \
+  for (size_t b = 0; b < nbuckets; b++) { \
+    if (starts[b + 1] > largest) largest = starts[b + 1]; \
+    starts[b + 1] += starts[b]; \
+  } \
+  { \
+    size_t *fill = by_size; /* Borrowed as the write position of each bucket. */ \
+    memcpy(fill, starts, nbuckets * sizeof(size_t)); \
+    for (size_t i = 0; i < n; i++) order[fill[frozenmap_bucket(frozen, mixed[i])]++] = i; \
+  } \
+ \
+  /* Order the buckets from the biggest to the smallest, the big buckets are \
+   * the hardest to place, so they go while most slots are free. */ \
+  { \
+    size_t pos = 0; \
+    for (size_t s = largest; s > 0; s--) { \
+      for (size_t b = 0; b < nbuckets; b++) { \
+        if (starts[b + 1] - starts[b] == s) by_size[pos++] = b; \
+      } \
+    } \
+    for (size_t i = pos; i < nbuckets; i++) by_size[i] = SIZE_MAX; \
+  } \
+ \
+  /* Search a pilot for every bucket. */ \
+  for (size_t i = 0; i < nbuckets && by_size[i] != SIZE_MAX; i++) { \
+    size_t b = by_size[i]; \
+    size_t first = starts[b], last = starts[b + 1]; \
+    /* Keys with the same hash can never be placed apart. */ \
+    for (size_t j = first; j < last; j++) { \
+      for (size_t k = j + 1; k < last; k++) { \
+        if (mixed[order[j]] == mixed[order[k]]) goto fail; \
+      } \
+    } \
+    uint32_t pilot = 0; \
+    while (true) { \
+      size_t j; \
+      for (j = first; j < last; j++) { \
+        size_t slot = frozenmap_slot(frozen, mixed[order[j]], pilot); \
+        if (taken[slot]) break; \
+        taken[slot] = true; \
+      } \
+      if (j == last) break; \
+      /* Collision, release the slots taken by this pilot and try the next. */ \
+      while (j-- > first) taken[frozenmap_slot(frozen, mixed[order[j]], pilot)] = false; \
+      if (++pilot == UINT32_MAX) goto fail; \
+    } \
+    pilots[b] = pilot; \
+    for (size_t j = first; j < last; j++) { \
+      size_t slot = frozenmap_slot(frozen, mixed[order[j]], pilot); \
+      const hm_name##_entry_t *source = sources[order[j]]; \
+      memcpy((void*)&entries[slot].key, &source->key, sizeof(source->key)); \
+      memcpy((void*)&entries[slot].val, &source->val, sizeof(source->val)); \
+    } \
+  } \
+ \
+  free(sources); free(mixed); free(starts); free(order); free(by_size); \
+  free(taken); \
+  frozen->pilots = pilots; \
+  frozen->entries = entries; \
+  return frozen; \
+ \
+fail: \
+  free(pilots); free(entries); free(sources); free(mixed); free(starts); \
+  free(order); free(by_size); free(taken); free(frozen); \
+  return NULL; \
+}
+
+#define FrozenMap_has_define(hm_name, key_t) \
+bool hm_name##_frozen_has(const hm_name##_frozen_t *frozen, const key_t *key) { \
+  return hm_name##_frozen_get(frozen, key) != NULL; \
+}
+
+#define FrozenMap_get_define(hm_name, key_t, val_t) \
+const val_t * hm_name##_frozen_get(const hm_name##_frozen_t *frozen, \
+  const key_t *key) { \
+  if (frozen->size == 0) return NULL; \
+  uint64_t mixed = frozenmap_mix((uint64_t)hm_name##_hash(key)); \
+  uint32_t pilot = frozen->pilots[frozenmap_bucket(frozen, mixed)]; \
+  const hm_name##_frozen_entry_t *entry = \
+    frozen->entries + frozenmap_slot(frozen, mixed, pilot); \
+  if (!hm_name##_keycmp(key, &entry->key)) return NULL; \
+  return &entry->val; \
+}
+
+#define FrozenMap_write_c_define(hm_name, key_t, val_t) \
+DS_codes_t hm_name##_frozen_write_c(const hm_name##_frozen_t *frozen, \
+  FILE *out, const char *name, void (*write_key)(FILE*, const key_t*), \
+  void (*write_val)(FILE*, const val_t*)) { \
+  if (!frozen || !out || !name || !write_key || !write_val) return ERR_NULL; \
+ \
+  fprintf(out, "/* Generated by " #hm_name "_frozen_write_c, do not edit. */\n"); \
+  fprintf(out, "static const uint32_t %s_pilots[%zu] = {", name, frozen->nbuckets); \
+  for (size_t i = 0; i < frozen->nbuckets; i++) { \
+    fprintf(out, "%s%lu", i % 12 ? ", " : "\n  ", (unsigned long)frozen->pilots[i]); \
+  } \
+  fprintf(out, "\n};\n\n"); \
+ \
+  fprintf(out, "static const " #hm_name "_frozen_entry_t %s_entries[%zu] = {\n", \
+    name, frozen->size ? frozen->size : 1); \
+  for (size_t i = 0; i < frozen->size; i++) { \
+    fprintf(out, "  { "); \
+    write_key(out, &frozen->entries[i].key); \
+    fprintf(out, ", "); \
+    write_val(out, &frozen->entries[i].val); \
+    fprintf(out, " },\n"); \
+  } \
+  if (frozen->size == 0) fprintf(out, "  { 0 }\n"); \
+  fprintf(out, "};\n\n"); \
+ \
+  fprintf(out, "const " #hm_name "_frozen_t %s = {\n", name); \
+  fprintf(out, "  %zu, %zu, %s_pilots, %s_entries\n};\n", \
+    frozen->size, frozen->nbuckets, name, name); \
+  return ferror(out) ? ERR_IO : DS_SUCCESS; \
+}
+
+#define FrozenMap_free_define(hm_name) \
+void hm_name##_frozen_free(hm_name##_frozen_t *frozen) { \
+  if (frozen == NULL) return; \
+  free((void*)frozen->pilots); \
+  free((void*)frozen->entries); \
+  free(frozen); \
+}
+
+/* ========================= ALL ========================= */
+
+/**
+ * Generate the declarations for the frozen version of a hash map.
+ * @param hm_name The name of the hash map, as given to HashMap.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @note It's best to put this macro in a header file.
+*/
+#define FrozenMap_declare(hm_name, key_t, val_t) \
+FrozenMap_entry_declare(hm_name) \
+FrozenMap_struct_declare(hm_name) \
+FrozenMap_entry_define(hm_name, key_t, val_t) \
+FrozenMap_struct_define(hm_name) \
+FrozenMap_freeze_declare(hm_name) \
+FrozenMap_has_declare(hm_name, key_t) \
+FrozenMap_get_declare(hm_name, key_t, val_t) \
+FrozenMap_write_c_declare(hm_name, key_t, val_t) \
+FrozenMap_free_declare(hm_name)
+
+/**
+ * Generate the definitions for the frozen version of a hash map.
+ * @param hm_name The name of the hash map, as given to HashMap.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @note It's best to put this macro in a code file.
+*/
+#define FrozenMap_define(hm_name, key_t, val_t) \
+FrozenMap_freeze_define(hm_name) \
+FrozenMap_has_define(hm_name, key_t) \
+FrozenMap_get_define(hm_name, key_t, val_t) \
+FrozenMap_write_c_define(hm_name, key_t, val_t) \
+FrozenMap_free_define(hm_name)
+
+/**
+ * Generate a frozen version of an already generated hash map, adds the
+ * hm_name##_freeze() function that builds it, and the hm_name##_frozen_*
+ * functions that use it.
+ * @param hm_name The name of the hash map, as given to HashMap.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @note Must come after the HashMap macro of the same map, the frozen map
+ * uses it's hash and keycmp functions.
+ * @note Unlike the other structs, the frozen map structs are defined by the
+ * declare macro, so that sources written with write_c() can use them.
+*/
+#define FrozenMap(hm_name, key_t, val_t) \
+FrozenMap_declare(hm_name, key_t, val_t) \
+FrozenMap_define(hm_name, key_t, val_t)
+
+#endif
@@ -7,6 +7,8 @@
 #include<stdbool.h>
 #include "primes.h"
 #include "errors.h"
+#include "bloom.h"
+#include "bigalloc.h"
 
 /**
  * Get the first entry in a bucket or NULL if the bucket is empty.
@@ -37,6 +39,9 @@
   for((entry) = map_first_entry(map, bucket); (entry) != NULL; \
     (entry) = map_next_entry(map, entry))
 
+/**Below this load, in quarters, a map with auto shrink enabled shrinks.*/
+#define HASHMAP_SHRINK_LOAD 1
+
 // Define ssize_t
 #ifdef _MSC_VER
 #include <BaseTsd.h>
@@ -127,6 +132,31 @@ val_t * hm_name##_get(const hm_name *map, const key_t *key);
 */ \
 DS_codes_t hm_name##_remove(hm_name *map, const key_t *key);
 
+#define HashMap_remove_if_declare(hm_name, key_t, val_t) \
+/** \
+ * Remove every entry that matches a predicate, in one pass over the buckets. \
+ * @param map The hash map. \
+ * @param pred A function that returns true for the entries to remove, it's \
+ * given the key, the value and `ctx`. \
+ * @param ctx A context to pass to the predicate. \
+ * @return The amount of entries that were removed. \
+*/ \
+size_t hm_name##_remove_if(hm_name *map, \
+  bool (*pred)(const key_t*, val_t*, void*), void *ctx);
+
+#define HashMap_retain_declare(hm_name, key_t, val_t) \
+/** \
+ * Remove every entry that doesn't match a predicate, in one pass over the \
+ * buckets. \
+ * @param map The hash map. \
+ * @param pred A function that returns true for the entries to keep, it's \
+ * given the key, the value and `ctx`. \
+ * @param ctx A context to pass to the predicate. \
+ * @return The amount of entries that were removed. \
+*/ \
+size_t hm_name##_retain(hm_name *map, \
+  bool (*pred)(const key_t*, val_t*, void*), void *ctx);
+
 #define HashMap_clear_declare(hm_name) \
 /** \
  * Clears the map of all keys and values. \
@@ -145,9 +175,32 @@ void hm_name##_clear(hm_name *map);
  * present in the map. \
  * ERR_TOOBIG - The new size is too big for the hash map to resize. \
  * ERR_MEM - Memory allocation error. \
+ * @note The map can also shrink, the entries past the new capacity are moved \
+ * to empty entries below it, pointers to entries are invalidated. \
 */ \
 DS_codes_t hm_name##_resize(hm_name *map, size_t new_size);
 
+#define HashMap_shrink_to_fit_declare(hm_name) \
+/** \
+ * Shrink the map to the smallest capacity that fits it's entries, releasing \
+ * the memory of the rest. \
+ * @param map The hash map. \
+ * @return DS_SUCCESS on successful resizing, an error code on failure. \
+ * @note Errors: \
+ * ERR_MEM - Memory allocation error. \
+*/ \
+DS_codes_t hm_name##_shrink_to_fit(hm_name *map);
+
+#define HashMap_set_auto_shrink_declare(hm_name) \
+/** \
+ * Enable or disable shrinking the map automatically. When enabled, a removal \
+ * that leaves the map less than a quarter full shrinks it to half full, so \
+ * it has to double before it grows again. \
+ * @param map The hash map. \
+ * @param enable True to enable auto shrink, false to disable it. \
+*/ \
+void hm_name##_set_auto_shrink(hm_name *map, bool enable);
+
 #define HashMap_destroy_declare(hm_name) \
 /** \
  * Releases all the memory the hash map uses. \
@@ -164,6 +217,37 @@ void hm_name##_destroy(hm_name *map);
 */ \
 void hm_name##_free(hm_name *map); 
 
+#define HashMap_enable_filter_declare(hm_name) \
+/** \
+ * Put a bloom filter in front of the map, so most lookups of keys that are \
+ * not in the map are answered from one cache line, without reading the \
+ * buckets or the entries. The filter is kept up to date by put(), and \
+ * rebuilt by resize() and by remove() once enough keys were removed. \
+ * @param map The hash map. \
+ * @param bits_per_key The size of the filter in bits per entry of capacity, \
+ * 0 for BLOOM_DEFAULT_BITS_PER_KEY. More bits mean less false positives. \
+ * @return DS_SUCCESS on success, an error code on failure. \
+ * @note Errors: \
+ * ERR_MEM - Memory allocation error. \
+ * @note Worth it when most lookups miss, it makes every hit a little slower. \
+*/ \
+DS_codes_t hm_name##_enable_filter(hm_name *map, unsigned bits_per_key);
+
+#define HashMap_disable_filter_declare(hm_name) \
+/** \
+ * Remove the bloom filter from the front of the map, if it has one. \
+ * @param map The hash map. \
+*/ \
+void hm_name##_disable_filter(hm_name *map);
+
+#define HashMap_rebuild_filter_declare(hm_name) \
+/** \
+ * Rebuild the bloom filter from the keys in the map, dropping the bits of \
+ * removed keys. Does nothing if the map has no filter. \
+ * @param map The hash map. \
+*/ \
+void hm_name##_rebuild_filter(hm_name *map);
+
 /* ========================= DEFINITIONS ========================= */
 
 #define HashMap_entry_define(hm_name, key_t, val_t, hash_t) \
@@ -193,6 +277,10 @@ struct hm_name { \
   size_t next_empty; \
   /**The maximum capacity of the map.*/ \
   size_t cap; \
+  /**A bloom filter of the keys in front of the map, NULL if disabled.*/ \
+  BloomFilter *filter; \
+  /**Whether removals shrink the map when it's mostly empty.*/ \
+  bool auto_shrink; \
 };
 
 #define HashMap_hash_define(hm_name, key_t, hash_t, hash) \
@@ -220,13 +308,13 @@ hm_name * hm_name##_snew(size_t size) { \
 DS_codes_t hm_name##_init(hm_name *map, size_t size) { \
   size_t initial = nearest_prime(size); \
  \
-  map->buckets = malloc(initial*sizeof(size_t)); \
+  map->buckets = DS_MALLOC(initial*sizeof(size_t)); \
   if (map->buckets == NULL) return ERR_MEM; \
   for(size_t i = 0; i < initial; i++) map->buckets[i] = -1; \
  \
-  map->entries = malloc(initial*sizeof(hm_name##_entry_t)); \
+  map->entries = DS_MALLOC(initial*sizeof(hm_name##_entry_t)); \
   if (map->entries == NULL) { \
-    free(map->buckets); \
+    DS_FREE(map->buckets); \
     return ERR_MEM; \
   } \
   for(size_t i = 0; i < initial; i++) { \
@@ -236,6 +324,8 @@ DS_codes_t hm_name##_init(hm_name *map, size_t size) { \
   map->cap = initial; \
   map->size = 0; \
   map->next_empty = 0; \
+  map->filter = NULL; \
+  map->auto_shrink = false; \
  \
   return DS_SUCCESS; \
 }
@@ -269,6 +359,7 @@ DS_codes_t hm_name##_put(hm_name *map, const key_t *key, const val_t *value) { \
   }; \
   map->buckets[bucket] = empty; \
   memcpy(map->entries + empty, &new_entry, sizeof(hm_name##_entry_t)); \
+  if (map->filter != NULL) BloomFilter_add(map->filter, hash); \
  \
   /* Check if resize needed. */ \
   map->size++; \
@@ -284,6 +375,8 @@ DS_codes_t hm_name##_put(hm_name *map, const key_t *key, const val_t *value) { \
 bool hm_name##_has(const hm_name *map, const key_t *key) { \
   hash_t hash = hm_name##_hash(key); \
   size_t bucket = hash % map->cap; \
+  /* Most missing keys stop at the filter. */ \
+  if (hm_name##_filter_skips(map, hash)) return false; \
  \
   for (ssize_t i = map->buckets[bucket]; i != -1; i = map->entries[i].next) { \
     hm_name##_entry_t *entry = map->entries + i; \
@@ -300,6 +393,8 @@ bool hm_name##_has(const hm_name *map, const key_t *key) { \
 val_t * hm_name##_get(const hm_name *map, const key_t *key) { \
   hash_t hash = hm_name##_hash(key); \
   size_t bucket = hash % map->cap; \
+  /* Most missing keys stop at the filter. */ \
+  if (hm_name##_filter_skips(map, hash)) return NULL; \
  \
   for (ssize_t i = map->buckets[bucket]; i != -1; i = map->entries[i].next) { \
     hm_name##_entry_t *entry = map->entries + i; \
@@ -329,6 +424,11 @@ DS_codes_t hm_name##_remove(hm_name *map, const key_t *key) { \
       entry->next = map->next_empty; \
       map->next_empty = i; \
       map->size--; \
+      /* Removed keys stay in the filter, rebuild it once they're too many. */ \
+      if (map->filter != NULL && ++map->filter->stale > map->cap / 4) { \
+        hm_name##_rebuild_filter(map); \
+      } \
+      hm_name##_check_shrink(map); \
       return DS_SUCCESS; \
     } \
     prev = i; \
@@ -337,6 +437,50 @@ DS_codes_t hm_name##_remove(hm_name *map, const key_t *key) { \
   return ERR_KEYNOTFOUND; \
 }
 
+#define HashMap_remove_where_define(hm_name, key_t, val_t) \
+/**Remove every entry for which the predicate returns `remove`.*/ \
+static size_t hm_name##_remove_where(hm_name *map, \
+  bool (*pred)(const key_t*, val_t*, void*), void *ctx, bool remove) { \
+  size_t removed = 0; \
+  for (size_t b = 0; b < map->cap; b++) { \
+    /* The link that points at the current entry, the bucket or a next. */ \
+    ssize_t *link = &map->buckets[b]; \
+    while (*link != -1) { \
+      ssize_t i = *link; \
+      hm_name##_entry_t *entry = map->entries + i; \
+      if (pred(&entry->key, &entry->val, ctx) != remove) { \
+        link = &entry->next; \
+        continue; \
+      } \
+      /* Unlink entry and set it's index as the next empty slot. */ \
+      *link = entry->next; \
+      entry->next = map->next_empty; \
+      map->next_empty = i; \
+      removed++; \
+    } \
+  } \
+  map->size -= removed; \
+ \
+  if (map->filter != NULL) { \
+    map->filter->stale += removed; \
+    if (map->filter->stale > map->cap / 4) hm_name##_rebuild_filter(map); \
+  } \
+  hm_name##_check_shrink(map); \
+  return removed; \
+}
+
+#define HashMap_remove_if_define(hm_name, key_t, val_t) \
+size_t hm_name##_remove_if(hm_name *map, \
+  bool (*pred)(const key_t*, val_t*, void*), void *ctx) { \
+  return hm_name##_remove_where(map, pred, ctx, true); \
+}
+
+#define HashMap_retain_define(hm_name, key_t, val_t) \
+size_t hm_name##_retain(hm_name *map, \
+  bool (*pred)(const key_t*, val_t*, void*), void *ctx) { \
+  return hm_name##_remove_where(map, pred, ctx, false); \
+}
+
 #define HashMap_clear_define(hm_name) \
 void hm_name##_clear(hm_name *map) { \
   for (size_t i = 0; i < map->cap; i++) { \
@@ -345,25 +489,124 @@ void hm_name##_clear(hm_name *map) { \
   } \
   map->next_empty = 0; \
   map->size = 0; \
+  if (map->filter != NULL) BloomFilter_clear(map->filter); \
+}
+
+#define HashMap_filter_define(hm_name) \
+/**Check the filter of the map, true if the key of the hash is surely missing.*/ \
+static inline bool hm_name##_filter_skips(const hm_name *map, uint64_t hash) { \
+  return map->filter != NULL && !BloomFilter_may_contain(map->filter, hash); \
+} \
+/**Called after the capacity of the map changed, sizes the filter for it. If \
+ * the new filter can't be had the old one is kept, it's still correct.*/ \
+static inline void hm_name##_filter_resized(hm_name *map) { \
+  if (map->filter == NULL) return; \
+  BloomFilter *filter = BloomFilter_new(map->cap, map->filter->bits_per_key); \
+  if (filter == NULL) return; \
+  BloomFilter_free(map->filter); \
+  map->filter = filter; \
+  hm_name##_rebuild_filter(map); \
+} \
+/**Called when the map is destroyed.*/ \
+static inline void hm_name##_filter_destroy(hm_name *map) { \
+  if (map->filter != NULL) BloomFilter_free(map->filter); \
+}
+
+#define HashMap_no_filter_define(hm_name) \
+/**The filter hooks of maps without a filter, every lookup reads the table.*/ \
+static inline bool hm_name##_filter_skips(const hm_name *map, uint64_t hash) { \
+  (void)map; (void)hash; \
+  return false; \
+} \
+static inline void hm_name##_filter_resized(hm_name *map) { (void)map; } \
+static inline void hm_name##_filter_destroy(hm_name *map) { (void)map; }
+
+#define HashMap_relocate_define(hm_name) \
+/**Called when shrinking moves an entry to a different index, after it was \
+ * copied to it's new index. The plain hash map has nothing else to update.*/ \
+static inline void hm_name##_relocate(hm_name *map, ssize_t from, ssize_t to) { \
+  (void)map; (void)from; (void)to; \
+}
+
+#define HashMap_shrink_define(hm_name) \
+/**Resize the map to a smaller capacity, the entries at indices past the new \
+ * capacity are moved to empty entries below it.*/ \
+static DS_codes_t hm_name##_shrink(hm_name *map, size_t new_size) { \
+  ssize_t *new_buckets = DS_MALLOC(new_size * sizeof(ssize_t)); \
+  bool *used = calloc(map->cap, sizeof(bool)); \
+  if (new_buckets == NULL || used == NULL) { \
+    DS_FREE(new_buckets); \
+    free(used); \
+    return ERR_MEM; \
+  } \
+  for (size_t i = 0; i < new_size; i++) new_buckets[i] = -1; \
+  for (size_t b = 0; b < map->cap; b++) { \
+    for (ssize_t i = map->buckets[b]; i != -1; i = map->entries[i].next) used[i] = true; \
+  } \
+ \
+  /* Relink every entry to the new buckets, moving the entries past the new \
+   * capacity to the empty entries below it. */ \
+  size_t empty = 0; \
+  for (size_t b = 0; b < map->cap; b++) { \
+    while (map->buckets[b] != -1) { \
+      ssize_t entry_pos = map->buckets[b]; \
+      hm_name##_entry_t *entry = &map->entries[entry_pos]; \
+      map->buckets[b] = entry->next; \
+      if ((size_t)entry_pos >= new_size) { \
+        while (used[empty]) empty++; \
+        used[empty] = true; \
+        memcpy(map->entries + empty, entry, sizeof(hm_name##_entry_t)); \
+        hm_name##_relocate(map, entry_pos, empty); \
+        entry_pos = empty; \
+        entry = &map->entries[entry_pos]; \
+      } \
+      size_t bucket = entry->key_hash % new_size; \
+      entry->next = new_buckets[bucket]; \
+      new_buckets[bucket] = entry_pos; \
+    } \
+  } \
+ \
+  /* Chain the empty entries below the new capacity. */ \
+  ssize_t next_empty = new_size; \
+  for (size_t i = new_size; i-- > 0;) { \
+    if (used[i]) continue; \
+    map->entries[i].next = next_empty; \
+    next_empty = i; \
+  } \
+  map->next_empty = next_empty; \
+  free(used); \
+ \
+  /* If the smaller block can't be had, keep the bigger one. */ \
+  hm_name##_entry_t *tmp = DS_REALLOC(map->entries, new_size * sizeof(hm_name##_entry_t)); \
+  if (tmp != NULL) map->entries = tmp; \
+  DS_FREE(map->buckets); \
+  map->buckets = new_buckets; \
+  map->cap = new_size; \
+  hm_name##_filter_resized(map); \
+  return DS_SUCCESS; \
 }
 
 #define HashMap_resize_define(hm_name) \
 DS_codes_t hm_name##_resize(hm_name *map, size_t new_size) { \
   if (new_size < map->size) return ERR_TOOSMALL; \
  \
-  /* Find the next prime size. */ \
+  /* Find the next prime size, it has to leave room for the next put. */ \
   new_size = nearest_prime(new_size); \
+  if (new_size != PRIME_TOOBIG && new_size <= map->size) { \
+    new_size = nearest_prime(map->size + 1); \
+  } \
   if (new_size == PRIME_TOOBIG) return ERR_TOOBIG; \
+  if (new_size < map->cap) return hm_name##_shrink(map, new_size); \
   /* Resize entries. */ \
-  hm_name##_entry_t *tmp = realloc(map->entries, new_size * sizeof(hm_name##_entry_t)); \
+  hm_name##_entry_t *tmp = DS_REALLOC(map->entries, new_size * sizeof(hm_name##_entry_t)); \
   if (tmp == NULL) return ERR_MEM; \
   map->entries = tmp; \
   for (size_t i = map->cap; i < new_size; i++) map->entries[i].next = i + 1; \
  \
   /* Allocate new buckets. */ \
-  ssize_t *new_buckets = malloc(new_size * sizeof(ssize_t)); \
+  ssize_t *new_buckets = DS_MALLOC(new_size * sizeof(ssize_t)); \
   if (new_buckets == NULL) { \
-    free(new_buckets); \
+    DS_FREE(new_buckets); \
     return ERR_MEM; \
   } \
   for (size_t i = 0; i < new_size; i++) new_buckets[i] = -1; \
@@ -384,15 +627,38 @@ DS_codes_t hm_name##_resize(hm_name *map, size_t new_size) { \
   } \
  \
   map->cap = new_size; \
-  free(map->buckets); \
+  DS_FREE(map->buckets); \
   map->buckets = new_buckets; \
+  hm_name##_filter_resized(map); \
   return DS_SUCCESS; \
 }
 
+#define HashMap_check_shrink_define(hm_name) \
+/**Shrink the map to half full if auto shrink is on and it's mostly empty.*/ \
+static void hm_name##_check_shrink(hm_name *map) { \
+  if (map->auto_shrink && map->cap > MIN_PRIME && \
+    map->size < map->cap / 4 * HASHMAP_SHRINK_LOAD) { \
+    /* On failure the map just stays bigger. */ \
+    hm_name##_resize(map, map->size * 2); \
+  } \
+}
+
+#define HashMap_shrink_to_fit_define(hm_name) \
+DS_codes_t hm_name##_shrink_to_fit(hm_name *map) { \
+  return hm_name##_resize(map, map->size + 1); \
+}
+
+#define HashMap_set_auto_shrink_define(hm_name) \
+void hm_name##_set_auto_shrink(hm_name *map, bool enable) { \
+  map->auto_shrink = enable; \
+  if (enable) hm_name##_check_shrink(map); \
+}
+
 #define HashMap_destroy_define(hm_name) \
 void hm_name##_destroy(hm_name *map) { \
-  if (map->buckets != NULL) free(map->buckets); \
-  if (map->entries != NULL) free(map->entries); \
+  if (map->buckets != NULL) DS_FREE(map->buckets); \
+  if (map->entries != NULL) DS_FREE(map->entries); \
+  hm_name##_filter_destroy(map); \
 }
 
 #define HashMap_free_define(hm_name) \
@@ -401,6 +667,33 @@ void hm_name##_free(hm_name *map) { \
   if (map != NULL) free(map); \
 }
 
+#define HashMap_enable_filter_define(hm_name) \
+DS_codes_t hm_name##_enable_filter(hm_name *map, unsigned bits_per_key) { \
+  BloomFilter *filter = BloomFilter_new(map->cap, bits_per_key); \
+  if (filter == NULL) return ERR_MEM; \
+  if (map->filter != NULL) BloomFilter_free(map->filter); \
+  map->filter = filter; \
+  hm_name##_rebuild_filter(map); \
+  return DS_SUCCESS; \
+}
+
+#define HashMap_disable_filter_define(hm_name) \
+void hm_name##_disable_filter(hm_name *map) { \
+  if (map->filter != NULL) BloomFilter_free(map->filter); \
+  map->filter = NULL; \
+}
+
+#define HashMap_rebuild_filter_define(hm_name) \
+void hm_name##_rebuild_filter(hm_name *map) { \
+  if (map->filter == NULL) return; \
+  BloomFilter_clear(map->filter); \
+  for (size_t b = 0; b < map->cap; b++) { \
+    for (ssize_t i = map->buckets[b]; i != -1; i = map->entries[i].next) { \
+      BloomFilter_add(map->filter, map->entries[i].key_hash); \
+    } \
+  } \
+}
+
 /* ========================= ALL ========================= */
 
 /**
@@ -425,10 +718,17 @@ HashMap_put_declare(hm_name, key_t, val_t) \
 HashMap_has_declare(hm_name, key_t) \
 HashMap_get_declare(hm_name, key_t, val_t) \
 HashMap_remove_declare(hm_name, key_t) \
+HashMap_remove_if_declare(hm_name, key_t, val_t) \
+HashMap_retain_declare(hm_name, key_t, val_t) \
 HashMap_clear_declare(hm_name) \
 HashMap_resize_declare(hm_name) \
+HashMap_shrink_to_fit_declare(hm_name) \
+HashMap_set_auto_shrink_declare(hm_name) \
 HashMap_destroy_declare(hm_name) \
-HashMap_free_declare(hm_name)
+HashMap_free_declare(hm_name) \
+HashMap_enable_filter_declare(hm_name) \
+HashMap_disable_filter_declare(hm_name) \
+HashMap_rebuild_filter_declare(hm_name)
 
 /**
  * Generate the definitions for the hash map data structure for a given
@@ -450,14 +750,26 @@ HashMap_keycmp_define(hm_name, key_t, keycmp) \
 HashMap_new_define(hm_name) \
 HashMap_snew_define(hm_name) \
 HashMap_init_define(hm_name) \
+HashMap_filter_define(hm_name) \
+HashMap_check_shrink_define(hm_name) \
 HashMap_put_define(hm_name, key_t, val_t, hash_t) \
 HashMap_has_define(hm_name, key_t, hash_t) \
 HashMap_get_define(hm_name, key_t, val_t, hash_t) \
 HashMap_remove_define(hm_name, key_t, hash_t) \
+HashMap_remove_where_define(hm_name, key_t, val_t) \
+HashMap_remove_if_define(hm_name, key_t, val_t) \
+HashMap_retain_define(hm_name, key_t, val_t) \
 HashMap_clear_define(hm_name) \
+HashMap_relocate_define(hm_name) \
+HashMap_shrink_define(hm_name) \
 HashMap_resize_define(hm_name) \
+HashMap_shrink_to_fit_define(hm_name) \
+HashMap_set_auto_shrink_define(hm_name) \
 HashMap_destroy_define(hm_name) \
-HashMap_free_define(hm_name)
+HashMap_free_define(hm_name) \
+HashMap_enable_filter_define(hm_name) \
+HashMap_disable_filter_define(hm_name) \
+HashMap_rebuild_filter_define(hm_name)
 
 /**
  * Generate a full hash map data structure implementation for a given
@@ -0,0 +1,235 @@
+#ifndef __HASH_MAP_BUILD_H__
+#define __HASH_MAP_BUILD_H__
+
+/**
+ * @file hashmap_build.h
+ * @brief Build a hash map from hashmap.h out of arrays of keys and values in
+ * one go, on many threads. The map is sized once for all the keys, the keys
+ * are hashed in parallel, partitioned by bucket range so every thread owns a
+ * range of buckets, and every thread links the chains of it's own range
+ * without any locks.
+*/
+
+#include<stdint.h>
+#include "hashmap.h"
+#include "parallel.h"
+
+/**Below this amount of keys a map is built on a single thread.*/
+#define HASHMAP_BUILD_MIN_PARALLEL 16384
+
+/* ========================= DECLARATIONS ========================= */
+
+#define HashMap_from_arrays_declare(hm_name, key_t, val_t) \
+/** \
+ * Allocates a new hash map that holds the keys and values from two arrays, \
+ * as if every pair was put in order, a key that appears more than once is \
+ * mapped to it's last value. \
+ * @param keys The keys, an array of `n` keys. \
+ * @param vals The values, an array of `n` values, `vals[i]` is mapped to \
+ * `keys[i]`. \
+ * @param n The amount of pairs. \
+ * @param nthreads The amount of threads to build with, 0 for one per \
+ * processor. \
+ * @return A pointer to the new hash map. NULL on failure. \
+ * @note Returns NULL on failed memory allocation, or if `n` is too big for \
+ * a hash map. \
+ * @note The hash and keycmp functions are called from many threads at once. \
+*/ \
+hm_name * hm_name##_from_arrays(const key_t *keys, const val_t *vals, size_t n, \
+  size_t nthreads);
+
+/* ========================= DEFINITIONS ========================= */
+
+#define HashMap_from_arrays_define(hm_name, key_t, val_t, hash_t) \
+/**The state shared by the threads that build a map from arrays.*/ \
+typedef struct hm_name##_build_t { \
+  const key_t *keys; \
+  const val_t *vals; \
+  size_t n; \
+  hm_name *map; \
+  /**The hash of every key.*/ \
+  hash_t *hashes; \
+  /**The indices of the keys, ordered by partition.*/ \
+  size_t *order; \
+  /**Per thread and partition, the amount of keys and then where to put \
+   * them in the order.*/ \
+  size_t *offsets; \
+  /**Where every partition starts in the order, and where the last ends.*/ \
+  size_t *starts; \
+  /**Per partition, the amount of entries and the first and last entries \
+   * that were left empty by duplicate keys.*/ \
+  size_t *sizes; \
+  ssize_t *first_hole, *last_hole; \
+} hm_name##_build_t; \
+ \
+/**Get the partition of a bucket, partitions are even ranges of buckets.*/ \
+static inline size_t hm_name##_build_partition(size_t bucket, size_t cap, \
+  size_t nparts) { \
+  return (uint64_t)bucket * nparts / cap; \
+} \
+ \
+/**Hash a chunk of the keys, and count them per partition.*/ \
+static void hm_name##_build_hash(size_t thread, size_t nthreads, void *context) { \
+  hm_name##_build_t *build = context; \
+  size_t cap = build->map->cap; \
+  size_t *counts = build->offsets + thread * nthreads; \
+  size_t end = build->n * (thread + 1) / nthreads; \
+  for (size_t i = build->n * thread / nthreads; i < end; i++) { \
+    hash_t hash = hm_name##_hash(build->keys + i); \
+    build->hashes[i] = hash; \
+    counts[hm_name##_build_partition(hash % cap, cap, nthreads)]++; \
+  } \
+} \
+ \
+/**Scatter a chunk of the keys to their partitions, keeping their order.*/ \
+static void hm_name##_build_scatter(size_t thread, size_t nthreads, void *context) { \
+  hm_name##_build_t *build = context; \
+  size_t cap = build->map->cap; \
+  size_t *offsets = build->offsets + thread * nthreads; \
+  size_t end = build->n * (thread + 1) / nthreads; \
+  for (size_t i = build->n * thread / nthreads; i < end; i++) { \
+    size_t part = hm_name##_build_partition(build->hashes[i] % cap, cap, nthreads); \
+    build->order[offsets[part]++] = i; \
+  } \
+} \
+ \
+/**Link the chains of the buckets of one partition, the keys of the \
+ * partition go to the entries at their positions in the order.*/ \
+static void hm_name##_build_link(size_t thread, size_t nthreads, void *context) { \
+  hm_name##_build_t *build = context; \
+  hm_name *map = build->map; \
+  size_t cap = map->cap; \
+  size_t first_bucket = ((uint64_t)thread * cap + nthreads - 1) / nthreads; \
+  size_t end_bucket = ((uint64_t)(thread + 1) * cap + nthreads - 1) / nthreads; \
+  for (size_t b = first_bucket; b < end_bucket; b++) map->buckets[b] = -1; \
+ \
+  size_t size = 0; \
+  ssize_t first_hole = -1, last_hole = -1; \
+  for (size_t k = build->starts[thread]; k < build->starts[thread + 1]; k++) { \
+    size_t i = build->order[k]; \
+    hash_t hash = build->hashes[i]; \
+    size_t bucket = hash % cap; \
+ \
+    /* A key that is already in the chain gets the later value. */ \
+    ssize_t found = map->buckets[bucket]; \
+    while (found != -1 && !(map->entries[found].key_hash == hash && \
+      hm_name##_keycmp(build->keys + i, &map->entries[found].key))) { \
+      found = map->entries[found].next; \
+    } \
+    if (found != -1) { \
+      map->entries[found].val = build->vals[i]; \
+      if (last_hole == -1) first_hole = k; \
+      else map->entries[last_hole].next = k; \
+      last_hole = k; \
+      continue; \
+    } \
+ \
+    hm_name##_entry_t new_entry = { \
+      .key = build->keys[i], \
+      .key_hash = hash, \
+      .next = map->buckets[bucket], \
+      .val = build->vals[i] \
+    }; \
+    memcpy(map->entries + k, &new_entry, sizeof(hm_name##_entry_t)); \
+    map->buckets[bucket] = k; \
+    size++; \
+  } \
+  build->sizes[thread] = size; \
+  build->first_hole[thread] = first_hole; \
+  build->last_hole[thread] = last_hole; \
+} \
+ \
+hm_name * hm_name##_from_arrays(const key_t *keys, const val_t *vals, size_t n, \
+  size_t nthreads) { \
+  if (n >= MAX_PRIME) return NULL; \
+  size_t cap = nearest_prime(n + 1); \
+  nthreads = n < HASHMAP_BUILD_MIN_PARALLEL ? 1 : ds_parallel_threads(nthreads); \
+ \
+  hm_name *map = malloc(sizeof(hm_name)); \
+  hm_name##_build_t build = { \
+    .keys = keys, .vals = vals, .n = n, .map = map, \
+    .hashes = malloc(n * sizeof(hash_t) + 1), \
+    .order = malloc(n * sizeof(size_t) + 1), \
+    .offsets = calloc(nthreads * nthreads, sizeof(size_t)), \
+    .starts = malloc((nthreads + 1) * sizeof(size_t)), \
+    .sizes = malloc(nthreads * sizeof(size_t)), \
+    .first_hole = malloc(nthreads * sizeof(ssize_t)), \
+    .last_hole = malloc(nthreads * sizeof(ssize_t)) \
+  }; \
+  if (map != NULL) { \
+    map->buckets = DS_MALLOC(cap * sizeof(ssize_t)); \
+    map->entries = DS_MALLOC(cap * sizeof(hm_name##_entry_t)); \
+  } \
+  if (map == NULL || map->buckets == NULL || map->entries == NULL || \
+    build.hashes == NULL || build.order == NULL || build.offsets == NULL || \
+    build.starts == NULL || build.sizes == NULL || build.first_hole == NULL || \
+    build.last_hole == NULL) { \
+    if (map != NULL) { \
+      DS_FREE(map->buckets); \
+      DS_FREE(map->entries); \
+      free(map); \
+    } \
+    map = NULL; \
+    goto cleanup; \
+  } \
+  map->cap = cap; \
+  map->filter = NULL; \
+  map->auto_shrink = false; \
+ \
+  ds_parallel_run(nthreads, hm_name##_build_hash, &build); \
+  /* Turn the counts to offsets, partition by partition, and in every \
+   * partition thread by thread, so the keys keep their order. */ \
+  size_t offset = 0; \
+  for (size_t part = 0; part < nthreads; part++) { \
+    build.starts[part] = offset; \
+    for (size_t thread = 0; thread < nthreads; thread++) { \
+      size_t count = build.offsets[thread * nthreads + part]; \
+      build.offsets[thread * nthreads + part] = offset; \
+      offset += count; \
+    } \
+  } \
+  build.starts[nthreads] = offset; \
+  ds_parallel_run(nthreads, hm_name##_build_scatter, &build); \
+  ds_parallel_run(nthreads, hm_name##_build_link, &build); \
+ \
+  /* Chain the entries left empty by duplicates and the unused ones to the \
+   * list of empty entries. */ \
+  for (size_t i = n; i < cap; i++) map->entries[i].next = i + 1; \
+  map->size = 0; \
+  map->next_empty = n; \
+  ssize_t *tail = NULL; \
+  for (size_t part = 0; part < nthreads; part++) { \
+    map->size += build.sizes[part]; \
+    if (build.first_hole[part] == -1) continue; \
+    if (tail == NULL) map->next_empty = build.first_hole[part]; \
+    else *tail = build.first_hole[part]; \
+    tail = &map->entries[build.last_hole[part]].next; \
+  } \
+  if (tail != NULL) *tail = n; \
+ \
+cleanup: \
+  free(build.hashes); \
+  free(build.order); \
+  free(build.offsets); \
+  free(build.starts); \
+  free(build.sizes); \
+  free(build.first_hole); \
+  free(build.last_hole); \
+  return map; \
+}
+
+/* ========================= ALL ========================= */
+
+/**
+ * Generate hm_name##_from_arrays() for an already generated hash map.
+ * @param hm_name The name of the hash map, as given to HashMap.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @param hash_t The data type of the hash.
+ * @note Must come after the HashMap macro of the same map.
+*/
+#define HashMap_from_arrays(hm_name, key_t, val_t, hash_t) \
+HashMap_from_arrays_declare(hm_name, key_t, val_t) \
+HashMap_from_arrays_define(hm_name, key_t, val_t, hash_t)
+
+#endif
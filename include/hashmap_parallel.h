@@ -0,0 +1,159 @@
+#ifndef __HASH_MAP_PARALLEL_H__
+#define __HASH_MAP_PARALLEL_H__
+
+/**
+ * @file hashmap_parallel.h
+ * @brief Iterate over a hash map from hashmap.h, and reduce it's entries to a
+ * single result, on many threads. The buckets are split to even ranges, one
+ * per thread, every thread walks the chains of it's own range, and a reduce
+ * gives every thread it's own accumulator, so the threads share nothing
+ * until their accumulators are combined.
+*/
+
+#include<stdint.h>
+#include "hashmap.h"
+#include "parallel.h"
+
+/**Below this amount of buckets a map is iterated on a single thread.*/
+#define HASHMAP_PARALLEL_MIN_BUCKETS 16384
+/**The alignment of the accumulators of a reduce, a cache line, so the
+ * threads don't write to the same lines.*/
+#define HASHMAP_PARALLEL_ALIGN 64
+
+/* ========================= DECLARATIONS ========================= */
+
+#define HashMap_parallel_for_each_declare(hm_name, key_t, val_t) \
+/** \
+ * Call a function for every entry of the map, on many threads. \
+ * @param map The hash map. \
+ * @param nthreads The amount of threads to use, 0 for one per processor. \
+ * @param func The function, it's given the key, the value and `ctx`. \
+ * @param ctx A context to pass to the function. \
+ * @note The function is called from many threads at once, in no particular \
+ * order. It may change the value it's given, but not the map. \
+*/ \
+void hm_name##_parallel_for_each(hm_name *map, size_t nthreads, \
+  void (*func)(const key_t*, val_t*, void*), void *ctx);
+
+#define HashMap_parallel_reduce_declare(hm_name, key_t, val_t) \
+/** \
+ * Reduce the entries of the map to a single result, on many threads. Every \
+ * thread gets an accumulator of `acc_size` bytes, initializes it with \
+ * `init`, adds it's entries to it with `add`, and then the accumulators are \
+ * combined into `result` with `combine`, in the order of the threads. \
+ * @param map The hash map. \
+ * @param nthreads The amount of threads to use, 0 for one per processor. \
+ * @param result The result, combined with every accumulator. \
+ * @param acc_size The size of an accumulator in bytes. \
+ * @param init Initializes an accumulator, given it and `ctx`. \
+ * @param add Adds an entry to an accumulator, given it, the key, the value \
+ * and `ctx`. \
+ * @param combine Combines an accumulator into the result, given the result, \
+ * the accumulator and `ctx`. \
+ * @param ctx A context to pass to the functions. \
+ * @return DS_SUCCESS on success, an error code otherwise. \
+ * @note Errors:  \
+ * ERR_MEM - Failed to allocate the accumulators, `result` is unchanged. \
+ * @note `init` and `add` are called from many threads at once, `combine` is \
+ * called from the calling thread only. \
+*/ \
+DS_codes_t hm_name##_parallel_reduce(const hm_name *map, size_t nthreads, \
+  void *result, size_t acc_size, void (*init)(void*, void*), \
+  void (*add)(void*, const key_t*, const val_t*, void*), \
+  void (*combine)(void*, const void*, void*), void *ctx);
+
+/* ========================= DEFINITIONS ========================= */
+
+#define HashMap_parallel_state_define(hm_name, key_t, val_t, state_t) \
+/**The state shared by the threads that iterate over a map.*/ \
+typedef struct state_t { \
+  const hm_name *map; \
+  void (*func)(const key_t*, val_t*, void*); \
+  void (*add)(void*, const key_t*, const val_t*, void*); \
+  void (*init)(void*, void*); \
+  void *ctx; \
+  /**The accumulators of a reduce, one every `acc_stride` bytes.*/ \
+  char *accs; \
+  size_t acc_stride; \
+} state_t;
+
+#define HashMap_parallel_for_each_define(hm_name, key_t, val_t) \
+HashMap_parallel_state_define(hm_name, key_t, val_t, hm_name##_parallel_for_each_t) \
+ \
+/**Call the function for the entries of one range of buckets.*/ \
+static void hm_name##_parallel_for_each_task(size_t thread, size_t nthreads, \
+  void *context) { \
+  hm_name##_parallel_for_each_t *par = context; \
+  const hm_name *map = par->map; \
+  size_t end = (uint64_t)map->cap * (thread + 1) / nthreads; \
+  for (size_t b = (uint64_t)map->cap * thread / nthreads; b < end; b++) { \
+    for (ssize_t i = map->buckets[b]; i != -1; i = map->entries[i].next) { \
+      par->func(&map->entries[i].key, &map->entries[i].val, par->ctx); \
+    } \
+  } \
+} \
+ \
+void hm_name##_parallel_for_each(hm_name *map, size_t nthreads, \
+  void (*func)(const key_t*, val_t*, void*), void *ctx) { \
+  nthreads = map->cap < HASHMAP_PARALLEL_MIN_BUCKETS ? 1 : ds_parallel_threads(nthreads); \
+  hm_name##_parallel_for_each_t par = { .map = map, .func = func, .ctx = ctx }; \
+  ds_parallel_run(nthreads, hm_name##_parallel_for_each_task, &par); \
+}
+
+#define HashMap_parallel_reduce_define(hm_name, key_t, val_t) \
+HashMap_parallel_state_define(hm_name, key_t, val_t, hm_name##_parallel_reduce_t) \
+ \
+/**Reduce the entries of one range of buckets to the thread's accumulator.*/ \
+static void hm_name##_parallel_reduce_task(size_t thread, size_t nthreads, \
+  void *context) { \
+  hm_name##_parallel_reduce_t *par = context; \
+  const hm_name *map = par->map; \
+  void *acc = par->accs + thread * par->acc_stride; \
+  par->init(acc, par->ctx); \
+  size_t end = (uint64_t)map->cap * (thread + 1) / nthreads; \
+  for (size_t b = (uint64_t)map->cap * thread / nthreads; b < end; b++) { \
+    for (ssize_t i = map->buckets[b]; i != -1; i = map->entries[i].next) { \
+      par->add(acc, &map->entries[i].key, &map->entries[i].val, par->ctx); \
+    } \
+  } \
+} \
+ \
+DS_codes_t hm_name##_parallel_reduce(const hm_name *map, size_t nthreads, \
+  void *result, size_t acc_size, void (*init)(void*, void*), \
+  void (*add)(void*, const key_t*, const val_t*, void*), \
+  void (*combine)(void*, const void*, void*), void *ctx) { \
+  nthreads = map->cap < HASHMAP_PARALLEL_MIN_BUCKETS ? 1 : ds_parallel_threads(nthreads); \
+  size_t stride = (acc_size + HASHMAP_PARALLEL_ALIGN - 1) / HASHMAP_PARALLEL_ALIGN * \
+    HASHMAP_PARALLEL_ALIGN; \
+  if (stride == 0) stride = HASHMAP_PARALLEL_ALIGN; \
+  hm_name##_parallel_reduce_t par = { \
+    .map = map, .add = add, .init = init, .ctx = ctx, \
+    .accs = aligned_alloc(HASHMAP_PARALLEL_ALIGN, nthreads * stride), \
+    .acc_stride = stride \
+  }; \
+  if (par.accs == NULL) return ERR_MEM; \
+  ds_parallel_run(nthreads, hm_name##_parallel_reduce_task, &par); \
+  for (size_t thread = 0; thread < nthreads; thread++) { \
+    combine(result, par.accs + thread * stride, ctx); \
+  } \
+  free(par.accs); \
+  return DS_SUCCESS; \
+}
+
+/* ========================= ALL ========================= */
+
+/**
+ * Generate hm_name##_parallel_for_each() and hm_name##_parallel_reduce() for
+ * an already generated hash map.
+ * @param hm_name The name of the hash map, as given to HashMap.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @note Must come after the HashMap macro of the same map.
+*/
+#define HashMap_parallel(hm_name, key_t, val_t) \
+HashMap_parallel_for_each_declare(hm_name, key_t, val_t) \
+HashMap_parallel_reduce_declare(hm_name, key_t, val_t) \
+HashMap_parallel_for_each_define(hm_name, key_t, val_t) \
+HashMap_parallel_reduce_define(hm_name, key_t, val_t)
+
+#endif
@@ -0,0 +1,268 @@
+#ifndef __HASH_MAP_SNAPSHOT_H__
+#define __HASH_MAP_SNAPSHOT_H__
+
+/**
+ * @file hashmap_snapshot.h
+ * @brief Save a hash map from hashmap.h to a binary file, and map such a file
+ * back into memory. The file holds the map's arrays exactly as they are in
+ * memory, so a mapped map answers get() straight from the file's pages, with
+ * no parsing and no copying, and processes that map the same file share it's
+ * pages.
+ *
+ * The layout of the file:
+ * - A HashMap_snapshot_header_t, padded to HASHMAP_SNAPSHOT_ALIGN bytes.
+ * - The buckets array, `cap` ssize_t's, padded to HASHMAP_SNAPSHOT_ALIGN.
+ * - The entries array, `cap` entries.
+ *
+ * Only for maps whose keys and values are plain data, with no pointers, and
+ * only between programs built for the same platform, the header records the
+ * sizes of the types and the files of other layouts are rejected.
+*/
+
+#include<stdint.h>
+#include<stddef.h>
+#include<errno.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include "hashmap.h"
+
+/**The magic bytes at the start of a snapshot file.*/
+#define HASHMAP_SNAPSHOT_MAGIC "DSHMAP\r\n"
+/**The version of the snapshot format.*/
+#define HASHMAP_SNAPSHOT_VERSION 1
+/**The alignment of each part of the file, a cache line.*/
+#define HASHMAP_SNAPSHOT_ALIGN 64
+/**The amount of entries that are written to the file at a time.*/
+#define HASHMAP_SNAPSHOT_CHUNK 1024
+/**Round a size up to the alignment of the parts of the file.*/
+#define hashmap_snapshot_align(size) \
+  (((size) + HASHMAP_SNAPSHOT_ALIGN - 1) / HASHMAP_SNAPSHOT_ALIGN * HASHMAP_SNAPSHOT_ALIGN)
+
+/**The header of a snapshot file.*/
+typedef struct HashMap_snapshot_header_t {
+  /**HASHMAP_SNAPSHOT_MAGIC, without the null terminator.*/
+  char magic[8];
+  /**HASHMAP_SNAPSHOT_VERSION.*/
+  uint32_t version;
+  /**The size of a ssize_t, the type of the buckets.*/
+  uint32_t index_size;
+  /**The sizes of the key, the value and the entry types.*/
+  uint64_t key_size, val_size, entry_size;
+  /**The capacity, size and next empty entry of the map.*/
+  uint64_t cap, size, next_empty;
+  /**The offsets of the buckets and entries arrays from the start of the file.*/
+  uint64_t buckets_offset, entries_offset;
+  /**The size of the whole file.*/
+  uint64_t file_size;
+} HashMap_snapshot_header_t;
+
+/**
+ * Write a whole buffer to a file descriptor.
+ * @return DS_SUCCESS on success, ERR_IO on failure.
+*/
+static inline DS_codes_t hashmap_snapshot_write(int fd, const void *buffer,
+  size_t size) {
+  const char *bytes = buffer;
+  while (size > 0) {
+    ssize_t written = write(fd, bytes, size);
+    if (written < 0 && errno == EINTR) continue;
+    if (written <= 0) return ERR_IO;
+    bytes += written;
+    size -= written;
+  }
+  return DS_SUCCESS;
+}
+
+/* ========================= DECLARATIONS ========================= */
+
+#define HashMap_save_declare(hm_name) \
+/** \
+ * Write a snapshot of the map to a file, from the current position. \
+ * @param map The hash map. \
+ * @param fd A file descriptor open for writing. \
+ * @return DS_SUCCESS on success, an error code on failure. \
+ * @note Errors: \
+ * ERR_IO - Failed to write to the file. \
+ * ERR_MEM - Failed to allocate the buffer of the entries. \
+ * @note Only the fields of the entries in the map are written, the empty \
+ * entries and the padding between fields are zeros, so a map saves to the \
+ * same bytes every time. \
+*/ \
+DS_codes_t hm_name##_save(const hm_name *map, int fd);
+
+#define HashMap_map_file_declare(hm_name) \
+/** \
+ * Map a snapshot file into memory, the map reads it's entries and buckets \
+ * directly from the file's pages. \
+ * @param path The path of the snapshot file. \
+ * @return A pointer to the mapped hash map, NULL on failure. \
+ * @note Returns NULL if the file can't be opened or mapped, or if it is not \
+ * a snapshot of a map with the same key and value types. \
+ * @note The mapped map is read only, get() and has() can be used, but not \
+ * put(), remove() or resize(). Values written through get() are private to \
+ * the process. Release it with unmap(), not with free() or destroy(). \
+*/ \
+const hm_name * hm_name##_map_file(const char *path);
+
+#define HashMap_unmap_declare(hm_name) \
+/** \
+ * Release a map that was returned by map_file(). \
+ * @param map The mapped hash map. \
+*/ \
+void hm_name##_unmap(const hm_name *map);
+
+/* ========================= DEFINITIONS ========================= */
+
+#define HashMap_save_define(hm_name, key_t, val_t) \
+DS_codes_t hm_name##_save(const hm_name *map, int fd) { \
+  static const char padding[HASHMAP_SNAPSHOT_ALIGN] = {0}; \
+  HashMap_snapshot_header_t header = { \
+    .magic = HASHMAP_SNAPSHOT_MAGIC, \
+    .version = HASHMAP_SNAPSHOT_VERSION, \
+    .index_size = sizeof(ssize_t), \
+    .key_size = sizeof(key_t), \
+    .val_size = sizeof(val_t), \
+    .entry_size = sizeof(hm_name##_entry_t), \
+    .cap = map->cap, \
+    .size = map->size, \
+    .next_empty = map->next_empty \
+  }; \
+  size_t buckets_size = map->cap * sizeof(ssize_t); \
+  size_t entries_size = map->cap * sizeof(hm_name##_entry_t); \
+  header.buckets_offset = hashmap_snapshot_align(sizeof(header)); \
+  header.entries_offset = header.buckets_offset + hashmap_snapshot_align(buckets_size); \
+  header.file_size = header.entries_offset + entries_size; \
+ \
+  /* The entries in the map, the rest are on the empty list. */ \
+  bool *used = calloc(map->cap, sizeof(bool)); \
+  char *chunk = malloc(HASHMAP_SNAPSHOT_CHUNK * sizeof(hm_name##_entry_t)); \
+  if (used == NULL || chunk == NULL) { \
+    free(used); \
+    free(chunk); \
+    return ERR_MEM; \
+  } \
+  for (size_t b = 0; b < map->cap; b++) { \
+    for (ssize_t i = map->buckets[b]; i != -1; i = map->entries[i].next) used[i] = true; \
+  } \
+ \
+  DS_codes_t res = DS_SUCCESS; \
+  if (hashmap_snapshot_write(fd, &header, sizeof(header)) != DS_SUCCESS || \
+    hashmap_snapshot_write(fd, padding, header.buckets_offset - sizeof(header)) != DS_SUCCESS || \
+    hashmap_snapshot_write(fd, map->buckets, buckets_size) != DS_SUCCESS || \
+    hashmap_snapshot_write(fd, padding, header.entries_offset - header.buckets_offset - \
+      buckets_size) != DS_SUCCESS) { \
+    res = ERR_IO; \
+  } \
+  /* Copy the entries field by field to zeroed chunks, so no uninitialized \
+   * bytes of empty entries or of padding reach the file. */ \
+  for (size_t start = 0; res == DS_SUCCESS && start < map->cap; start += HASHMAP_SNAPSHOT_CHUNK) { \
+    size_t count = map->cap - start < HASHMAP_SNAPSHOT_CHUNK ? map->cap - start : HASHMAP_SNAPSHOT_CHUNK; \
+    memset(chunk, 0, count * sizeof(hm_name##_entry_t)); \
+    for (size_t j = 0; j < count; j++) { \
+      const hm_name##_entry_t *entry = map->entries + start + j; \
+      char *out = chunk + j * sizeof(hm_name##_entry_t); \
+      memcpy(out + offsetof(hm_name##_entry_t, next), &entry->next, sizeof(entry->next)); \
+      if (!used[start + j]) continue; \
+      memcpy(out + offsetof(hm_name##_entry_t, key), &entry->key, sizeof(entry->key)); \
+      memcpy(out + offsetof(hm_name##_entry_t, key_hash), &entry->key_hash, sizeof(entry->key_hash)); \
+      memcpy(out + offsetof(hm_name##_entry_t, val), &entry->val, sizeof(entry->val)); \
+    } \
+    if (hashmap_snapshot_write(fd, chunk, count * sizeof(hm_name##_entry_t)) != DS_SUCCESS) res = ERR_IO; \
+  } \
+  free(used); \
+  free(chunk); \
+  return res; \
+}
+
+#define HashMap_map_file_define(hm_name, key_t, val_t) \
+const hm_name * hm_name##_map_file(const char *path) { \
+  int fd = open(path, O_RDONLY); \
+  if (fd < 0) return NULL; \
+  struct stat st; \
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(HashMap_snapshot_header_t)) { \
+    close(fd); \
+    return NULL; \
+  } \
+  /* Private mapping, the pages are shared until a process writes to them. */ \
+  char *base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0); \
+  close(fd); \
+  if (base == MAP_FAILED) return NULL; \
+ \
+  const HashMap_snapshot_header_t *header = (const HashMap_snapshot_header_t*)base; \
+  if (memcmp(header->magic, HASHMAP_SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 || \
+    header->version != HASHMAP_SNAPSHOT_VERSION || \
+    header->index_size != sizeof(ssize_t) || \
+    header->key_size != sizeof(key_t) || header->val_size != sizeof(val_t) || \
+    header->entry_size != sizeof(hm_name##_entry_t) || \
+    header->file_size != (uint64_t)st.st_size || header->cap == 0 || \
+    header->buckets_offset != hashmap_snapshot_align(sizeof(*header)) || \
+    header->entries_offset < header->buckets_offset + header->cap * sizeof(ssize_t) || \
+    header->entries_offset + header->cap * sizeof(hm_name##_entry_t) != header->file_size) { \
+    munmap(base, st.st_size); \
+    return NULL; \
+  } \
+ \
+  hm_name *map = malloc(sizeof(hm_name)); \
+  if (map == NULL) { \
+    munmap(base, st.st_size); \
+    return NULL; \
+  } \
+  map->buckets = (ssize_t*)(base + header->buckets_offset); \
+  map->entries = (hm_name##_entry_t*)(base + header->entries_offset); \
+  map->cap = header->cap; \
+  map->size = header->size; \
+  map->next_empty = header->next_empty; \
+  map->filter = NULL; \
+  map->auto_shrink = false; \
+  return map; \
+}
+
+#define HashMap_unmap_define(hm_name) \
+void hm_name##_unmap(const hm_name *map) { \
+  if (map == NULL) return; \
+  char *base = (char*)map->buckets - hashmap_snapshot_align(sizeof(HashMap_snapshot_header_t)); \
+  munmap(base, ((const HashMap_snapshot_header_t*)base)->file_size); \
+  free((void*)map); \
+}
+
+/* ========================= ALL ========================= */
+
+/**
+ * Generate the declarations for saving and mapping snapshots of a hash map.
+ * @param hm_name The name of the hash map, as given to HashMap.
+ * @note It's best to put this macro in a header file.
+*/
+#define HashMap_snapshot_declare(hm_name) \
+HashMap_save_declare(hm_name) \
+HashMap_map_file_declare(hm_name) \
+HashMap_unmap_declare(hm_name)
+
+/**
+ * Generate the definitions for saving and mapping snapshots of a hash map.
+ * @param hm_name The name of the hash map, as given to HashMap.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @note It's best to put this macro in a code file.
+*/
+#define HashMap_snapshot_define(hm_name, key_t, val_t) \
+HashMap_save_define(hm_name, key_t, val_t) \
+HashMap_map_file_define(hm_name, key_t, val_t) \
+HashMap_unmap_define(hm_name)
+
+/**
+ * Generate hm_name##_save(), hm_name##_map_file() and hm_name##_unmap() for
+ * an already generated hash map.
+ * @param hm_name The name of the hash map, as given to HashMap.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @note Must come after the HashMap macro of the same map. The keys and the
+ * values must be plain data, a pointer saved to a file means nothing in
+ * another process.
+*/
+#define HashMap_snapshot(hm_name, key_t, val_t) \
+HashMap_snapshot_declare(hm_name) \
+HashMap_snapshot_define(hm_name, key_t, val_t)
+
+#endif
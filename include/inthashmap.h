@@ -0,0 +1,301 @@
+#ifndef __INT_HASH_MAP_H__
+#define __INT_HASH_MAP_H__
+
+/**
+ * @file inthashmap.h
+ * @brief An open addressing hash map for integer keys, with the same API as
+ * the hash map in hashmap.h but without the hash and compare functions. The
+ * keys are hashed by a built-in invertible mixer and compared directly, and
+ * the entries don't store a hash, an entry is only the key and the value.
+ * Key 0 marks an empty slot, so a probe reads one word per slot. The entry
+ * of key 0 itself, if there is one, is kept in a spare slot after the rest.
+ * Removing shifts the following entries back, so there are no tombstones.
+*/
+
+#include<stdint.h>
+#include "hashmap.h"
+
+/**The default capacity of an int hash map.*/
+#define INTHASHMAP_DEFAULT_CAP 8
+/**The maximum load of the map, in eighths, before it grows.*/
+#define INTHASHMAP_MAX_LOAD 6
+/**The key that marks an empty slot.*/
+#define INTHASHMAP_EMPTY 0
+
+/**
+ * Mix the bits of an integer key, murmur3's finalizer. It's invertible, no
+ * two keys mix to the same hash.
+ * @param key The key to mix.
+ * @return The mixed key.
+*/
+static inline uint64_t inthashmap_mix(uint64_t key) {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdull;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ull;
+  key ^= key >> 33;
+  return key;
+}
+
+/**Get the home slot of a key, the slot the probe starts from.*/
+#define inthashmap_home(map, key) \
+  ((size_t)inthashmap_mix((uint64_t)(key)) & ((map)->cap - 1))
+
+/**
+ * Get the entry at a slot, including the spare slot at index `cap`, or NULL
+ * if the slot is empty.
+ * @param map A pointer to an int hash map.
+ * @param slot The index of the slot, from 0 to `cap`.
+*/
+#define intmap_entry_at(map, slot) \
+  ((slot) < (map)->cap \
+    ? ((map)->entries[(slot)].key != INTHASHMAP_EMPTY ? &(map)->entries[(slot)] : NULL) \
+    : ((map)->has_empty_key ? &(map)->entries[(slot)] : NULL))
+
+/**
+ * Iterate over every entry in an int hash map.
+ * @param map A pointer to the map to iterate over.
+ * @param entry A pointer for iterating over entries.
+ * @param slot An indexer for iterating over slots.
+ * @note Accesses the entries directly, overwriting anything except the value
+ * is unsafe and should not be done.
+*/
+#define intmap_for_each_entry(map, entry, slot) \
+  for ((slot) = 0; (slot) <= (map)->cap; (slot)++) \
+  for ((entry) = intmap_entry_at(map, slot); (entry) != NULL; (entry) = NULL)
+
+/* ========================= DEFINITIONS ========================= */
+
+#define IntHashMap_entry_define(hm_name, int_t, val_t) \
+/**Represents an entry in the int hash map.*/ \
+struct hm_name##_entry_t { \
+  /**The key of the entry, INTHASHMAP_EMPTY in an empty slot.*/ \
+  int_t key; \
+  /**The value of the entry.*/ \
+  val_t val; \
+};
+
+#define IntHashMap_struct_define(hm_name) \
+/**Represents an int hash map data structure.*/ \
+struct hm_name { \
+  /**The slots of the map, and a spare slot at index `cap` for the key \
+   * INTHASHMAP_EMPTY.*/ \
+  hm_name##_entry_t *entries; \
+  /**The amount of entries in the map.*/ \
+  size_t size; \
+  /**The amount of slots in the map, a power of 2, not counting the spare.*/ \
+  size_t cap; \
+  /**Whether the key INTHASHMAP_EMPTY is in the map, in the spare slot.*/ \
+  bool has_empty_key; \
+};
+
+#define IntHashMap_find_define(hm_name, int_t) \
+/**Find the slot of a key, or the empty slot it would go to. The key must \
+ * not be INTHASHMAP_EMPTY.*/ \
+static inline size_t hm_name##_find(const hm_name *map, int_t key) { \
+  size_t mask = map->cap - 1; \
+  size_t i = inthashmap_home(map, key); \
+  while (map->entries[i].key != key && map->entries[i].key != INTHASHMAP_EMPTY) { \
+    i = (i + 1) & mask; \
+  } \
+  return i; \
+}
+
+#define IntHashMap_alloc_define(hm_name) \
+/**Allocate empty slots for a capacity, plus the spare slot.*/ \
+static hm_name##_entry_t * hm_name##_alloc(size_t cap) { \
+  hm_name##_entry_t *entries = malloc((cap + 1) * sizeof(hm_name##_entry_t)); \
+  if (entries == NULL) return NULL; \
+  for (size_t i = 0; i < cap; i++) entries[i].key = INTHASHMAP_EMPTY; \
+  return entries; \
+}
+
+#define IntHashMap_init_define(hm_name) \
+DS_codes_t hm_name##_init(hm_name *map, size_t size) { \
+  size_t cap = INTHASHMAP_DEFAULT_CAP; \
+  while (cap / 8 * INTHASHMAP_MAX_LOAD <= size) cap *= 2; \
+ \
+  map->entries = hm_name##_alloc(cap); \
+  if (map->entries == NULL) return ERR_MEM; \
+  map->size = 0; \
+  map->cap = cap; \
+  map->has_empty_key = false; \
+ \
+  return DS_SUCCESS; \
+}
+
+#define IntHashMap_put_define(hm_name, int_t, val_t) \
+DS_codes_t hm_name##_put(hm_name *map, const int_t *key, const val_t *value) { \
+  if (*key == INTHASHMAP_EMPTY) { \
+    map->entries[map->cap].key = *key; \
+    map->entries[map->cap].val = *value; \
+    if (map->has_empty_key) return HMP_SET; \
+    map->has_empty_key = true; \
+    map->size++; \
+    return HMP_ADD; \
+  } \
+ \
+  size_t i = hm_name##_find(map, *key); \
+  map->entries[i].val = *value; \
+  if (map->entries[i].key == *key) return HMP_SET; \
+  map->entries[i].key = *key; \
+  map->size++; \
+ \
+  /* Check if resize needed. */ \
+  if (map->size > map->cap / 8 * INTHASHMAP_MAX_LOAD) { \
+    DS_codes_t res = hm_name##_resize(map, map->cap); \
+    if (res != DS_SUCCESS) return res; \
+  } \
+  return HMP_ADD; \
+}
+
+#define IntHashMap_has_define(hm_name, int_t) \
+bool hm_name##_has(const hm_name *map, const int_t *key) { \
+  if (*key == INTHASHMAP_EMPTY) return map->has_empty_key; \
+  return map->entries[hm_name##_find(map, *key)].key == *key; \
+}
+
+#define IntHashMap_get_define(hm_name, int_t, val_t) \
+val_t * hm_name##_get(const hm_name *map, const int_t *key) { \
+  if (*key == INTHASHMAP_EMPTY) { \
+    return map->has_empty_key ? &map->entries[map->cap].val : NULL; \
+  } \
+  hm_name##_entry_t *entry = map->entries + hm_name##_find(map, *key); \
+  return entry->key == *key ? &entry->val : NULL; \
+}
+
+#define IntHashMap_remove_define(hm_name, int_t) \
+DS_codes_t hm_name##_remove(hm_name *map, const int_t *key) { \
+  if (*key == INTHASHMAP_EMPTY) { \
+    if (!map->has_empty_key) return ERR_KEYNOTFOUND; \
+    map->has_empty_key = false; \
+    map->size--; \
+    return DS_SUCCESS; \
+  } \
+  size_t i = hm_name##_find(map, *key); \
+  if (map->entries[i].key != *key) return ERR_KEYNOTFOUND; \
+ \
+  /* Shift back every following entry whose home is not between the hole \
+   * and itself, until an empty slot. */ \
+  size_t mask = map->cap - 1; \
+  for (size_t next = (i + 1) & mask; map->entries[next].key != INTHASHMAP_EMPTY; \
+    next = (next + 1) & mask) { \
+    size_t home = inthashmap_home(map, map->entries[next].key); \
+    if (((next - home) & mask) >= ((next - i) & mask)) { \
+      memcpy(map->entries + i, map->entries + next, sizeof(hm_name##_entry_t)); \
+      i = next; \
+    } \
+  } \
+  map->entries[i].key = INTHASHMAP_EMPTY; \
+  map->size--; \
+  return DS_SUCCESS; \
+}
+
+#define IntHashMap_clear_define(hm_name) \
+void hm_name##_clear(hm_name *map) { \
+  for (size_t i = 0; i < map->cap; i++) map->entries[i].key = INTHASHMAP_EMPTY; \
+  map->has_empty_key = false; \
+  map->size = 0; \
+}
+
+#define IntHashMap_resize_define(hm_name) \
+DS_codes_t hm_name##_resize(hm_name *map, size_t new_size) { \
+  if (new_size < map->size) return ERR_TOOSMALL; \
+ \
+  size_t cap = INTHASHMAP_DEFAULT_CAP; \
+  while (cap / 8 * INTHASHMAP_MAX_LOAD <= new_size) { \
+    if (cap > SIZE_MAX / 2 / sizeof(hm_name##_entry_t)) return ERR_TOOBIG; \
+    cap *= 2; \
+  } \
+ \
+  hm_name##_entry_t *entries = hm_name##_alloc(cap); \
+  if (entries == NULL) return ERR_MEM; \
+  hm_name##_entry_t *old = map->entries; \
+  size_t old_cap = map->cap; \
+  map->entries = entries; \
+  map->cap = cap; \
+  for (size_t i = 0; i < old_cap; i++) { \
+    if (old[i].key == INTHASHMAP_EMPTY) continue; \
+    size_t slot = hm_name##_find(map, old[i].key); \
+    memcpy(entries + slot, old + i, sizeof(hm_name##_entry_t)); \
+  } \
+  memcpy(entries + cap, old + old_cap, sizeof(hm_name##_entry_t)); \
+ \
+  free(old); \
+  return DS_SUCCESS; \
+}
+
+#define IntHashMap_destroy_define(hm_name) \
+void hm_name##_destroy(hm_name *map) { \
+  if (map->entries != NULL) free(map->entries); \
+}
+
+/* ========================= ALL ========================= */
+
+/**
+ * Generate the declarations for an int hash map data structure for a given
+ * key and value types.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param int_t The integer type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @note It's best to put this macro in a header file.
+*/
+#define IntHashMap_declare(hm_name, int_t, val_t) \
+HashMap_entry_declare(hm_name) \
+HashMap_struct_declare(hm_name) \
+HashMap_new_declare(hm_name) \
+HashMap_snew_declare(hm_name) \
+HashMap_init_declare(hm_name) \
+HashMap_put_declare(hm_name, int_t, val_t) \
+HashMap_has_declare(hm_name, int_t) \
+HashMap_get_declare(hm_name, int_t, val_t) \
+HashMap_remove_declare(hm_name, int_t) \
+HashMap_clear_declare(hm_name) \
+HashMap_resize_declare(hm_name) \
+HashMap_destroy_declare(hm_name) \
+HashMap_free_declare(hm_name)
+
+/**
+ * Generate the definitions for the int hash map data structure for a given
+ * key and value types.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param int_t The integer type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @note It's best to put this macro in a code file.
+*/
+#define IntHashMap_define(hm_name, int_t, val_t) \
+IntHashMap_entry_define(hm_name, int_t, val_t) \
+IntHashMap_struct_define(hm_name) \
+IntHashMap_find_define(hm_name, int_t) \
+IntHashMap_alloc_define(hm_name) \
+HashMap_new_define(hm_name) \
+HashMap_snew_define(hm_name) \
+IntHashMap_init_define(hm_name) \
+IntHashMap_put_define(hm_name, int_t, val_t) \
+IntHashMap_has_define(hm_name, int_t) \
+IntHashMap_get_define(hm_name, int_t, val_t) \
+IntHashMap_remove_define(hm_name, int_t) \
+IntHashMap_clear_define(hm_name) \
+IntHashMap_resize_define(hm_name) \
+IntHashMap_destroy_define(hm_name) \
+HashMap_free_define(hm_name)
+
+/**
+ * Generate a full int hash map data structure implementation for a given
+ * key and value types. Has the same functions as the HashMap macro, without
+ * the hash and keycmp functions.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param int_t The integer type of the key for the hash map, any integer
+ * type of up to 64 bits.
+ * @param val_t The data type of the value for the hash map.
+ * @note Entries move on insert and remove, pointers returned by get() are
+ * only valid until the next put() or remove().
+*/
+#define IntHashMap(hm_name, int_t, val_t) \
+IntHashMap_declare(hm_name, int_t, val_t) \
+IntHashMap_define(hm_name, int_t, val_t)
+
+#endif
@@ -0,0 +1,432 @@
+#ifndef __LINKED_HASH_MAP_H__
+#define __LINKED_HASH_MAP_H__
+
+/**
+ * @file linkedhashmap.h
+ * @brief An insertion ordered hash map. Same layout and API as the hash map in
+ * hashmap.h, but every entry is also linked into a doubly linked list by the
+ * indices of the entries that were added before and after it. The order list
+ * makes it possible to evict the oldest entry in O(1), which is all an LRU
+ * cache needs.
+*/
+
+#include "hashmap.h"
+
+/**
+ * Get the oldest entry in a linked hash map or NULL if the map is empty.
+ * @param map A pointer to a linked hash map.
+*/
+#define linkedmap_oldest_entry(map) \
+  ((map)->oldest != -1 ? &(map)->entries[(map)->oldest] : NULL)
+
+/**
+ * Get the entry that was added after a given entry, or NULL if the entry is
+ * the newest.
+ * @param map A pointer to a linked hash map.
+ * @param entry A pointer to the entry to get the newer entry from.
+*/
+#define linkedmap_newer_entry(map, entry) \
+  ((entry)->newer != -1 ? &(map)->entries[(entry)->newer] : NULL)
+
+/**
+ * Iterate over every entry in a linked hash map, from the oldest to the newest.
+ * @param map A pointer to the map to iterate over.
+ * @param entry A pointer for iterating over entries.
+ * @note Accesses the entries directly, overwriting anything except the value
+ * is unsafe and should not be done.
+*/
+#define linkedmap_for_each_entry(map, entry) \
+  for ((entry) = linkedmap_oldest_entry(map); (entry) != NULL; \
+    (entry) = linkedmap_newer_entry(map, entry))
+
+/* ========================= DECLARATIONS ========================= */
+
+#define LinkedHashMap_touch_declare(hm_name, key_t) \
+/** \
+ * Mark a key as the most recently used, moving it's entry to the newest end \
+ * of the order list. \
+ * @param map The linked hash map. \
+ * @param key The key to touch. \
+ * @return DS_SUCCESS if the key was moved, an error code otherwise. \
+ * @note Errors: \
+ * ERR_KEYNOTFOUND - If the key was not found in the map. \
+*/ \
+DS_codes_t hm_name##_touch(hm_name *map, const key_t *key);
+
+#define LinkedHashMap_pop_oldest_declare(hm_name, key_t, val_t) \
+/** \
+ * Remove the oldest entry in the map. \
+ * @param map The linked hash map. \
+ * @param key A pointer to copy the removed key into, can be NULL. \
+ * @param value A pointer to copy the removed value into, can be NULL. \
+ * @return DS_SUCCESS on successfull removal, an error code otherwise. \
+ * @note Errors: \
+ * ERR_EMPTY - If the map is empty. \
+*/ \
+DS_codes_t hm_name##_pop_oldest(hm_name *map, key_t *key, val_t *value);
+
+#define LinkedHashMap_put_evict_declare(hm_name, key_t, val_t) \
+/** \
+ * Adds or overwrites a key value pair to the map, keeping the map at no more \
+ * than `max_size` entries by evicting the oldest entry before adding a new one. \
+ * @param map The linked hash map. \
+ * @param key The key by which to map the pair. \
+ * @param value The value to map to the key. \
+ * @param max_size The maximum amount of entries the map may hold. \
+ * @param evicted_key A pointer to copy the evicted key into, can be NULL. \
+ * @param evicted_val A pointer to copy the evicted value into, can be NULL. \
+ * @return HMP_ADD if a new pair was added, HMP_EVICT if a new pair was added \
+ * and the oldest pair was evicted to make room, HMP_SET if the key already \
+ * exists and it's paired value was overwritten. An error code on failure. \
+ * @note Errors: \
+ * ERR_TOOSMALL - `max_size` is 0. \
+ * ERR_MEM - Memory allocation error. \
+ * @note Create the map with snew(max_size + 1) and it will never resize. \
+*/ \
+DS_codes_t hm_name##_put_evict(hm_name *map, const key_t *key, \
+  const val_t *value, size_t max_size, key_t *evicted_key, val_t *evicted_val);
+
+/* ========================= DEFINITIONS ========================= */
+
+#define LinkedHashMap_entry_define(hm_name, key_t, val_t, hash_t) \
+/**Represents an entry in the linked hash map.*/ \
+struct hm_name##_entry_t { \
+  /**The key of the entry*/ \
+  const key_t key; \
+  /**The hash of the key.*/ \
+  const hash_t key_hash; \
+  /**The index of the next entry in case of hash collisions.*/ \
+  ssize_t next; \
+  /**The index of the entry that was added before this one, -1 if oldest.*/ \
+  ssize_t older; \
+  /**The index of the entry that was added after this one, -1 if newest.*/ \
+  ssize_t newer; \
+  /**The value of the entry.*/ \
+  val_t val; \
+};
+
+#define LinkedHashMap_struct_define(hm_name) \
+/**Represents an insertion ordered hash map data structure.*/ \
+struct hm_name { \
+  /**The entries of the map, all the Key-Value pairs.*/ \
+  hm_name##_entry_t *entries; \
+  /**An array of indices that maps a normalized hash to an entry index. \
+   * Index -1 means there is no such entry.*/ \
+  ssize_t* buckets; \
+  /**The amount of entries in the map.*/ \
+  size_t size; \
+  /**The next empty cell in the entries array.*/ \
+  size_t next_empty; \
+  /**The maximum capacity of the map.*/ \
+  size_t cap; \
+  /**The index of the oldest entry, -1 if the map is empty.*/ \
+  ssize_t oldest; \
+  /**The index of the newest entry, -1 if the map is empty.*/ \
+  ssize_t newest; \
+};
+
+#define LinkedHashMap_order_define(hm_name) \
+/**Unlink the entry at index `i` from the order list.*/ \
+static void hm_name##_order_unlink(hm_name *map, ssize_t i) { \
+  hm_name##_entry_t *entry = map->entries + i; \
+  if (entry->older == -1) map->oldest = entry->newer; \
+  else map->entries[entry->older].newer = entry->newer; \
+  if (entry->newer == -1) map->newest = entry->older; \
+  else map->entries[entry->newer].older = entry->older; \
+} \
+/**Link the entry at index `i` to the newest end of the order list.*/ \
+static void hm_name##_order_append(hm_name *map, ssize_t i) { \
+  hm_name##_entry_t *entry = map->entries + i; \
+  entry->older = map->newest; \
+  entry->newer = -1; \
+  if (map->newest == -1) map->oldest = i; \
+  else map->entries[map->newest].newer = i; \
+  map->newest = i; \
+}
+
+#define LinkedHashMap_relocate_define(hm_name) \
+/**Called when shrinking moves an entry to a different index, after it was \
+ * copied to it's new index. Points it's neighbours in the order at it.*/ \
+static inline void hm_name##_relocate(hm_name *map, ssize_t from, ssize_t to) { \
+  hm_name##_entry_t *entry = map->entries + to; \
+  (void)from; \
+  if (entry->older == -1) map->oldest = to; \
+  else map->entries[entry->older].newer = to; \
+  if (entry->newer == -1) map->newest = to; \
+  else map->entries[entry->newer].older = to; \
+}
+
+#define LinkedHashMap_init_define(hm_name) \
+DS_codes_t hm_name##_init(hm_name *map, size_t size) { \
+  size_t initial = nearest_prime(size); \
+ \
+  map->buckets = DS_MALLOC(initial*sizeof(size_t)); \
+  if (map->buckets == NULL) return ERR_MEM; \
+  for(size_t i = 0; i < initial; i++) map->buckets[i] = -1; \
+ \
+  map->entries = DS_MALLOC(initial*sizeof(hm_name##_entry_t)); \
+  if (map->entries == NULL) { \
+    DS_FREE(map->buckets); \
+    return ERR_MEM; \
+  } \
+  for(size_t i = 0; i < initial; i++) { \
+    map->entries[i].next = i+1; \
+  } \
+ \
+  map->cap = initial; \
+  map->size = 0; \
+  map->next_empty = 0; \
+  map->oldest = -1; \
+  map->newest = -1; \
+ \
+  return DS_SUCCESS; \
+}
+
+#define LinkedHashMap_put_define(hm_name, key_t, val_t, hash_t) \
+DS_codes_t hm_name##_put(hm_name *map, const key_t *key, const val_t *value) { \
+  hash_t hash = hm_name##_hash(key); \
+  size_t bucket = hash % map->cap; \
+ \
+  /* If the key exists, overwrite it, it's place in the order is kept. */ \
+  for(ssize_t i = map->buckets[bucket]; i != -1; i = map->entries[i].next) { \
+    hm_name##_entry_t *entry = map->entries + i; \
+    if (entry->key_hash == hash && hm_name##_keycmp(key, &entry->key)) { \
+      entry->val = *value; \
+      return HMP_SET; \
+    } \
+  } \
+ \
+  /* Key doesn't exist. Insert */ \
+  size_t empty = map->next_empty; \
+  map->next_empty = map->entries[map->next_empty].next; \
+  hm_name##_entry_t new_entry = { \
+    .key = *key, \
+    .key_hash = hash, \
+    .next = map->buckets[bucket], \
+    .val = *value \
+  }; \
+  map->buckets[bucket] = empty; \
+  memcpy(map->entries + empty, &new_entry, sizeof(hm_name##_entry_t)); \
+  hm_name##_order_append(map, empty); \
+ \
+  /* Check if resize needed. */ \
+  map->size++; \
+  if (map->size == map->cap) { \
+    DS_codes_t res = hm_name##_resize(map, map->cap + 1); \
+    if (res != DS_SUCCESS) return res; \
+  } \
+ \
+  return HMP_ADD; \
+}
+
+#define LinkedHashMap_remove_define(hm_name, key_t, hash_t) \
+DS_codes_t hm_name##_remove(hm_name *map, const key_t *key) { \
+  hash_t hash = hm_name##_hash(key); \
+  size_t bucket = hash % map->cap; \
+  ssize_t prev = -1; \
+ \
+  for (ssize_t i = map->buckets[bucket]; i != -1; i = map->entries[i].next) { \
+    hm_name##_entry_t *entry = map->entries + i; \
+    if (entry->key_hash == hash && hm_name##_keycmp(key, &entry->key)) { \
+      /* Unlink entry from the bucket and from the order. */ \
+      if (prev == -1) map->buckets[bucket] = entry->next; \
+      else map->entries[prev].next = entry->next; \
+      hm_name##_order_unlink(map, i); \
+      /* Set the entry's index as the next empty slot. */ \
+      entry->next = map->next_empty; \
+      map->next_empty = i; \
+      map->size--; \
+      return DS_SUCCESS; \
+    } \
+    prev = i; \
+  } \
+ \
+  return ERR_KEYNOTFOUND; \
+}
+
+#define LinkedHashMap_touch_define(hm_name, key_t, hash_t) \
+DS_codes_t hm_name##_touch(hm_name *map, const key_t *key) { \
+  hash_t hash = hm_name##_hash(key); \
+  size_t bucket = hash % map->cap; \
+ \
+  for (ssize_t i = map->buckets[bucket]; i != -1; i = map->entries[i].next) { \
+    hm_name##_entry_t *entry = map->entries + i; \
+    if (entry->key_hash == hash && hm_name##_keycmp(key, &entry->key)) { \
+      if (map->newest != i) { \
+        hm_name##_order_unlink(map, i); \
+        hm_name##_order_append(map, i); \
+      } \
+      return DS_SUCCESS; \
+    } \
+  } \
+ \
+  return ERR_KEYNOTFOUND; \
+}
+
+#define LinkedHashMap_pop_oldest_define(hm_name, key_t, val_t) \
+DS_codes_t hm_name##_pop_oldest(hm_name *map, key_t *key, val_t *value) { \
+  ssize_t oldest = map->oldest; \
+  if (oldest == -1) return ERR_EMPTY; \
+  hm_name##_entry_t *entry = map->entries + oldest; \
+ \
+  /* Unlink entry from it's bucket, the chain is short, the order is O(1). */ \
+  size_t bucket = entry->key_hash % map->cap; \
+  if (map->buckets[bucket] == oldest) map->buckets[bucket] = entry->next; \
+  else { \
+    ssize_t prev = map->buckets[bucket]; \
+    while (map->entries[prev].next != oldest) prev = map->entries[prev].next; \
+    map->entries[prev].next = entry->next; \
+  } \
+  hm_name##_order_unlink(map, oldest); \
+ \
+  if (key != NULL) *key = entry->key; \
+  if (value != NULL) *value = entry->val; \
+  entry->next = map->next_empty; \
+  map->next_empty = oldest; \
+  map->size--; \
+  return DS_SUCCESS; \
+}
+
+#define LinkedHashMap_put_evict_define(hm_name, key_t, val_t, hash_t) \
+DS_codes_t hm_name##_put_evict(hm_name *map, const key_t *key, \
+  const val_t *value, size_t max_size, key_t *evicted_key, val_t *evicted_val) { \
+  if (max_size == 0) return ERR_TOOSMALL; \
+  hash_t hash = hm_name##_hash(key); \
+  size_t bucket = hash % map->cap; \
+ \
+  for(ssize_t i = map->buckets[bucket]; i != -1; i = map->entries[i].next) { \
+    hm_name##_entry_t *entry = map->entries + i; \
+    if (entry->key_hash == hash && hm_name##_keycmp(key, &entry->key)) { \
+      entry->val = *value; \
+      return HMP_SET; \
+    } \
+  } \
+ \
+  /* Evict before inserting, so the map never goes over `max_size`. */ \
+  DS_codes_t code = HMP_ADD; \
+  while (map->size >= max_size) { \
+    hm_name##_pop_oldest(map, evicted_key, evicted_val); \
+    code = HMP_EVICT; \
+  } \
+ \
+  size_t empty = map->next_empty; \
+  map->next_empty = map->entries[map->next_empty].next; \
+  hm_name##_entry_t new_entry = { \
+    .key = *key, \
+    .key_hash = hash, \
+    .next = map->buckets[bucket], \
+    .val = *value \
+  }; \
+  map->buckets[bucket] = empty; \
+  memcpy(map->entries + empty, &new_entry, sizeof(hm_name##_entry_t)); \
+  hm_name##_order_append(map, empty); \
+ \
+  map->size++; \
+  if (map->size == map->cap) { \
+    DS_codes_t res = hm_name##_resize(map, map->cap + 1); \
+    if (res != DS_SUCCESS) return res; \
+  } \
+ \
+  return code; \
+}
+
+#define LinkedHashMap_clear_define(hm_name) \
+void hm_name##_clear(hm_name *map) { \
+  for (size_t i = 0; i < map->cap; i++) { \
+    map->buckets[i] = -1; \
+    map->entries[i].next = i + 1; \
+  } \
+  map->next_empty = 0; \
+  map->size = 0; \
+  map->oldest = -1; \
+  map->newest = -1; \
+}
+
+/* ========================= ALL ========================= */
+
+/**
+ * Generate the declarations for a linked hash map data structure for a given
+ * key and value types.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @param hash_t The data type of the hash.
+ * @note It's best to put this macro in a header file.
+*/
+#define LinkedHashMap_declare(hm_name, key_t, val_t, hash_t) \
+HashMap_entry_declare(hm_name) \
+HashMap_struct_declare(hm_name) \
+HashMap_hash_declare(hm_name, key_t, hash_t) \
+HashMap_keycmp_declare(hm_name, key_t) \
+HashMap_new_declare(hm_name) \
+HashMap_snew_declare(hm_name) \
+HashMap_init_declare(hm_name) \
+HashMap_put_declare(hm_name, key_t, val_t) \
+HashMap_has_declare(hm_name, key_t) \
+HashMap_get_declare(hm_name, key_t, val_t) \
+HashMap_remove_declare(hm_name, key_t) \
+LinkedHashMap_touch_declare(hm_name, key_t) \
+LinkedHashMap_pop_oldest_declare(hm_name, key_t, val_t) \
+LinkedHashMap_put_evict_declare(hm_name, key_t, val_t) \
+HashMap_clear_declare(hm_name) \
+HashMap_resize_declare(hm_name) \
+HashMap_destroy_declare(hm_name) \
+HashMap_free_declare(hm_name)
+
+/**
+ * Generate the definitions for the linked hash map data structure for a given
+ * key and value types.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @param hash_t The data type of the hash.
+ * @param hash A pointer to the hash function for hashing keys.
+ * @param keycmp A pointer to a function for comparing keys.
+ * @note It's best to put this macro in a code file.
+*/
+#define LinkedHashMap_define(hm_name, key_t, val_t, hash_t, hash, keycmp) \
+LinkedHashMap_entry_define(hm_name, key_t, val_t, hash_t) \
+LinkedHashMap_struct_define(hm_name) \
+HashMap_no_filter_define(hm_name) \
+HashMap_hash_define(hm_name, key_t, hash_t, hash) \
+HashMap_keycmp_define(hm_name, key_t, keycmp) \
+LinkedHashMap_order_define(hm_name) \
+HashMap_new_define(hm_name) \
+HashMap_snew_define(hm_name) \
+LinkedHashMap_init_define(hm_name) \
+LinkedHashMap_put_define(hm_name, key_t, val_t, hash_t) \
+HashMap_has_define(hm_name, key_t, hash_t) \
+HashMap_get_define(hm_name, key_t, val_t, hash_t) \
+LinkedHashMap_remove_define(hm_name, key_t, hash_t) \
+LinkedHashMap_touch_define(hm_name, key_t, hash_t) \
+LinkedHashMap_pop_oldest_define(hm_name, key_t, val_t) \
+LinkedHashMap_put_evict_define(hm_name, key_t, val_t, hash_t) \
+LinkedHashMap_clear_define(hm_name) \
+LinkedHashMap_relocate_define(hm_name) \
+HashMap_shrink_define(hm_name) \
+HashMap_resize_define(hm_name) \
+HashMap_destroy_define(hm_name) \
+HashMap_free_define(hm_name)
+
+/**
+ * Generate a full linked hash map data structure implementation for a given
+ * key and value types. The map keeps it's entries in insertion order, touch()
+ * moves an entry to the newest end, so together with pop_oldest() and
+ * put_evict() it can be used as an LRU cache.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @param hash_t The data type of the hash.
+ * @param hash A pointer to the hash function for hashing keys.
+ * @param keycmp A pointer to a function for comparing keys.
+ * @note Like the HashMap macro, it would be better to use the
+ * LinkedHashMap_declare and LinkedHashMap_define macros seperately.
+*/
+#define LinkedHashMap(hm_name, key_t, val_t, hash_t, hash, keycmp) \
+LinkedHashMap_declare(hm_name, key_t, val_t, hash_t) \
+LinkedHashMap_define(hm_name, key_t, val_t, hash_t, hash, keycmp)
+
+#endif
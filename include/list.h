@@ -4,8 +4,14 @@
 #include<stdio.h>
 #include<stdlib.h>
 #include<string.h>
+#include "bigalloc.h"
 
 #define DEFAULT_SIZE 8
+/**The default growth factor of a list, as a fraction, the size is doubled.*/
+#define LIST_GROWTH_NUM 2
+#define LIST_GROWTH_DEN 1
+/**A comparator for sort() and the sorted list functions, the natural order of numbers.*/
+#define LIST_LESS(a, b) ((a) < (b))
 
 /* ========================= DECLARATIONS ========================= */
 
@@ -100,11 +106,39 @@ void List_name##_set(List_name* list, type element, size_t index);
 #define List_enlarge_declare(List_name) \
 /** \
  * Enlarge the maximum size of the list if it's full enough. \
- * This implementation doubles the list's size if the list is more than half-full. \
+ * This implementation grows the list's size by it's growth factor if the list is more than half-full, \
+ * the factor is 2 unless the list was generated with STRUCT_LIST_GROWTH. \
  * @param list The pointer to the list. \
 */ \
 void List_name##_enlarge(List_name* list);
 
+#define List_reserve_declare(List_name) \
+/** \
+ * Makes room for at least a given amount of elements, without enlarging again. \
+ * If the list can already store 'size' elements, nothing is allocated. \
+ * @param list The pointer to the list. \
+ * @param size The amount of elements the list must be able to store. \
+*/ \
+void List_name##_reserve(List_name* list, size_t size);
+
+#define List_shrink_to_fit_declare(List_name) \
+/** \
+ * Shrinks the maximum size of the list to it's size, giving back the unused memory. \
+ * @param list The pointer to the list. \
+*/ \
+void List_name##_shrink_to_fit(List_name* list);
+
+#define List_resize_declare(List_name, type) \
+/** \
+ * Changes the amount of elements in the list. \
+ * Elements past 'size' are removed, new elements are set to 'fill'. \
+ * The maximum size only grows, and exactly to 'size' if it's too small. \
+ * @param list The pointer to the list. \
+ * @param size The new amount of elements. \
+ * @param fill The element to set the new elements to. \
+*/ \
+void List_name##_resize(List_name* list, size_t size, type fill);
+
 #define List_add_declare(List_name, type) \
 /** \
  * Adds an element to the end of the list. \
@@ -137,6 +171,35 @@ void List_name##_remove(List_name* list, size_t index);
 */ \
 void List_name##_remove_last(List_name* list);
 
+#define List_removeRange_declare(List_name) \
+/** \
+ * Removes a range of elements, keeping the order of the rest. \
+ * @param list The pointer to the list. \
+ * @param index The index of the first element to remove. \
+ * @param count The amount of elements to remove. \
+*/ \
+void List_name##_removeRange(List_name* list, size_t index, size_t count);
+
+#define List_removeIf_declare(List_name, type) \
+/** \
+ * Removes every element a predicate is true for, keeping the order of the rest. \
+ * The list is compacted in a single pass. \
+ * @param list The pointer to the list. \
+ * @param pred The predicate, it's given a pointer to the element and 'ctx'. \
+ * @param ctx A context to pass to the predicate. \
+ * @return The amount of elements that were removed. \
+*/ \
+size_t List_name##_removeIf(List_name* list, int (*pred)(type const*, void*), void* ctx);
+
+#define List_swapRemove_declare(List_name) \
+/** \
+ * Removes an element at a given index by moving the last element to it's place. \
+ * Doesn't keep the order of the list, but doesn't shift the rest of it. \
+ * @param list The pointer to the list. \
+ * @param index The index of the element to remove. \
+*/ \
+void List_name##_swapRemove(List_name* list, size_t index);
+
 #define List_insert_declare(List_name, type) \
 /** \
  * Inserts an element to a given index in the list. \
@@ -178,7 +241,7 @@ type* List_name##_toNewArray(const List_name* list);
 /** \
  * Free all the memory used by the list. \
  * @param list The pointer to the list. \
- * @note Do not call with lists that aren't malloc'd! Call `free(list->_arr)` instead. \
+ * @note Do not call with lists that aren't malloc'd! Call `DS_FREE(list->_arr)` instead. \
 */ \
 void List_name##_delete(List_name* list);
 
@@ -224,7 +287,7 @@ List_name* List_name##_newa(const type* arr, size_t size) { \
 
 #define List_init_define(List_name, type) \
 void List_name##_init(List_name* list, size_t size) { \
-	list->_arr = (type*)malloc(size * sizeof(type)); \
+	list->_arr = (type*)DS_MALLOC(size * sizeof(type)); \
 	if (!list->_arr){ \
 		fprintf(stderr, "Error at List_name##_init: malloc returned NULL\n"); \
 		exit(EXIT_FAILURE); \
@@ -274,22 +337,48 @@ void List_name##_set(List_name* list, type element, size_t index) { \
 	list->_arr[index] = element; \
 }
 
-#define List_enlarge_define(List_name, type) \
-void List_name##_enlarge(List_name* list) { \
-	/*if list is less then half full, don't enlarge*/ \
-	if (list->_size * 2 < list->_maxSize) return; \
-	list->_maxSize *= 2; \
- \
-	type* newArr = (type*)malloc(sizeof(type) * list->_maxSize); \
+#define List_growth_define(List_name, type, num, den) \
+/*Returns the next maximum size after 'maxSize', always bigger.*/ \
+static inline size_t List_name##_nextSize(size_t maxSize) { \
+	size_t next = maxSize / (den) * (num) + maxSize % (den) * (num) / (den); \
+	return next > maxSize ? next : maxSize + 1; \
+} \
+/*Changes the size of the array to 'maxSize'. realloc can extend the array in place, \
+ *and large arrays are moved by remapping their pages(mremap), not copied.*/ \
+static void List_name##_reallocate(List_name* list, size_t maxSize, const char* caller) { \
+	type* newArr = (type*)DS_REALLOC(list->_arr, sizeof(type) * maxSize); \
 	if (!newArr){ \
-		fprintf(stderr, "Error at List_name##_enlarge: malloc returned NULL\n"); \
+		fprintf(stderr, "Error at %s: realloc returned NULL\n", caller); \
 		exit(EXIT_FAILURE); \
 	} \
-	memcpy(newArr, list->_arr, list->_size * sizeof(type)); \
- \
- \
-	free(list->_arr); \
 	list->_arr = newArr; \
+	list->_maxSize = maxSize; \
+}
+
+#define List_enlarge_define(List_name, type) \
+void List_name##_enlarge(List_name* list) { \
+	/*if list is less then half full, don't enlarge*/ \
+	if (list->_size * 2 < list->_maxSize) return; \
+	List_name##_reallocate(list, List_name##_nextSize(list->_maxSize), "List_name##_enlarge"); \
+}
+
+#define List_reserve_define(List_name) \
+void List_name##_reserve(List_name* list, size_t size) { \
+	if (size > list->_maxSize) List_name##_reallocate(list, size, "List_name##_reserve"); \
+}
+
+#define List_shrink_to_fit_define(List_name) \
+void List_name##_shrink_to_fit(List_name* list) { \
+	/*keep room for one element, a zero sized realloc may free the array*/ \
+	size_t size = list->_size ? list->_size : 1; \
+	if (size < list->_maxSize) List_name##_reallocate(list, size, "List_name##_shrink_to_fit"); \
+}
+
+#define List_resize_define(List_name, type) \
+void List_name##_resize(List_name* list, size_t size, type fill) { \
+	List_name##_reserve(list, size); \
+	for (size_t i = list->_size; i < size; i++) list->_arr[i] = fill; \
+	list->_size = size; \
 }
 
 #define List_add_define(List_name, type) \
@@ -302,17 +391,9 @@ void List_name##_add(List_name* list, type element) { \
 void List_name##_addArray(List_name* list, const type* arr, size_t size) { \
 	size_t totalSize = list->_size + size; \
 	if (totalSize >= list->_maxSize){ \
-		while (totalSize >= list->_maxSize) list->_maxSize *= 2; \
- \
-		type* newArr = (type*)malloc(sizeof(type) * list->_maxSize); \
-		if (!newArr){ \
-			fprintf(stderr, "Error at List_name##_addArray: malloc returned NULL\n"); \
-			exit(EXIT_FAILURE); \
-		} \
-		memcpy(newArr, list->_arr, list->_size * sizeof(type)); \
- \
-		free(list->_arr); \
-		list->_arr = newArr; \
+		size_t maxSize = list->_maxSize; \
+		while (totalSize >= maxSize) maxSize = List_name##_nextSize(maxSize); \
+		List_name##_reallocate(list, maxSize, "List_name##_addArray"); \
 	} \
  \
 	memcpy(list->_arr + list->_size, arr, size * sizeof(type)); \
@@ -328,9 +409,7 @@ void List_name##_remove(List_name* list, size_t index) { \
 		return; \
 	} \
 	if (!list->_size) return; \
-	for(int i = index; i < list->_size - 1; i++){ \
-		list->_arr[i] = list->_arr[i + 1]; \
-	} \
+	memmove(list->_arr + index, list->_arr + index + 1, (list->_size - index - 1) * sizeof(*list->_arr)); \
 	list->_size--; \
 }
 
@@ -339,6 +418,43 @@ void List_name##_remove_last(List_name* list) { \
 	if (list->_size) list->_size--; \
 }
 
+#define List_removeRange_define(List_name, type) \
+void List_name##_removeRange(List_name* list, size_t index, size_t count) { \
+	if (index > list->_size || count > list->_size - index){ \
+		fprintf(stderr, "Error at List_name##_removeRange: range(%zu, %zu) is out of bounds(%zu)\n", \
+			index, count, list->_size); \
+		exit(EXIT_FAILURE); \
+		return; \
+	} \
+	memmove(list->_arr + index, list->_arr + index + count, \
+		(list->_size - index - count) * sizeof(type)); \
+	list->_size -= count; \
+}
+
+#define List_removeIf_define(List_name, type) \
+size_t List_name##_removeIf(List_name* list, int (*pred)(type const*, void*), void* ctx) { \
+	/*skip the elements that stay in place*/ \
+	size_t kept = 0; \
+	while (kept < list->_size && !pred(list->_arr + kept, ctx)) kept++; \
+	for (size_t i = kept + 1; i < list->_size; i++) { \
+		if (!pred(list->_arr + i, ctx)) list->_arr[kept++] = list->_arr[i]; \
+	} \
+	size_t removed = list->_size - kept; \
+	list->_size = kept; \
+	return removed; \
+}
+
+#define List_swapRemove_define(List_name) \
+void List_name##_swapRemove(List_name* list, size_t index) { \
+	if (index >= list->_size){ \
+		fprintf(stderr, "Error at List_name##_swapRemove: index(%zu) is out of bounds(%zu)\n", \
+			index, list->_size); \
+		exit(EXIT_FAILURE); \
+		return; \
+	} \
+	list->_arr[index] = list->_arr[--list->_size]; \
+}
+
 #define List_insert_define(List_name, type) \
 void List_name##_insert(List_name* list, type element, size_t index) { \
 	if (index > list->_size){ /*insert at _size is allowed, same as List_name##_add*/ \
@@ -347,29 +463,13 @@ void List_name##_insert(List_name* list, type element, size_t index) { \
 		exit(EXIT_FAILURE); \
 		return; \
 	} \
-	int enlarge = list->_size == list->_maxSize; \
-	type* dest = list->_arr; \
- \
-	if (enlarge){ \
-		list->_maxSize *= 2; \
-		dest = (type*)malloc(sizeof(type)*list->_maxSize); \
-		if (!dest){ \
-			fprintf(stderr, "Error at List_name##_insert: malloc returned NULL\n"); \
-			exit(EXIT_FAILURE); \
-		} \
-		memcpy(dest, list->_arr, sizeof(type)*index); \
+	if (list->_size == list->_maxSize){ \
+		List_name##_reallocate(list, List_name##_nextSize(list->_maxSize), "List_name##_insert"); \
 	} \
  \
-	for(int i = list->_size; i > index; i--) { \
-		dest[i] = list->_arr[i - 1]; \
-	} \
-	dest[index] = element; \
+	memmove(list->_arr + index + 1, list->_arr + index, (list->_size - index) * sizeof(type)); \
+	list->_arr[index] = element; \
 	list->_size++; \
- \
-	if (enlarge){ \
-		free(list->_arr); \
-		list->_arr = dest; \
-	} \
 }
 
 #define List_insertArray_define(List_name, type) \
@@ -382,27 +482,15 @@ void List_name##_insertArray(List_name* list, const type* arr, size_t size, size
 	} \
  \
 	size_t totalSize = list->_size + size; \
-	int enlarge = totalSize >= list->_maxSize; \
-	type* dest = list->_arr; \
-	if (enlarge){ \
-		while (totalSize >= list->_maxSize) list->_maxSize *= 2; \
- \
-		dest = (type*)malloc(sizeof(type) * list->_maxSize); \
-		if (!dest){ \
-			fprintf(stderr, "Error at List_name##_insertArray: malloc returned NULL\n"); \
-			exit(EXIT_FAILURE); \
-		} \
-		memcpy(dest, list->_arr, index * sizeof(type)); \
+	if (totalSize >= list->_maxSize){ \
+		size_t maxSize = list->_maxSize; \
+		while (totalSize >= maxSize) maxSize = List_name##_nextSize(maxSize); \
+		List_name##_reallocate(list, maxSize, "List_name##_insertArray"); \
 	} \
  \
-	memmove(dest + index + size, list->_arr + index, (list->_size - index) * sizeof(type)); \
-	memcpy(dest + index, arr, size * sizeof(type)); \
+	memmove(list->_arr + index + size, list->_arr + index, (list->_size - index) * sizeof(type)); \
+	memcpy(list->_arr + index, arr, size * sizeof(type)); \
 	list->_size += size; \
- \
-	if (enlarge) { \
-		free(list->_arr); \
-		list->_arr = dest; \
-	} \
 }
 
 #define List_toArray_define(List_name, type) \
@@ -420,7 +508,7 @@ type* List_name##_toNewArray(const List_name* list) { \
 
 #define List_delete_define(List_name) \
 void List_name##_delete(List_name* list) { \
-	free(list->_arr); \
+	DS_FREE(list->_arr); \
 	list->_arr = NULL; \
 	free(list); \
 }
@@ -442,10 +530,16 @@ List_at_declare(List_name, type) \
 List_get_declare(List_name, type) \
 List_set_declare(List_name, type) \
 List_enlarge_declare(List_name) \
+List_reserve_declare(List_name) \
+List_shrink_to_fit_declare(List_name) \
+List_resize_declare(List_name, type) \
 List_add_declare(List_name, type) \
 List_addArray_declare(List_name, type) \
 List_remove_declare(List_name) \
 List_remove_last_declare(List_name) \
+List_removeRange_declare(List_name) \
+List_removeIf_declare(List_name, type) \
+List_swapRemove_declare(List_name) \
 List_insert_declare(List_name, type) \
 List_insertArray_declare(List_name, type) \
 List_toArray_declare(List_name, type) \
@@ -453,7 +547,15 @@ List_toNewArray_declare(List_name, type) \
 List_delete_declare(List_name)
 
 #define List_define(List_name, type) \
+List_define_growth(List_name, type, LIST_GROWTH_NUM, LIST_GROWTH_DEN)
+
+/**
+ * Generate the definitions of a list that grows by a factor of num/den,
+ * like 3/2 to grow by half, instead of doubling.
+*/
+#define List_define_growth(List_name, type, num, den) \
 List_struct_define(List_name, type) \
+List_growth_define(List_name, type, num, den) \
 List_new_define(List_name) \
 List_news_define(List_name) \
 List_newa_define(List_name, type) \
@@ -465,10 +567,16 @@ List_at_define(List_name, type) \
 List_get_define(List_name, type) \
 List_set_define(List_name, type) \
 List_enlarge_define(List_name, type) \
+List_reserve_define(List_name) \
+List_shrink_to_fit_define(List_name) \
+List_resize_define(List_name, type) \
 List_add_define(List_name, type) \
 List_addArray_define(List_name, type) \
 List_remove_define(List_name) \
 List_remove_last_define(List_name) \
+List_removeRange_define(List_name, type) \
+List_removeIf_define(List_name, type) \
+List_swapRemove_define(List_name) \
 List_insert_define(List_name, type) \
 List_insertArray_define(List_name, type) \
 List_toArray_define(List_name, type) \
@@ -479,4 +587,16 @@ List_delete_define(List_name)
 List_declare(List_name, type) \
 List_define(List_name, type)
 
+/**
+ * Generate a list that grows by a factor of num/den when it's full, a smaller
+ * factor wastes less memory on big lists, a bigger one copies less often.
+ * @param type The type of the elements.
+ * @param List_name The name of the list.
+ * @param num The numerator of the growth factor.
+ * @param den The denominator of the growth factor, num/den must be above 1.
+*/
+#define STRUCT_LIST_GROWTH(type, List_name, num, den) \
+List_declare(List_name, type) \
+List_define_growth(List_name, type, num, den)
+
 #endif
\ No newline at end of file
@@ -0,0 +1,524 @@
+#ifndef __LIST_REDUCE_H__
+#define __LIST_REDUCE_H__
+
+#include<stdint.h>
+#include<sys/types.h>
+#include "list.h"
+#include "parallel.h"
+
+/*Reduction kernels for arrays of numbers, specialized per element width and signedness.
+ *With GCC or clang they're written with vector extensions, so they compile to SSE2, AVX2
+ *or whatever the target has, and keep 4 vectors of accumulators, so the additions of one
+ *iteration don't wait for the previous one. Sums and dot products are accumulated in the
+ *wider sum type, integers in 64 bits and floats in doubles, the lanes are added together
+ *at the end. Without vector extensions every list is reduced with plain loops.
+ *Floats are added in a different order than a plain loop, so the last bits of a sum may differ.
+ *Don't build with -ffast-math, it lets the compiler undo the compensation of sumKahan.*/
+
+/**The size of a vector of the kernels, an AVX2 register or an SSE register. Wider vectors than
+ * the target has are split to scalars by the compiler, not to narrower vectors.*/
+#if defined(__AVX2__)
+#define LIST_REDUCE_VEC 32
+#else
+#define LIST_REDUCE_VEC 16
+#endif
+/**The amount of elements that the max and min of arg max and arg min are taken of at a
+ * time, the index is then found in the block of the best one, while it's still cached.*/
+#define LIST_REDUCE_BLOCK 2048
+/**sumPairwise splits a list in halves until a half is shorter than this, and sums it directly.*/
+#define LIST_REDUCE_PAIRWISE_BLOCK 256
+/**Below this amount of elements a list is reduced on a single thread.*/
+#define LIST_REDUCE_PARALLEL_MIN 262144
+/**The alignment of the results of the threads of a parallel reduce, a cache line.*/
+#define LIST_REDUCE_ALIGN 64
+
+#if defined(__GNUC__) || defined(__clang__)
+/*Loads and picks are macros, functions that take or return vectors warn that their ABI
+ *depends on the instruction set.*/
+
+/*Load a vector of a kernel's elements from an unaligned address.*/
+#define list_reduce_load(suffix, arr) ({ \
+	list_reduce_vec_##suffix _v; \
+	memcpy(&_v, arr, sizeof(_v)); \
+	_v; \
+})
+/*Load a vector of a kernel's elements, converted to sums.*/
+#define list_reduce_widen(suffix, arr) ({ \
+	list_reduce_part_##suffix _v; \
+	memcpy(&_v, arr, sizeof(_v)); \
+	__builtin_convertvector(_v, list_reduce_wide_##suffix); \
+})
+/*Load a vector of a kernel's elements, converted to the type of it's partial sums.*/
+#define list_reduce_widen_mid(suffix, arr) ({ \
+	list_reduce_midpart_##suffix _v; \
+	memcpy(&_v, arr, sizeof(_v)); \
+	__builtin_convertvector(_v, list_reduce_mid_##suffix); \
+})
+/*Pick the lanes of 'b' that are 'op' than the lanes of 'a', and the lanes of 'a' otherwise.*/
+#define list_reduce_pick(op, a, b) ({ \
+	__typeof__(a) _a = (a), _b = (b); \
+	__typeof__(_a < _b) _take = _b op _a; \
+	(__typeof__(_a))(((__typeof__(_take))_a & ~_take) | ((__typeof__(_take))_b & _take)); \
+})
+
+/*Generate the kernels of one element type. Elements are loaded whole vectors at a time for
+ *min and max, and a vector of sums at a time, converted to sum_t, for dots. Sums are added
+ *in vectors of the narrower mid_t, 'block' iterations at a time, so they can't overflow,
+ *and then added to a sum_t, 8 and 16 bit elements take half or a quarter of the vectors.*/
+#define LIST_REDUCE_KERNELS(suffix, ctype, mid_t, block, sum_t) \
+typedef ctype list_reduce_vec_##suffix __attribute__((vector_size(LIST_REDUCE_VEC))); \
+typedef ctype list_reduce_part_##suffix __attribute__((vector_size(LIST_REDUCE_VEC / sizeof(sum_t) * sizeof(ctype)))); \
+typedef sum_t list_reduce_wide_##suffix __attribute__((vector_size(LIST_REDUCE_VEC))); \
+typedef ctype list_reduce_midpart_##suffix __attribute__((vector_size(LIST_REDUCE_VEC / sizeof(mid_t) * sizeof(ctype)))); \
+typedef mid_t list_reduce_mid_##suffix __attribute__((vector_size(LIST_REDUCE_VEC))); \
+ \
+static inline sum_t list_reduce_sum_##suffix(const void* data, size_t size) { \
+	const ctype* arr = data; \
+	const size_t per = LIST_REDUCE_VEC / sizeof(mid_t); \
+	sum_t sum = 0; \
+	size_t i = 0; \
+	while (i + 4 * per <= size) { \
+		list_reduce_mid_##suffix s0 = {0}, s1 = {0}, s2 = {0}, s3 = {0}; \
+		size_t iterations = (size - i) / (4 * per); \
+		if (iterations > (block)) iterations = (block); \
+		for (size_t end = i + iterations * 4 * per; i < end; i += 4 * per) { \
+			s0 += list_reduce_widen_mid(suffix, arr + i); \
+			s1 += list_reduce_widen_mid(suffix, arr + i + per); \
+			s2 += list_reduce_widen_mid(suffix, arr + i + 2 * per); \
+			s3 += list_reduce_widen_mid(suffix, arr + i + 3 * per); \
+		} \
+		s0 = (s0 + s1) + (s2 + s3); \
+		for (size_t l = 0; l < per; l++) sum += s0[l]; \
+	} \
+	for (; i < size; i++) sum += arr[i]; \
+	return sum; \
+} \
+ \
+static inline sum_t list_reduce_dot_##suffix(const void* data, const void* other, size_t size) { \
+	const ctype* arr = data, * arr2 = other; \
+	const size_t per = LIST_REDUCE_VEC / sizeof(sum_t); \
+	list_reduce_wide_##suffix s0 = {0}, s1 = {0}, s2 = {0}, s3 = {0}; \
+	size_t i = 0; \
+	/*the products of 8 and 16 bit elements are too wide for vectors of their size, \
+	 *and converting them to 64 bits is slower than a loop*/ \
+	if (sizeof(ctype) < 4) { \
+		sum_t sum = 0; \
+		for (; i < size; i++) sum += (sum_t)arr[i] * arr2[i]; \
+		return sum; \
+	} \
+	for (; i + 4 * per <= size; i += 4 * per) { \
+		s0 += list_reduce_widen(suffix, arr + i) * list_reduce_widen(suffix, arr2 + i); \
+		s1 += list_reduce_widen(suffix, arr + i + per) * list_reduce_widen(suffix, arr2 + i + per); \
+		s2 += list_reduce_widen(suffix, arr + i + 2 * per) * list_reduce_widen(suffix, arr2 + i + 2 * per); \
+		s3 += list_reduce_widen(suffix, arr + i + 3 * per) * list_reduce_widen(suffix, arr2 + i + 3 * per); \
+	} \
+	for (; i + per <= size; i += per) { \
+		s0 += list_reduce_widen(suffix, arr + i) * list_reduce_widen(suffix, arr2 + i); \
+	} \
+	s0 = (s0 + s1) + (s2 + s3); \
+	sum_t sum = 0; \
+	for (size_t l = 0; l < per; l++) sum += s0[l]; \
+	for (; i < size; i++) sum += (sum_t)arr[i] * arr2[i]; \
+	return sum; \
+} \
+ \
+LIST_REDUCE_PICK(suffix, ctype, min, <) \
+LIST_REDUCE_PICK(suffix, ctype, max, >)
+
+/*Generate the min or max kernels of one element type, 'op' is < for min and > for max.
+ *The list must not be empty.*/
+#define LIST_REDUCE_PICK(suffix, ctype, name, op) \
+static inline ctype list_reduce_##name##_##suffix(const void* data, size_t size) { \
+	const ctype* arr = data; \
+	const size_t per = LIST_REDUCE_VEC / sizeof(ctype); \
+	ctype best = arr[0]; \
+	size_t i = 0; \
+	if (size >= 4 * per) { \
+		list_reduce_vec_##suffix m0 = list_reduce_load(suffix, arr); \
+		list_reduce_vec_##suffix m1 = list_reduce_load(suffix, arr + per); \
+		list_reduce_vec_##suffix m2 = list_reduce_load(suffix, arr + 2 * per); \
+		list_reduce_vec_##suffix m3 = list_reduce_load(suffix, arr + 3 * per); \
+		for (i = 4 * per; i + 4 * per <= size; i += 4 * per) { \
+			m0 = list_reduce_pick(op, m0, list_reduce_load(suffix, arr + i)); \
+			m1 = list_reduce_pick(op, m1, list_reduce_load(suffix, arr + i + per)); \
+			m2 = list_reduce_pick(op, m2, list_reduce_load(suffix, arr + i + 2 * per)); \
+			m3 = list_reduce_pick(op, m3, list_reduce_load(suffix, arr + i + 3 * per)); \
+		} \
+		m0 = list_reduce_pick(op, list_reduce_pick(op, m0, m1), \
+			list_reduce_pick(op, m2, m3)); \
+		for (size_t l = 0; l < per; l++) if (m0[l] op best) best = m0[l]; \
+	} \
+	for (; i < size; i++) if (arr[i] op best) best = arr[i]; \
+	return best; \
+} \
+ \
+static inline size_t list_reduce_arg##name##_##suffix(const void* data, size_t size) { \
+	const ctype* arr = data; \
+	ctype best = arr[0]; \
+	size_t block = 0; \
+	for (size_t start = 0; start < size; start += LIST_REDUCE_BLOCK) { \
+		size_t length = size - start < LIST_REDUCE_BLOCK ? size - start : LIST_REDUCE_BLOCK; \
+		ctype value = list_reduce_##name##_##suffix(arr + start, length); \
+		if (value op best) { \
+			best = value; \
+			block = start; \
+		} \
+	} \
+	for (size_t i = block; i < size; i++) if (arr[i] == best) return i; \
+	return block; \
+}
+
+/*Generate the compensated sums of one floating type.*/
+#define LIST_REDUCE_FLOAT_KERNELS(suffix, ctype, sum_t) \
+static inline sum_t list_reduce_sumPairwise_##suffix(const void* data, size_t size) { \
+	const ctype* arr = data; \
+	if (size <= LIST_REDUCE_PAIRWISE_BLOCK) return list_reduce_sum_##suffix(arr, size); \
+	/*split on a multiple of the block, so only the last block is partial*/ \
+	size_t half = size / 2 / LIST_REDUCE_PAIRWISE_BLOCK * LIST_REDUCE_PAIRWISE_BLOCK; \
+	if (half == 0) half = LIST_REDUCE_PAIRWISE_BLOCK; \
+	return list_reduce_sumPairwise_##suffix(arr, half) + \
+		list_reduce_sumPairwise_##suffix(arr + half, size - half); \
+} \
+ \
+static inline sum_t list_reduce_sumKahan_##suffix(const void* data, size_t size) { \
+	const ctype* arr = data; \
+	const size_t per = LIST_REDUCE_VEC / sizeof(sum_t); \
+	/*every lane is a Kahan sum, 'c' is what the lane's sum has too much*/ \
+	list_reduce_wide_##suffix s0 = {0}, s1 = {0}, c0 = {0}, c1 = {0}; \
+	size_t i = 0; \
+	for (; i + 2 * per <= size; i += 2 * per) { \
+		list_reduce_wide_##suffix y0 = list_reduce_widen(suffix, arr + i) - c0; \
+		list_reduce_wide_##suffix y1 = list_reduce_widen(suffix, arr + i + per) - c1; \
+		list_reduce_wide_##suffix t0 = s0 + y0, t1 = s1 + y1; \
+		c0 = (t0 - s0) - y0; \
+		c1 = (t1 - s1) - y1; \
+		s0 = t0; \
+		s1 = t1; \
+	} \
+	sum_t sum = 0, c = 0; \
+	for (size_t l = 0; l < 4 * per + (size - i); l++) { \
+		sum_t x = l < per ? s0[l] : l < 2 * per ? s1[l - per] : l < 3 * per ? -c0[l - 2 * per] : \
+			l < 4 * per ? -c1[l - 3 * per] : arr[i + l - 4 * per]; \
+		sum_t y = x - c, t = sum + y; \
+		c = (t - sum) - y; \
+		sum = t; \
+	} \
+	return sum; \
+}
+
+/*8 bit elements are summed in 16 bits and 16 bit elements in 32 bits, a block is the most
+ *iterations before the 4 accumulators of a lane, added together, could overflow.*/
+LIST_REDUCE_KERNELS(i8, int8_t, int16_t, 63, long long)
+LIST_REDUCE_KERNELS(u8, uint8_t, uint16_t, 63, unsigned long long)
+LIST_REDUCE_KERNELS(i16, int16_t, int32_t, 1 << 12, long long)
+LIST_REDUCE_KERNELS(u16, uint16_t, uint32_t, 1 << 12, unsigned long long)
+LIST_REDUCE_KERNELS(i32, int32_t, long long, SIZE_MAX, long long)
+LIST_REDUCE_KERNELS(u32, uint32_t, unsigned long long, SIZE_MAX, unsigned long long)
+LIST_REDUCE_KERNELS(i64, int64_t, long long, SIZE_MAX, long long)
+LIST_REDUCE_KERNELS(u64, uint64_t, unsigned long long, SIZE_MAX, unsigned long long)
+LIST_REDUCE_KERNELS(f32, float, double, SIZE_MAX, double)
+LIST_REDUCE_KERNELS(f64, double, double, SIZE_MAX, double)
+LIST_REDUCE_FLOAT_KERNELS(f32, float, double)
+LIST_REDUCE_FLOAT_KERNELS(f64, double, double)
+
+/*Call the kernel of an integer type's width and signedness, the branches are resolved at compile time.*/
+#define List_reduce_int_call(op, type, ...) \
+	if ((type)-1 < (type)0) { \
+		switch (sizeof(type)) { \
+			case 1: return list_reduce_##op##_i8(__VA_ARGS__); \
+			case 2: return list_reduce_##op##_i16(__VA_ARGS__); \
+			case 4: return list_reduce_##op##_i32(__VA_ARGS__); \
+			case 8: return list_reduce_##op##_i64(__VA_ARGS__); \
+		} \
+	} else { \
+		switch (sizeof(type)) { \
+			case 1: return list_reduce_##op##_u8(__VA_ARGS__); \
+			case 2: return list_reduce_##op##_u16(__VA_ARGS__); \
+			case 4: return list_reduce_##op##_u32(__VA_ARGS__); \
+			case 8: return list_reduce_##op##_u64(__VA_ARGS__); \
+		} \
+	}
+
+/*Call the kernel of a floating type's width, types that are neither float nor double are reduced with a loop.*/
+#define List_reduce_float_call(op, type, ...) \
+	if (sizeof(type) == sizeof(float)) { \
+		return list_reduce_##op##_f32(__VA_ARGS__); \
+	} else if (sizeof(type) == sizeof(double)) { \
+		return list_reduce_##op##_f64(__VA_ARGS__); \
+	}
+#else
+/*No vector extensions, every list is reduced with the loops that follow the calls.*/
+#define List_reduce_int_call(op, type, ...)
+#define List_reduce_float_call(op, type, ...)
+#endif
+
+/* ========================= DECLARATIONS ========================= */
+
+#define List_reduce_declare(List_name, type, sum_t) \
+/** \
+ * Returns the sum of the elements of the list. \
+ * @param list The pointer to the list. \
+ * @return The sum of the elements, 0 if the list is empty. \
+ * @note The sum is accumulated in 'sum_t', it must be big enough to hold it. \
+*/ \
+sum_t List_name##_sum(const List_name* list); \
+/** \
+ * Returns the smallest element of the list. \
+ * @param list The pointer to the list. \
+ * @return The smallest element. \
+ * @note The list must not be empty. If the list has NaN's, the result is unspecified. \
+*/ \
+type List_name##_min(const List_name* list); \
+/** \
+ * Returns the largest element of the list. \
+ * @param list The pointer to the list. \
+ * @return The largest element. \
+ * @note The list must not be empty. If the list has NaN's, the result is unspecified. \
+*/ \
+type List_name##_max(const List_name* list); \
+/** \
+ * Returns the index of the smallest element of the list, the first one if there are several. \
+ * @param list The pointer to the list. \
+ * @return The index of the smallest element, -1 if the list is empty. \
+ * @note If the list has NaN's, the result is unspecified. \
+*/ \
+ssize_t List_name##_argmin(const List_name* list); \
+/** \
+ * Returns the index of the largest element of the list, the first one if there are several. \
+ * @param list The pointer to the list. \
+ * @return The index of the largest element, -1 if the list is empty. \
+ * @note If the list has NaN's, the result is unspecified. \
+*/ \
+ssize_t List_name##_argmax(const List_name* list); \
+/** \
+ * Returns the dot product of two lists, the sum of the products of their elements. \
+ * @param list The pointer to the list. \
+ * @param other The pointer to the other list, of the same size. \
+ * @return The dot product, 0 if the lists are empty. \
+*/ \
+sum_t List_name##_dot(const List_name* list, const List_name* other);
+
+#define List_reduce_float_declare(List_name, type, sum_t) \
+/** \
+ * Returns the sum of the elements of the list, summed in pairs, the halves of the list \
+ * are summed separately and then added together. The error grows with the log of the \
+ * size of the list, instead of the size, at about the same speed as sum(). \
+ * @param list The pointer to the list. \
+ * @return The sum of the elements, 0 if the list is empty. \
+*/ \
+sum_t List_name##_sumPairwise(const List_name* list); \
+/** \
+ * Returns the sum of the elements of the list, with Kahan's compensated summation. \
+ * The error doesn't grow with the size of the list, but it's slower than sum(). \
+ * @param list The pointer to the list. \
+ * @return The sum of the elements, 0 if the list is empty. \
+*/ \
+sum_t List_name##_sumKahan(const List_name* list);
+
+#define List_reduce_parallel_declare(List_name, type, sum_t) \
+/** \
+ * Returns the sum of the elements of the list, on many threads. The list is split to even \
+ * parts, one per thread, and the sums of the parts are added in order. Floats are summed \
+ * in pairs, like sumPairwise(). \
+ * @param list The pointer to the list. \
+ * @param nthreads The amount of threads to use, 0 for one per processor. \
+ * @return The sum of the elements, 0 if the list is empty. \
+ * @note Lists shorter than LIST_REDUCE_PARALLEL_MIN are summed on the calling thread. \
+*/ \
+sum_t List_name##_parallelSum(const List_name* list, size_t nthreads); \
+/** \
+ * Returns the dot product of two lists, on many threads. \
+ * @param list The pointer to the list. \
+ * @param other The pointer to the other list, of the same size. \
+ * @param nthreads The amount of threads to use, 0 for one per processor. \
+ * @return The dot product, 0 if the lists are empty. \
+ * @note Lists shorter than LIST_REDUCE_PARALLEL_MIN are multiplied on the calling thread. \
+*/ \
+sum_t List_name##_parallelDot(const List_name* list, const List_name* other, size_t nthreads);
+
+/* ========================= DEFINITIONS ========================= */
+
+#define List_reduce_define(List_name, type, sum_t, call) \
+static inline sum_t List_name##_sumRange(const type* arr, size_t size) { \
+	call(sum, type, arr, size) \
+	sum_t sum = 0; \
+	for (size_t i = 0; i < size; i++) sum += arr[i]; \
+	return sum; \
+} \
+ \
+static inline sum_t List_name##_dotRange(const type* arr, const type* other, size_t size) { \
+	call(dot, type, arr, other, size) \
+	sum_t sum = 0; \
+	for (size_t i = 0; i < size; i++) sum += (sum_t)arr[i] * other[i]; \
+	return sum; \
+} \
+ \
+static inline void List_name##_checkSizes(const List_name* list, const List_name* other, \
+	const char* caller) { \
+	if (list->_size != other->_size) { \
+		fprintf(stderr, "Error at %s: sizes(%zu, %zu) are different\n", \
+			caller, list->_size, other->_size); \
+		exit(EXIT_FAILURE); \
+	} \
+} \
+ \
+sum_t List_name##_sum(const List_name* list) { \
+	return List_name##_sumRange(list->_arr, list->_size); \
+} \
+ \
+type List_name##_min(const List_name* list) { \
+	if (list->_size == 0) { \
+		fprintf(stderr, "Error at List_name##_min: the list is empty\n"); \
+		exit(EXIT_FAILURE); \
+	} \
+	call(min, type, list->_arr, list->_size) \
+	type best = list->_arr[0]; \
+	for (size_t i = 1; i < list->_size; i++) if (list->_arr[i] < best) best = list->_arr[i]; \
+	return best; \
+} \
+ \
+type List_name##_max(const List_name* list) { \
+	if (list->_size == 0) { \
+		fprintf(stderr, "Error at List_name##_max: the list is empty\n"); \
+		exit(EXIT_FAILURE); \
+	} \
+	call(max, type, list->_arr, list->_size) \
+	type best = list->_arr[0]; \
+	for (size_t i = 1; i < list->_size; i++) if (list->_arr[i] > best) best = list->_arr[i]; \
+	return best; \
+} \
+ \
+ssize_t List_name##_argmin(const List_name* list) { \
+	if (list->_size == 0) return -1; \
+	call(argmin, type, list->_arr, list->_size) \
+	size_t best = 0; \
+	for (size_t i = 1; i < list->_size; i++) if (list->_arr[i] < list->_arr[best]) best = i; \
+	return best; \
+} \
+ \
+ssize_t List_name##_argmax(const List_name* list) { \
+	if (list->_size == 0) return -1; \
+	call(argmax, type, list->_arr, list->_size) \
+	size_t best = 0; \
+	for (size_t i = 1; i < list->_size; i++) if (list->_arr[i] > list->_arr[best]) best = i; \
+	return best; \
+} \
+ \
+sum_t List_name##_dot(const List_name* list, const List_name* other) { \
+	List_name##_checkSizes(list, other, "List_name##_dot"); \
+	return List_name##_dotRange(list->_arr, other->_arr, list->_size); \
+}
+
+/*Integers sum their parts directly in a parallel sum.*/
+#define List_reduce_int_define(List_name, type, sum_t) \
+static inline sum_t List_name##_sumPart(const type* arr, size_t size) { \
+	return List_name##_sumRange(arr, size); \
+}
+
+#define List_reduce_float_define(List_name, type, sum_t, call) \
+static inline sum_t List_name##_pairwiseRange(const type* arr, size_t size) { \
+	call(sumPairwise, type, arr, size) \
+	if (size <= LIST_REDUCE_PAIRWISE_BLOCK) return List_name##_sumRange(arr, size); \
+	size_t half = size / 2; \
+	return List_name##_pairwiseRange(arr, half) + List_name##_pairwiseRange(arr + half, size - half); \
+} \
+ \
+/*Floats sum their parts in pairs in a parallel sum.*/ \
+static inline sum_t List_name##_sumPart(const type* arr, size_t size) { \
+	return List_name##_pairwiseRange(arr, size); \
+} \
+ \
+sum_t List_name##_sumPairwise(const List_name* list) { \
+	return List_name##_pairwiseRange(list->_arr, list->_size); \
+} \
+ \
+sum_t List_name##_sumKahan(const List_name* list) { \
+	call(sumKahan, type, list->_arr, list->_size) \
+	sum_t sum = 0, c = 0; \
+	for (size_t i = 0; i < list->_size; i++) { \
+		sum_t y = list->_arr[i] - c, t = sum + y; \
+		c = (t - sum) - y; \
+		sum = t; \
+	} \
+	return sum; \
+}
+
+#define List_reduce_parallel_define(List_name, type, sum_t) \
+/*The state shared by the threads of a parallel reduce.*/ \
+typedef struct List_name##_reduce_parallel_t { \
+	const type* arr; \
+	/*The other list of a dot product, NULL for a sum.*/ \
+	const type* other; \
+	size_t size; \
+	/*The result of every thread, each on it's own cache line.*/ \
+	struct { _Alignas(LIST_REDUCE_ALIGN) sum_t value; } results[DS_PARALLEL_MAX_THREADS]; \
+} List_name##_reduce_parallel_t; \
+ \
+/*Reduce the part of one thread.*/ \
+static void List_name##_reduce_parallel_task(size_t thread, size_t nthreads, void* context) { \
+	List_name##_reduce_parallel_t* par = context; \
+	size_t start = (uint64_t)par->size * thread / nthreads; \
+	size_t end = (uint64_t)par->size * (thread + 1) / nthreads; \
+	par->results[thread].value = par->other == NULL ? \
+		List_name##_sumPart(par->arr + start, end - start) : \
+		List_name##_dotRange(par->arr + start, par->other + start, end - start); \
+} \
+ \
+static sum_t List_name##_reduce_parallel(const type* arr, const type* other, size_t size, \
+	size_t nthreads) { \
+	nthreads = size < LIST_REDUCE_PARALLEL_MIN ? 1 : ds_parallel_threads(nthreads); \
+	List_name##_reduce_parallel_t par = { .arr = arr, .other = other, .size = size }; \
+	ds_parallel_run(nthreads, List_name##_reduce_parallel_task, &par); \
+	sum_t sum = 0; \
+	for (size_t thread = 0; thread < nthreads; thread++) sum += par.results[thread].value; \
+	return sum; \
+} \
+ \
+sum_t List_name##_parallelSum(const List_name* list, size_t nthreads) { \
+	return List_name##_reduce_parallel(list->_arr, NULL, list->_size, nthreads); \
+} \
+ \
+sum_t List_name##_parallelDot(const List_name* list, const List_name* other, size_t nthreads) { \
+	List_name##_checkSizes(list, other, "List_name##_parallelDot"); \
+	return List_name##_reduce_parallel(list->_arr, other->_arr, list->_size, nthreads); \
+}
+
+/* ========================= ALL ========================= */
+
+/**
+ * Generate sum, min, max, argmin, argmax and dot for a list of an integer type.
+ * @param type The type of the elements, an integer type of 1, 2, 4 or 8 bytes.
+ * @param List_name The name of the list, generated with STRUCT_LIST.
+ * @param sum_t The type that sums and dot products are accumulated in and returned as.
+*/
+#define LIST_REDUCE_INT(type, List_name, sum_t) \
+List_reduce_declare(List_name, type, sum_t) \
+List_reduce_define(List_name, type, sum_t, List_reduce_int_call) \
+List_reduce_int_define(List_name, type, sum_t)
+
+/**
+ * Generate sum, sumPairwise, sumKahan, min, max, argmin, argmax and dot for a list of a floating type.
+ * @param type The type of the elements, float and double are vectorized.
+ * @param List_name The name of the list, generated with STRUCT_LIST.
+ * @param sum_t The type that sums and dot products are accumulated in and returned as,
+ * float and double lists are accumulated in doubles before they're converted to it.
+*/
+#define LIST_REDUCE_FLOAT(type, List_name, sum_t) \
+List_reduce_declare(List_name, type, sum_t) \
+List_reduce_float_declare(List_name, type, sum_t) \
+List_reduce_define(List_name, type, sum_t, List_reduce_float_call) \
+List_reduce_float_define(List_name, type, sum_t, List_reduce_float_call)
+
+/**
+ * Generate parallelSum and parallelDot for a list.
+ * @param type The type of the elements.
+ * @param List_name The name of the list, generated with STRUCT_LIST.
+ * @param sum_t The type that sums and dot products are accumulated in, as given to LIST_REDUCE_INT or LIST_REDUCE_FLOAT.
+ * @note Must come after the LIST_REDUCE_INT or LIST_REDUCE_FLOAT of the same list.
+ * The program must be linked with parallel.c and pthreads.
+*/
+#define LIST_REDUCE_PARALLEL(type, List_name, sum_t) \
+List_reduce_parallel_declare(List_name, type, sum_t) \
+List_reduce_parallel_define(List_name, type, sum_t)
+
+#endif
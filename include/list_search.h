@@ -0,0 +1,289 @@
+#ifndef __LIST_SEARCH_H__
+#define __LIST_SEARCH_H__
+
+#include<stdint.h>
+#include<sys/types.h>
+#include "list.h"
+
+/*Search kernels for arrays of numbers, specialized per element width.
+ *With AVX2 or SSE2 enabled at compile time(-mavx2, -march=native, SSE2 is always on for x86-64)
+ *they compare a whole vector of elements at once, 4 vectors per iteration, and find the
+ *matches from the compare's byte mask. Without them they're plain loops.
+ *Integers are compared by their bits, floats and doubles by value, like ==,
+ *so 0.0 matches -0.0 and NaN matches nothing.*/
+
+#if defined(__AVX2__)
+#include<immintrin.h>
+#define LIST_SEARCH_VEC 32
+typedef __m256i list_search_vec_t;
+#define list_search_load(p) _mm256_loadu_si256((const __m256i*)(p))
+#define list_search_or(a, b) _mm256_or_si256(a, b)
+#define list_search_mask(v) ((uint32_t)_mm256_movemask_epi8(v))
+#define list_search_zero() _mm256_setzero_si256()
+#define list_search_sub_u8(a, b) _mm256_sub_epi8(a, b)
+#define list_search_sub_u16(a, b) _mm256_sub_epi16(a, b)
+#define list_search_sub_u32(a, b) _mm256_sub_epi32(a, b)
+#define list_search_sub_u64(a, b) _mm256_sub_epi64(a, b)
+#define list_search_sub_f32(a, b) _mm256_sub_epi32(a, b)
+#define list_search_sub_f64(a, b) _mm256_sub_epi64(a, b)
+#define list_search_splat_u8(x) _mm256_set1_epi8((char)(x))
+#define list_search_splat_u16(x) _mm256_set1_epi16((short)(x))
+#define list_search_splat_u32(x) _mm256_set1_epi32((int)(x))
+#define list_search_splat_u64(x) _mm256_set1_epi64x((long long)(x))
+#define list_search_splat_f32(x) _mm256_castps_si256(_mm256_set1_ps(x))
+#define list_search_splat_f64(x) _mm256_castpd_si256(_mm256_set1_pd(x))
+#define list_search_cmpeq_u8(a, b) _mm256_cmpeq_epi8(a, b)
+#define list_search_cmpeq_u16(a, b) _mm256_cmpeq_epi16(a, b)
+#define list_search_cmpeq_u32(a, b) _mm256_cmpeq_epi32(a, b)
+#define list_search_cmpeq_u64(a, b) _mm256_cmpeq_epi64(a, b)
+#define list_search_cmpeq_f32(a, b) _mm256_castps_si256(_mm256_cmp_ps( \
+	_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ))
+#define list_search_cmpeq_f64(a, b) _mm256_castpd_si256(_mm256_cmp_pd( \
+	_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ))
+#elif defined(__SSE2__)
+#include<emmintrin.h>
+#define LIST_SEARCH_VEC 16
+typedef __m128i list_search_vec_t;
+#define list_search_load(p) _mm_loadu_si128((const __m128i*)(p))
+#define list_search_or(a, b) _mm_or_si128(a, b)
+#define list_search_mask(v) ((uint32_t)_mm_movemask_epi8(v))
+#define list_search_zero() _mm_setzero_si128()
+#define list_search_sub_u8(a, b) _mm_sub_epi8(a, b)
+#define list_search_sub_u16(a, b) _mm_sub_epi16(a, b)
+#define list_search_sub_u32(a, b) _mm_sub_epi32(a, b)
+#define list_search_sub_u64(a, b) _mm_sub_epi64(a, b)
+#define list_search_sub_f32(a, b) _mm_sub_epi32(a, b)
+#define list_search_sub_f64(a, b) _mm_sub_epi64(a, b)
+#define list_search_splat_u8(x) _mm_set1_epi8((char)(x))
+#define list_search_splat_u16(x) _mm_set1_epi16((short)(x))
+#define list_search_splat_u32(x) _mm_set1_epi32((int)(x))
+#define list_search_splat_u64(x) _mm_set1_epi64x((long long)(x))
+#define list_search_splat_f32(x) _mm_castps_si128(_mm_set1_ps(x))
+#define list_search_splat_f64(x) _mm_castpd_si128(_mm_set1_pd(x))
+#define list_search_cmpeq_u8(a, b) _mm_cmpeq_epi8(a, b)
+#define list_search_cmpeq_u16(a, b) _mm_cmpeq_epi16(a, b)
+#define list_search_cmpeq_u32(a, b) _mm_cmpeq_epi32(a, b)
+/*SSE2 has no 64 bit compare, both 32 bit halves have to be equal.*/
+#define list_search_cmpeq_u64(a, b) list_search_cmpeq64(a, b)
+static inline __m128i list_search_cmpeq64(__m128i a, __m128i b) {
+	__m128i halves = _mm_cmpeq_epi32(a, b);
+	return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+#define list_search_cmpeq_f32(a, b) _mm_castps_si128(_mm_cmpeq_ps( \
+	_mm_castsi128_ps(a), _mm_castsi128_ps(b)))
+#define list_search_cmpeq_f64(a, b) _mm_castpd_si128(_mm_cmpeq_pd( \
+	_mm_castsi128_pd(a), _mm_castsi128_pd(b)))
+#endif
+
+/*The index of the lowest set bit of a non zero mask.*/
+static inline unsigned list_search_lowest(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctz(mask);
+#else
+	unsigned index = 0;
+	while (!(mask & 1)) { mask >>= 1; index++; }
+	return index;
+#endif
+}
+
+/*The index of the highest set bit of a non zero mask.*/
+static inline unsigned list_search_highest(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+	return 31 - __builtin_clz(mask);
+#else
+	unsigned index = 0;
+	while (mask >>= 1) index++;
+	return index;
+#endif
+}
+
+#ifdef LIST_SEARCH_VEC
+/*Generate the vector kernels of one element width. Every match sets sizeof(ctype) bits of a mask,
+ *and all the bits of it's lane in a compare, -1 in the lane's unsigned type 'lane_t'.*/
+#define LIST_SEARCH_KERNELS(suffix, ctype, lane_t) \
+static inline ssize_t list_search_find_##suffix(const ctype* arr, size_t size, ctype value) { \
+	const size_t per = LIST_SEARCH_VEC / sizeof(ctype); \
+	list_search_vec_t needle = list_search_splat_##suffix(value); \
+	size_t i = 0; \
+	/*4 vectors at a time until one has a match, then find it vector by vector*/ \
+	for (; i + 4 * per <= size; i += 4 * per) { \
+		list_search_vec_t m0 = list_search_cmpeq_##suffix(list_search_load(arr + i), needle); \
+		list_search_vec_t m1 = list_search_cmpeq_##suffix(list_search_load(arr + i + per), needle); \
+		list_search_vec_t m2 = list_search_cmpeq_##suffix(list_search_load(arr + i + 2 * per), needle); \
+		list_search_vec_t m3 = list_search_cmpeq_##suffix(list_search_load(arr + i + 3 * per), needle); \
+		if (list_search_mask(list_search_or(list_search_or(m0, m1), list_search_or(m2, m3)))) break; \
+	} \
+	for (; i + per <= size; i += per) { \
+		uint32_t mask = list_search_mask(list_search_cmpeq_##suffix(list_search_load(arr + i), needle)); \
+		if (mask) return i + list_search_lowest(mask) / sizeof(ctype); \
+	} \
+	for (; i < size; i++) if (arr[i] == value) return i; \
+	return -1; \
+} \
+ \
+static inline ssize_t list_search_rfind_##suffix(const ctype* arr, size_t size, ctype value) { \
+	const size_t per = LIST_SEARCH_VEC / sizeof(ctype); \
+	list_search_vec_t needle = list_search_splat_##suffix(value); \
+	size_t i = size; \
+	/*the elements past the last whole vector first*/ \
+	while (i % per) { \
+		i--; \
+		if (arr[i] == value) return i; \
+	} \
+	for (; i >= 4 * per; i -= 4 * per) { \
+		list_search_vec_t m0 = list_search_cmpeq_##suffix(list_search_load(arr + i - per), needle); \
+		list_search_vec_t m1 = list_search_cmpeq_##suffix(list_search_load(arr + i - 2 * per), needle); \
+		list_search_vec_t m2 = list_search_cmpeq_##suffix(list_search_load(arr + i - 3 * per), needle); \
+		list_search_vec_t m3 = list_search_cmpeq_##suffix(list_search_load(arr + i - 4 * per), needle); \
+		if (list_search_mask(list_search_or(list_search_or(m0, m1), list_search_or(m2, m3)))) break; \
+	} \
+	for (; i >= per; i -= per) { \
+		uint32_t mask = list_search_mask(list_search_cmpeq_##suffix(list_search_load(arr + i - per), needle)); \
+		if (mask) return i - per + list_search_highest(mask) / sizeof(ctype); \
+	} \
+	return -1; \
+} \
+ \
+static inline size_t list_search_count_##suffix(const ctype* arr, size_t size, ctype value) { \
+	const size_t per = LIST_SEARCH_VEC / sizeof(ctype); \
+	/*the most vectors a lane can count before it overflows*/ \
+	const size_t block = (lane_t)-1 < (size_t)-1 ? (lane_t)-1 : (size_t)-1; \
+	list_search_vec_t needle = list_search_splat_##suffix(value); \
+	size_t count = 0, i = 0; \
+	while (i + per <= size) { \
+		/*count the matches of every lane, subtracting the -1 of the compare*/ \
+		list_search_vec_t counts = list_search_zero(); \
+		size_t vectors = (size - i) / per; \
+		if (vectors > block) vectors = block; \
+		for (size_t v = 0; v < vectors; v++, i += per) { \
+			counts = list_search_sub_##suffix(counts, \
+				list_search_cmpeq_##suffix(list_search_load(arr + i), needle)); \
+		} \
+		lane_t lanes[LIST_SEARCH_VEC / sizeof(lane_t)]; \
+		memcpy(lanes, &counts, sizeof(lanes)); \
+		for (size_t l = 0; l < per; l++) count += lanes[l]; \
+	} \
+	for (; i < size; i++) count += arr[i] == value; \
+	return count; \
+}
+#else
+/*No vectors, plain loops.*/
+#define LIST_SEARCH_KERNELS(suffix, ctype, lane_t) \
+static inline ssize_t list_search_find_##suffix(const ctype* arr, size_t size, ctype value) { \
+	for (size_t i = 0; i < size; i++) if (arr[i] == value) return i; \
+	return -1; \
+} \
+static inline ssize_t list_search_rfind_##suffix(const ctype* arr, size_t size, ctype value) { \
+	for (size_t i = size; i-- > 0;) if (arr[i] == value) return i; \
+	return -1; \
+} \
+static inline size_t list_search_count_##suffix(const ctype* arr, size_t size, ctype value) { \
+	size_t count = 0; \
+	for (size_t i = 0; i < size; i++) count += arr[i] == value; \
+	return count; \
+}
+#endif
+
+LIST_SEARCH_KERNELS(u8, uint8_t, uint8_t)
+LIST_SEARCH_KERNELS(u16, uint16_t, uint16_t)
+LIST_SEARCH_KERNELS(u32, uint32_t, uint32_t)
+LIST_SEARCH_KERNELS(u64, uint64_t, uint64_t)
+LIST_SEARCH_KERNELS(f32, float, uint32_t)
+LIST_SEARCH_KERNELS(f64, double, uint64_t)
+
+/* ========================= DECLARATIONS ========================= */
+
+#define List_search_declare(List_name, type) \
+/** \
+ * Returns the index of the first element equal to a given element. \
+ * @param list The pointer to the list. \
+ * @param element The element to search for. \
+ * @return The index of the first match, -1 if there is none. \
+*/ \
+ssize_t List_name##_indexOf(const List_name* list, type element); \
+/** \
+ * Returns the index of the last element equal to a given element. \
+ * @param list The pointer to the list. \
+ * @param element The element to search for. \
+ * @return The index of the last match, -1 if there is none. \
+*/ \
+ssize_t List_name##_lastIndexOf(const List_name* list, type element); \
+/** \
+ * Checks if the list has an element equal to a given element. \
+ * @param list The pointer to the list. \
+ * @param element The element to search for. \
+ * @return 1 if the list contains the element, 0 otherwise. \
+*/ \
+int List_name##_contains(const List_name* list, type element); \
+/** \
+ * Counts the elements equal to a given element. \
+ * @param list The pointer to the list. \
+ * @param element The element to count. \
+ * @return The amount of matches. \
+*/ \
+size_t List_name##_count(const List_name* list, type element);
+
+/* ========================= DEFINITIONS ========================= */
+
+/*Call the kernel of an integer type's width, the switch is resolved at compile time.*/
+#define List_search_int_call(op, type, list, element) \
+	switch (sizeof(type)) { \
+		case 1: return list_search_##op##_u8((const uint8_t*)(list)->_arr, (list)->_size, (uint8_t)(element)); \
+		case 2: return list_search_##op##_u16((const uint16_t*)(list)->_arr, (list)->_size, (uint16_t)(element)); \
+		case 4: return list_search_##op##_u32((const uint32_t*)(list)->_arr, (list)->_size, (uint32_t)(element)); \
+		default: return list_search_##op##_u64((const uint64_t*)(list)->_arr, (list)->_size, (uint64_t)(element)); \
+	}
+
+/*Call the kernel of a floating type's width, types that are neither float nor double are searched with a loop.*/
+#define List_search_float_call(op, type, list, element) \
+	if (sizeof(type) == sizeof(float)) { \
+		return list_search_##op##_f32((const float*)(list)->_arr, (list)->_size, (float)(element)); \
+	} else if (sizeof(type) == sizeof(double)) { \
+		return list_search_##op##_f64((const double*)(list)->_arr, (list)->_size, (double)(element)); \
+	}
+
+#define List_search_define(List_name, type, call) \
+ssize_t List_name##_indexOf(const List_name* list, type element) { \
+	call(find, type, list, element) \
+	for (size_t i = 0; i < list->_size; i++) if (list->_arr[i] == element) return i; \
+	return -1; \
+} \
+ \
+ssize_t List_name##_lastIndexOf(const List_name* list, type element) { \
+	call(rfind, type, list, element) \
+	for (size_t i = list->_size; i-- > 0;) if (list->_arr[i] == element) return i; \
+	return -1; \
+} \
+ \
+int List_name##_contains(const List_name* list, type element) { \
+	return List_name##_indexOf(list, element) != -1; \
+} \
+ \
+size_t List_name##_count(const List_name* list, type element) { \
+	call(count, type, list, element) \
+	size_t count = 0; \
+	for (size_t i = 0; i < list->_size; i++) count += list->_arr[i] == element; \
+	return count; \
+}
+
+/* ========================= ALL ========================= */
+
+/**
+ * Generate indexOf, lastIndexOf, contains and count for a list of an integer type.
+ * @param type The type of the elements, an integer type of 1, 2, 4 or 8 bytes.
+ * @param List_name The name of the list, generated with STRUCT_LIST.
+*/
+#define LIST_SEARCH_INT(type, List_name) \
+List_search_declare(List_name, type) \
+List_search_define(List_name, type, List_search_int_call)
+
+/**
+ * Generate indexOf, lastIndexOf, contains and count for a list of a floating type.
+ * @param type The type of the elements, float and double are vectorized.
+ * @param List_name The name of the list, generated with STRUCT_LIST.
+*/
+#define LIST_SEARCH_FLOAT(type, List_name) \
+List_search_declare(List_name, type) \
+List_search_define(List_name, type, List_search_float_call)
+
+#endif
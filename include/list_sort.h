@@ -0,0 +1,354 @@
+#ifndef __LIST_SORT_H__
+#define __LIST_SORT_H__
+
+#include<stdint.h>
+#include "list.h"
+#include "parallel.h"
+
+/*Sorts for lists. sort() is an introsort with the comparator inlined: a quicksort with a
+ *median of 3 pivot(a median of 3 medians on long ranges), that turns to heapsort when it
+ *recurses too deep, and to insertion sort on short ranges. radixSort() is an LSD radix sort
+ *for integers and floats, a byte per pass, and parallelSort() sorts a part of the list per
+ *thread and merges the parts on all the threads.*/
+
+/**Ranges of at most this many elements are sorted with insertion sort.*/
+#define LIST_SORT_INSERTION 16
+/**Ranges of more than this many elements take the median of 3 medians of 3 as the pivot.*/
+#define LIST_SORT_NINTHER 128
+/**Below this amount of elements a list is sorted on a single thread.*/
+#define LIST_SORT_PARALLEL_MIN 1048576
+
+/* ========================= DECLARATIONS ========================= */
+
+#define List_sort_declare(List_name) \
+/** \
+ * Sorts the list in place, in the order of the comparator the sort was generated with. \
+ * The sort isn't stable, equal elements may change their order. \
+ * @param list The pointer to the list. \
+*/ \
+void List_name##_sort(List_name* list);
+
+#define List_radixSort_declare(List_name) \
+/** \
+ * Sorts the list in place from the smallest to the largest element, with a radix sort. \
+ * Takes a pass over the list per byte of the elements, bytes that are the same in all the \
+ * elements are skipped, and a temporary copy of the list. \
+ * @param list The pointer to the list. \
+ * @note Floats are sorted by value, -0.0 before 0.0, NaN's with the sign bit set first \
+ * and the rest of the NaN's last. \
+*/ \
+void List_name##_radixSort(List_name* list);
+
+#define List_parallelSort_declare(List_name) \
+/** \
+ * Sorts the list in place on many threads, like sort(). Every thread sorts an even part \
+ * of the list, and then the parts are merged in pairs, every merge split between the threads. \
+ * @param list The pointer to the list. \
+ * @param nthreads The amount of threads to use, 0 for one per processor. \
+ * @note Lists shorter than LIST_SORT_PARALLEL_MIN are sorted on the calling thread. \
+ * The sort isn't stable, and needs a temporary copy of the list. \
+*/ \
+void List_name##_parallelSort(List_name* list, size_t nthreads);
+
+/* ========================= DEFINITIONS ========================= */
+
+#define List_sort_define(List_name, type, less) \
+static inline void List_name##_insertionSort(type* arr, size_t size) { \
+	for (size_t i = 1; i < size; i++) { \
+		type element = arr[i]; \
+		size_t j = i; \
+		for (; j > 0 && less(element, arr[j - 1]); j--) arr[j] = arr[j - 1]; \
+		arr[j] = element; \
+	} \
+} \
+ \
+static inline void List_name##_siftDown(type* arr, size_t root, size_t size) { \
+	type element = arr[root]; \
+	for (size_t child; (child = 2 * root + 1) < size; root = child) { \
+		if (child + 1 < size && less(arr[child], arr[child + 1])) child++; \
+		if (!less(element, arr[child])) break; \
+		arr[root] = arr[child]; \
+	} \
+	arr[root] = element; \
+} \
+ \
+static void List_name##_heapSort(type* arr, size_t size) { \
+	for (size_t i = size / 2; i-- > 0;) List_name##_siftDown(arr, i, size); \
+	for (size_t end = size; end-- > 1;) { \
+		type max = arr[0]; \
+		arr[0] = arr[end]; \
+		arr[end] = max; \
+		List_name##_siftDown(arr, 0, end); \
+	} \
+} \
+ \
+/*The index of the median of 3 elements.*/ \
+static inline size_t List_name##_median3(const type* arr, size_t a, size_t b, size_t c) { \
+	if (less(arr[a], arr[b])) { \
+		return less(arr[b], arr[c]) ? b : less(arr[a], arr[c]) ? c : a; \
+	} \
+	return less(arr[a], arr[c]) ? a : less(arr[b], arr[c]) ? c : b; \
+} \
+ \
+static void List_name##_introSort(type* arr, size_t size, size_t depth) { \
+	while (size > LIST_SORT_INSERTION) { \
+		if (depth-- == 0) { \
+			List_name##_heapSort(arr, size); \
+			return; \
+		} \
+		size_t mid = size / 2, pivot; \
+		if (size > LIST_SORT_NINTHER) { \
+			size_t step = size / 8; \
+			pivot = List_name##_median3(arr, \
+				List_name##_median3(arr, 0, step, 2 * step), \
+				List_name##_median3(arr, mid - step, mid, mid + step), \
+				List_name##_median3(arr, size - 1 - 2 * step, size - 1 - step, size - 1)); \
+		} else { \
+			pivot = List_name##_median3(arr, 0, mid, size - 1); \
+		} \
+		type tmp = arr[0]; \
+		arr[0] = arr[pivot]; \
+		arr[pivot] = tmp; \
+ \
+		/*Hoare's partition around arr[0], elements equal to the pivot stop both sides, \
+		 *so they're split evenly. 'j' can't pass arr[0], the pivot isn't less than itself.*/ \
+		size_t i = 0, j = size; \
+		for (;;) { \
+			do i++; while (i < size && less(arr[i], arr[0])); \
+			do j--; while (less(arr[0], arr[j])); \
+			if (i >= j) break; \
+			tmp = arr[i]; \
+			arr[i] = arr[j]; \
+			arr[j] = tmp; \
+		} \
+		tmp = arr[0]; \
+		arr[0] = arr[j]; \
+		arr[j] = tmp; \
+ \
+		/*recurse into the shorter side, so the stack stays logarithmic*/ \
+		if (j < size - j - 1) { \
+			List_name##_introSort(arr, j, depth); \
+			arr += j + 1; \
+			size -= j + 1; \
+		} else { \
+			List_name##_introSort(arr + j + 1, size - j - 1, depth); \
+			size = j; \
+		} \
+	} \
+	List_name##_insertionSort(arr, size); \
+} \
+ \
+static inline void List_name##_sortRange(type* arr, size_t size) { \
+	size_t depth = 0; \
+	for (size_t s = size; s > 1; s >>= 1) depth += 2; \
+	List_name##_introSort(arr, size, depth); \
+} \
+ \
+void List_name##_sort(List_name* list) { \
+	List_name##_sortRange(list->_arr, list->_size); \
+}
+
+/*The order of the keys of a radix sort, the bits of an element are made into an unsigned key.*/
+#define LIST_RADIX_UNSIGNED 0
+#define LIST_RADIX_SIGNED 1
+#define LIST_RADIX_FLOAT 2
+
+/*Generate the radix sort of one element width, on the bytes of the elements.*/
+#define LIST_RADIX_KERNEL(suffix, utype) \
+static inline utype list_radix_key_##suffix(utype bits, int kind) { \
+	const utype sign = (utype)1 << (sizeof(utype) * 8 - 1); \
+	/*negative floats are in the reverse order of their bits*/ \
+	if (kind == LIST_RADIX_FLOAT) return (bits & sign) ? ~bits : bits | sign; \
+	return kind == LIST_RADIX_SIGNED ? bits ^ sign : bits; \
+} \
+ \
+static inline void list_radix_sort_##suffix(void* data, size_t size, int kind, const char* caller) { \
+	size_t counts[sizeof(utype)][256] = {{0}}; \
+	unsigned char* arr = data; \
+	for (size_t i = 0; i < size; i++) { \
+		utype bits; \
+		memcpy(&bits, arr + i * sizeof(utype), sizeof(utype)); \
+		utype key = list_radix_key_##suffix(bits, kind); \
+		for (size_t d = 0; d < sizeof(utype); d++) counts[d][(key >> (8 * d)) & 0xff]++; \
+	} \
+	unsigned char* tmp = NULL, * src = arr, * dst = NULL; \
+	for (size_t d = 0; d < sizeof(utype); d++) { \
+		/*a byte that's the same in all the elements doesn't change the order*/ \
+		utype first; \
+		memcpy(&first, arr, sizeof(utype)); \
+		if (counts[d][(list_radix_key_##suffix(first, kind) >> (8 * d)) & 0xff] == size) continue; \
+		if (tmp == NULL) { \
+			tmp = DS_MALLOC(size * sizeof(utype)); \
+			if (tmp == NULL) { \
+				fprintf(stderr, "Error at %s: malloc returned NULL\n", caller); \
+				exit(EXIT_FAILURE); \
+			} \
+			dst = tmp; \
+		} \
+		size_t offsets[256], offset = 0; \
+		for (size_t b = 0; b < 256; b++) { \
+			offsets[b] = offset; \
+			offset += counts[d][b]; \
+		} \
+		for (size_t i = 0; i < size; i++) { \
+			utype bits; \
+			memcpy(&bits, src + i * sizeof(utype), sizeof(utype)); \
+			size_t byte = (list_radix_key_##suffix(bits, kind) >> (8 * d)) & 0xff; \
+			memcpy(dst + offsets[byte]++ * sizeof(utype), &bits, sizeof(utype)); \
+		} \
+		unsigned char* swap = src; \
+		src = dst; \
+		dst = swap; \
+	} \
+	if (src != arr) memcpy(arr, src, size * sizeof(utype)); \
+	DS_FREE(tmp); \
+}
+
+LIST_RADIX_KERNEL(u8, uint8_t)
+LIST_RADIX_KERNEL(u16, uint16_t)
+LIST_RADIX_KERNEL(u32, uint32_t)
+LIST_RADIX_KERNEL(u64, uint64_t)
+
+#define List_radixSort_define(List_name, type, kind) \
+_Static_assert(sizeof(type) == 1 || sizeof(type) == 2 || sizeof(type) == 4 || sizeof(type) == 8, \
+	"radixSort needs elements of 1, 2, 4 or 8 bytes"); \
+void List_name##_radixSort(List_name* list) { \
+	if (list->_size < 2) return; \
+	switch (sizeof(type)) { \
+		case 1: list_radix_sort_u8(list->_arr, list->_size, kind, "List_name##_radixSort"); break; \
+		case 2: list_radix_sort_u16(list->_arr, list->_size, kind, "List_name##_radixSort"); break; \
+		case 4: list_radix_sort_u32(list->_arr, list->_size, kind, "List_name##_radixSort"); break; \
+		case 8: list_radix_sort_u64(list->_arr, list->_size, kind, "List_name##_radixSort"); break; \
+	} \
+}
+
+#define List_parallelSort_define(List_name, type, less) \
+/*The state shared by the threads of a parallel sort.*/ \
+typedef struct List_name##_sort_parallel_t { \
+	type* src; \
+	type* dst; \
+	/*The bounds of the sorted runs, run 'r' is [bounds[r], bounds[r + 1]).*/ \
+	size_t bounds[DS_PARALLEL_MAX_THREADS + 1]; \
+	size_t runs; \
+} List_name##_sort_parallel_t; \
+ \
+/*Sort the part of one thread, the runs are the parts.*/ \
+static void List_name##_sort_parallel_task(size_t thread, size_t nthreads, void* context) { \
+	List_name##_sort_parallel_t* par = context; \
+	List_name##_sortRange(par->src + par->bounds[thread], \
+		par->bounds[thread + 1] - par->bounds[thread]); \
+} \
+ \
+/*The amount of elements of 'a' among the first 'k' elements of the merge of 'a' and 'b', \
+ *the elements of 'a' go first when they're equal.*/ \
+static inline size_t List_name##_corank(const type* a, size_t la, const type* b, size_t lb, size_t k) { \
+	size_t lo = k > lb ? k - lb : 0, hi = k < la ? k : la; \
+	while (lo < hi) { \
+		size_t mid = lo + (hi - lo) / 2; \
+		if (less(b[k - mid - 1], a[mid])) hi = mid; \
+		else lo = mid + 1; \
+	} \
+	return lo; \
+} \
+ \
+/*Merge pairs of runs from 'src' to 'dst'. The output of a pair is split to even pieces, \
+ *a thread per piece, the start and end of a piece in each run are found by binary search.*/ \
+static void List_name##_merge_parallel_task(size_t thread, size_t nthreads, void* context) { \
+	List_name##_sort_parallel_t* par = context; \
+	size_t pairs = (par->runs + 1) / 2; \
+	size_t pieces = nthreads / pairs ? nthreads / pairs : 1; \
+	for (size_t job = thread; job < pairs * pieces; job += nthreads) { \
+		size_t pair = job / pieces, piece = job % pieces; \
+		size_t start = par->bounds[2 * pair], mid = par->bounds[2 * pair + 1]; \
+		size_t end = 2 * pair + 2 <= par->runs ? par->bounds[2 * pair + 2] : mid; \
+		const type* a = par->src + start, * b = par->src + mid; \
+		size_t la = mid - start, lb = end - mid; \
+		size_t k0 = (uint64_t)(la + lb) * piece / pieces; \
+		size_t k1 = (uint64_t)(la + lb) * (piece + 1) / pieces; \
+		size_t i = List_name##_corank(a, la, b, lb, k0), j = k0 - i; \
+		size_t i1 = List_name##_corank(a, la, b, lb, k1), j1 = k1 - i1; \
+		type* out = par->dst + start + k0; \
+		while (i < i1 && j < j1) *out++ = less(b[j], a[i]) ? b[j++] : a[i++]; \
+		while (i < i1) *out++ = a[i++]; \
+		while (j < j1) *out++ = b[j++]; \
+	} \
+} \
+ \
+void List_name##_parallelSort(List_name* list, size_t nthreads) { \
+	nthreads = list->_size < LIST_SORT_PARALLEL_MIN ? 1 : ds_parallel_threads(nthreads); \
+	if (nthreads == 1) { \
+		List_name##_sortRange(list->_arr, list->_size); \
+		return; \
+	} \
+	List_name##_sort_parallel_t par = { .src = list->_arr, .runs = nthreads }; \
+	par.dst = DS_MALLOC(list->_size * sizeof(type)); \
+	if (par.dst == NULL) { \
+		fprintf(stderr, "Error at List_name##_parallelSort: malloc returned NULL\n"); \
+		exit(EXIT_FAILURE); \
+	} \
+	for (size_t r = 0; r <= nthreads; r++) par.bounds[r] = (uint64_t)list->_size * r / nthreads; \
+	ds_parallel_run(nthreads, List_name##_sort_parallel_task, &par); \
+	while (par.runs > 1) { \
+		ds_parallel_run(nthreads, List_name##_merge_parallel_task, &par); \
+		/*every pair is a run now*/ \
+		size_t runs = (par.runs + 1) / 2; \
+		for (size_t r = 1; r <= runs; r++) { \
+			par.bounds[r] = 2 * r <= par.runs ? par.bounds[2 * r] : par.bounds[par.runs]; \
+		} \
+		par.runs = runs; \
+		type* swap = par.src; \
+		par.src = par.dst; \
+		par.dst = swap; \
+	} \
+	if (par.src != list->_arr) { \
+		memcpy(list->_arr, par.src, list->_size * sizeof(type)); \
+		par.dst = par.src; \
+	} \
+	DS_FREE(par.dst); \
+}
+
+/* ========================= ALL ========================= */
+
+/**
+ * Generate sort for a list.
+ * @param type The type of the elements.
+ * @param List_name The name of the list, generated with STRUCT_LIST.
+ * @param less The comparator, a macro or function that's given two elements and is true if the
+ * first goes before the second, like LIST_LESS. It must be a strict weak order, and it's
+ * inlined into the sort.
+*/
+#define LIST_SORT(type, List_name, less) \
+List_sort_declare(List_name) \
+List_sort_define(List_name, type, less)
+
+/**
+ * Generate radixSort for a list of an integer type.
+ * @param type The type of the elements, an integer type of 1, 2, 4 or 8 bytes.
+ * @param List_name The name of the list, generated with STRUCT_LIST.
+*/
+#define LIST_RADIX_SORT_INT(type, List_name) \
+List_radixSort_declare(List_name) \
+List_radixSort_define(List_name, type, ((type)-1 < (type)0 ? LIST_RADIX_SIGNED : LIST_RADIX_UNSIGNED))
+
+/**
+ * Generate radixSort for a list of float or double.
+ * @param type The type of the elements, float or double.
+ * @param List_name The name of the list, generated with STRUCT_LIST.
+*/
+#define LIST_RADIX_SORT_FLOAT(type, List_name) \
+List_radixSort_declare(List_name) \
+List_radixSort_define(List_name, type, LIST_RADIX_FLOAT)
+
+/**
+ * Generate parallelSort for a list.
+ * @param type The type of the elements.
+ * @param List_name The name of the list, generated with STRUCT_LIST.
+ * @param less The comparator, as given to LIST_SORT.
+ * @note Must come after the LIST_SORT of the same list.
+ * The program must be linked with parallel.c and pthreads.
+*/
+#define LIST_SORT_PARALLEL(type, List_name, less) \
+List_parallelSort_declare(List_name) \
+List_parallelSort_define(List_name, type, less)
+
+#endif
@@ -0,0 +1,445 @@
+#ifndef __LIST_SORTED_H__
+#define __LIST_SORTED_H__
+
+#include<stdint.h>
+#include<sys/types.h>
+#include "list.h"
+
+/*Operations on lists that are sorted in the order of a comparator, like after sort().
+ *The binary searches are branchless, the half of the range is picked with a conditional
+ *move instead of a jump that the processor mispredicts half the time, and the elements of
+ *the next step are prefetched. For many searches in the same list, an Eytzinger copy lays
+ *the list out as an implicit binary tree in breadth first order, so the first levels of the
+ *tree share a few cache lines, and the 4 levels below a node are prefetched together.
+ *The set operations take lists without repeated elements and return new lists. Intersection
+ *gallops through the longer list when one list is much shorter than the other, and with GCC
+ *or clang compares blocks of integers with vector extensions otherwise.*/
+
+/**Intersection and difference gallop through the other list when it's at least this many
+ * times longer than the list, instead of walking both lists.*/
+#define LIST_SORTED_GALLOP 32
+/**The size of a block of the intersection of integers, an AVX2 register or an SSE register.*/
+#if defined(__AVX2__)
+#define LIST_SORTED_VEC 32
+#else
+#define LIST_SORTED_VEC 16
+#endif
+/**The size of a cache line, the amount of bytes of an Eytzinger copy that are prefetched.*/
+#define LIST_SORTED_LINE 64
+
+#if defined(__GNUC__) || defined(__clang__)
+#define list_sorted_prefetch(address) __builtin_prefetch(address)
+/*The amount of 1 bits at the bottom of 'k'.*/
+#define list_sorted_trailing_ones(k) ((size_t)__builtin_ctzll(~(unsigned long long)(k)))
+#else
+#define list_sorted_prefetch(address)
+static inline size_t list_sorted_trailing_ones(size_t k) {
+	size_t ones = 0;
+	for (; k & 1; k >>= 1) ones++;
+	return ones;
+}
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+/*Generate the intersection kernel of one integer type. A block of a vector of elements of
+ *each list is compared all against all, a lane against every element of the other block,
+ *and the matches of the first block are written out without branches. Then the block with
+ *the smaller last element moves on, or both if they're equal. The kernel writes one element
+ *past the last match.*/
+#define LIST_SORTED_KERNELS(suffix, ctype) \
+typedef ctype list_sorted_vec_##suffix __attribute__((vector_size(LIST_SORTED_VEC))); \
+ \
+static inline size_t list_sorted_intersect_##suffix(const void* data, size_t size, \
+	const void* other_data, size_t other_size, void* out_data) { \
+	const ctype* a = data; \
+	const ctype* b = other_data; \
+	ctype* out = out_data; \
+	const size_t per = LIST_SORTED_VEC / sizeof(ctype); \
+	size_t count = 0, i = 0, j = 0; \
+	while (i + per <= size && j + per <= other_size) { \
+		list_sorted_vec_##suffix va; \
+		memcpy(&va, a + i, sizeof(va)); \
+		__typeof__(va == va) match = va == b[j]; \
+		for (size_t l = 1; l < per; l++) match |= va == b[j + l]; \
+		uint64_t words[LIST_SORTED_VEC / 8], any = 0; \
+		memcpy(words, &match, sizeof(words)); \
+		for (size_t w = 0; w < LIST_SORTED_VEC / 8; w++) any |= words[w]; \
+		if (any) { \
+			for (size_t l = 0; l < per; l++) { \
+				out[count] = a[i + l]; \
+				count += match[l] != 0; \
+			} \
+		} \
+		ctype last = a[i + per - 1], other_last = b[j + per - 1]; \
+		i += last <= other_last ? per : 0; \
+		j += other_last <= last ? per : 0; \
+	} \
+	while (i < size && j < other_size) { \
+		ctype x = a[i], y = b[j]; \
+		out[count] = x; \
+		count += x == y; \
+		i += x <= y; \
+		j += y <= x; \
+	} \
+	return count; \
+}
+
+LIST_SORTED_KERNELS(i8, int8_t)
+LIST_SORTED_KERNELS(u8, uint8_t)
+LIST_SORTED_KERNELS(i16, int16_t)
+LIST_SORTED_KERNELS(u16, uint16_t)
+LIST_SORTED_KERNELS(i32, int32_t)
+LIST_SORTED_KERNELS(u32, uint32_t)
+LIST_SORTED_KERNELS(i64, int64_t)
+LIST_SORTED_KERNELS(u64, uint64_t)
+
+/*Call the kernel of an integer type's width and signedness.*/
+#define List_sorted_int_call(op, type, ...) \
+	if ((type)-1 < (type)0) { \
+		switch (sizeof(type)) { \
+			case 1: return list_sorted_##op##_i8(__VA_ARGS__); \
+			case 2: return list_sorted_##op##_i16(__VA_ARGS__); \
+			case 4: return list_sorted_##op##_i32(__VA_ARGS__); \
+			case 8: return list_sorted_##op##_i64(__VA_ARGS__); \
+		} \
+	} else { \
+		switch (sizeof(type)) { \
+			case 1: return list_sorted_##op##_u8(__VA_ARGS__); \
+			case 2: return list_sorted_##op##_u16(__VA_ARGS__); \
+			case 4: return list_sorted_##op##_u32(__VA_ARGS__); \
+			case 8: return list_sorted_##op##_u64(__VA_ARGS__); \
+		} \
+	}
+#else
+/*No vector extensions, every intersection is taken with the loop that follows the call.*/
+#define List_sorted_int_call(op, type, ...)
+#endif
+/*Lists of types other than integers are intersected with the loop that follows the call.*/
+#define List_sorted_no_call(op, type, ...)
+
+/* ========================= DECLARATIONS ========================= */
+
+#define List_sorted_declare(List_name, type) \
+/**An Eytzinger copy of a sorted list, for many searches in the same list.*/ \
+typedef struct List_name##_eytzinger_t { \
+	/*The tree in breadth first order, the root at 1, and the children of 'k' at 2k and 2k + 1.*/ \
+	type* _arr; \
+	size_t _size; \
+} List_name##_eytzinger_t; \
+ \
+/** \
+ * Returns the index of the first element of the sorted list that isn't less than 'element', \
+ * the index 'element' would be inserted at to keep the list sorted, before equal elements. \
+ * @param list The pointer to the list. \
+ * @param element The element to look for. \
+ * @return The index of the first element that isn't less than 'element', \
+ * the size of the list if there's none. \
+*/ \
+size_t List_name##_lowerBound(const List_name* list, type element); \
+/** \
+ * Returns the index of the first element of the sorted list that's greater than 'element', \
+ * the index 'element' would be inserted at to keep the list sorted, after equal elements. \
+ * @param list The pointer to the list. \
+ * @param element The element to look for. \
+ * @return The index of the first element that's greater than 'element', \
+ * the size of the list if there's none. \
+*/ \
+size_t List_name##_upperBound(const List_name* list, type element); \
+/** \
+ * Searches a sorted list for an element. \
+ * @param list The pointer to the list. \
+ * @param element The element to look for. \
+ * @return The index of the first element that's equal to 'element', or -1 if there's none. \
+*/ \
+ssize_t List_name##_binarySearch(const List_name* list, type element); \
+/** \
+ * Merges two sorted lists into a new sorted list, equal elements of 'list' go before \
+ * the ones of 'other'. \
+ * @param list The pointer to the first list. \
+ * @param other The pointer to the second list. \
+ * @return A pointer to the new list, delete it with delete(). \
+*/ \
+List_name* List_name##_merge(const List_name* list, const List_name* other); \
+/** \
+ * Returns the union of two sorted lists without repeated elements. \
+ * @param list The pointer to the first list. \
+ * @param other The pointer to the second list. \
+ * @return A pointer to a new sorted list of the elements that are in either list, \
+ * delete it with delete(). \
+*/ \
+List_name* List_name##_union(const List_name* list, const List_name* other); \
+/** \
+ * Returns the intersection of two sorted lists without repeated elements. \
+ * @param list The pointer to the first list. \
+ * @param other The pointer to the second list. \
+ * @return A pointer to a new sorted list of the elements that are in both lists, \
+ * delete it with delete(). \
+*/ \
+List_name* List_name##_intersection(const List_name* list, const List_name* other); \
+/** \
+ * Returns the difference of two sorted lists without repeated elements. \
+ * @param list The pointer to the first list. \
+ * @param other The pointer to the second list. \
+ * @return A pointer to a new sorted list of the elements of 'list' that aren't in 'other', \
+ * delete it with delete(). \
+*/ \
+List_name* List_name##_difference(const List_name* list, const List_name* other); \
+/** \
+ * Creates an Eytzinger copy of a sorted list. The copy doesn't change with the list. \
+ * @param list The pointer to the list. \
+ * @return A pointer to the new copy, delete it with deleteEytzinger(). \
+*/ \
+List_name##_eytzinger_t* List_name##_newEytzinger(const List_name* list); \
+/** \
+ * Deletes an Eytzinger copy of a list. \
+ * @param tree The pointer to the copy. \
+*/ \
+void List_name##_deleteEytzinger(List_name##_eytzinger_t* tree); \
+/** \
+ * Returns the first element of an Eytzinger copy of a list that isn't less than 'element', \
+ * like lowerBound() on the list. \
+ * @param tree The pointer to the copy. \
+ * @param element The element to look for. \
+ * @return A pointer to the element in the copy, or NULL if every element is less than 'element'. \
+*/ \
+const type* List_name##_eytzingerLowerBound(const List_name##_eytzinger_t* tree, type element); \
+/** \
+ * Checks if an Eytzinger copy of a list has an element. \
+ * @param tree The pointer to the copy. \
+ * @param element The element to look for. \
+ * @return 1 if the copy has an element equal to 'element', 0 if it doesn't. \
+*/ \
+int List_name##_eytzingerContains(const List_name##_eytzinger_t* tree, type element);
+
+/* ========================= DEFINITIONS ========================= */
+
+#define List_sorted_define(List_name, type, less, call) \
+size_t List_name##_lowerBound(const List_name* list, type element) { \
+	const type* base = list->_arr; \
+	size_t size = list->_size; \
+	if (size == 0) return 0; \
+	/*The bound is in [base, base + size].*/ \
+	while (size > 1) { \
+		size_t half = size / 2; \
+		list_sorted_prefetch(base + half / 2); \
+		list_sorted_prefetch(base + half + half / 2); \
+		base = less(base[half], element) ? base + half : base; \
+		size -= half; \
+	} \
+	return (size_t)(base - list->_arr) + less(*base, element); \
+} \
+ \
+size_t List_name##_upperBound(const List_name* list, type element) { \
+	const type* base = list->_arr; \
+	size_t size = list->_size; \
+	if (size == 0) return 0; \
+	while (size > 1) { \
+		size_t half = size / 2; \
+		list_sorted_prefetch(base + half / 2); \
+		list_sorted_prefetch(base + half + half / 2); \
+		base = less(element, base[half]) ? base : base + half; \
+		size -= half; \
+	} \
+	return (size_t)(base - list->_arr) + !less(element, *base); \
+} \
+ \
+ssize_t List_name##_binarySearch(const List_name* list, type element) { \
+	size_t index = List_name##_lowerBound(list, element); \
+	if (index == list->_size || less(element, list->_arr[index])) return -1; \
+	return index; \
+} \
+ \
+/*A new list with room for 'size' elements, and one more, for the write past the last match \
+ *of the intersection kernels. Also keeps empty results from allocating 0 bytes.*/ \
+static inline List_name* List_name##_sorted_result(size_t size) { \
+	return List_name##_news(size + 1); \
+} \
+ \
+/*The index of the first element of arr[from, size) that isn't less than 'element', found \
+ *with steps that double from 'from', and a binary search in the last step.*/ \
+static inline size_t List_name##_gallop(const type* arr, size_t from, size_t size, type element) { \
+	size_t step = 1, low = from, high = from; \
+	while (high < size && less(arr[high], element)) { \
+		low = high + 1; \
+		high += step; \
+		step *= 2; \
+	} \
+	if (high > size) high = size; \
+	while (low < high) { \
+		size_t mid = low + (high - low) / 2; \
+		if (less(arr[mid], element)) low = mid + 1; \
+		else high = mid; \
+	} \
+	return low; \
+} \
+ \
+List_name* List_name##_merge(const List_name* list, const List_name* other) { \
+	const type* a = list->_arr, * b = other->_arr; \
+	size_t size = list->_size, other_size = other->_size; \
+	List_name* result = List_name##_sorted_result(size + other_size); \
+	type* out = result->_arr; \
+	size_t i = 0, j = 0; \
+	while (i < size && j < other_size) { \
+		int take_other = less(b[j], a[i]); \
+		*out++ = take_other ? b[j] : a[i]; \
+		j += take_other; \
+		i += !take_other; \
+	} \
+	memcpy(out, a + i, (size - i) * sizeof(type)); \
+	memcpy(out + (size - i), b + j, (other_size - j) * sizeof(type)); \
+	result->_size = size + other_size; \
+	return result; \
+} \
+ \
+List_name* List_name##_union(const List_name* list, const List_name* other) { \
+	const type* a = list->_arr, * b = other->_arr; \
+	size_t size = list->_size, other_size = other->_size; \
+	List_name* result = List_name##_sorted_result(size + other_size); \
+	type* out = result->_arr; \
+	size_t count = 0, i = 0, j = 0; \
+	while (i < size && j < other_size) { \
+		int before = less(a[i], b[j]), after = less(b[j], a[i]); \
+		out[count++] = before ? a[i] : b[j]; \
+		i += !after; \
+		j += !before; \
+	} \
+	memcpy(out + count, a + i, (size - i) * sizeof(type)); \
+	count += size - i; \
+	memcpy(out + count, b + j, (other_size - j) * sizeof(type)); \
+	result->_size = count + other_size - j; \
+	return result; \
+} \
+ \
+/*Intersect two arrays of similar lengths into 'out', returns the amount of elements.*/ \
+static size_t List_name##_intersect(const type* a, size_t size, const type* b, size_t other_size, type* out) { \
+	call(intersect, type, a, size, b, other_size, out) \
+	size_t count = 0, i = 0, j = 0; \
+	while (i < size && j < other_size) { \
+		int before = less(a[i], b[j]), after = less(b[j], a[i]); \
+		out[count] = a[i]; \
+		count += !before && !after; \
+		i += !after; \
+		j += !before; \
+	} \
+	return count; \
+} \
+ \
+List_name* List_name##_intersection(const List_name* list, const List_name* other) { \
+	/*The result is the same either way, 'a' is the shorter list.*/ \
+	if (list->_size > other->_size) { \
+		const List_name* temp = list; \
+		list = other; \
+		other = temp; \
+	} \
+	const type* a = list->_arr, * b = other->_arr; \
+	size_t size = list->_size, other_size = other->_size; \
+	List_name* result = List_name##_sorted_result(size); \
+	if (size > other_size / LIST_SORTED_GALLOP) { \
+		result->_size = List_name##_intersect(a, size, b, other_size, result->_arr); \
+		return result; \
+	} \
+	type* out = result->_arr; \
+	size_t count = 0; \
+	for (size_t i = 0, j = 0; i < size && j < other_size; i++) { \
+		j = List_name##_gallop(b, j, other_size, a[i]); \
+		if (j < other_size && !less(a[i], b[j])) out[count++] = b[j++]; \
+	} \
+	result->_size = count; \
+	return result; \
+} \
+ \
+List_name* List_name##_difference(const List_name* list, const List_name* other) { \
+	const type* a = list->_arr, * b = other->_arr; \
+	size_t size = list->_size, other_size = other->_size; \
+	List_name* result = List_name##_sorted_result(size); \
+	type* out = result->_arr; \
+	size_t count = 0, i = 0, j = 0; \
+	if (size <= other_size / LIST_SORTED_GALLOP) { \
+		for (; i < size && j < other_size; i++) { \
+			j = List_name##_gallop(b, j, other_size, a[i]); \
+			if (j == other_size || less(a[i], b[j])) out[count++] = a[i]; \
+			else j++; \
+		} \
+	} else { \
+		while (i < size && j < other_size) { \
+			int before = less(a[i], b[j]), after = less(b[j], a[i]); \
+			out[count] = a[i]; \
+			count += before; \
+			i += !after; \
+			j += !before; \
+		} \
+	} \
+	memcpy(out + count, a + i, (size - i) * sizeof(type)); \
+	result->_size = count + size - i; \
+	return result; \
+} \
+ \
+/*Copy the sorted 'arr' into the subtree of 'k' in order, from arr[i], returns the next i.*/ \
+static size_t List_name##_eytzinger_build(type* tree, size_t size, const type* arr, size_t i, size_t k) { \
+	if (k > size) return i; \
+	i = List_name##_eytzinger_build(tree, size, arr, i, 2 * k); \
+	tree[k] = arr[i++]; \
+	return List_name##_eytzinger_build(tree, size, arr, i, 2 * k + 1); \
+} \
+ \
+List_name##_eytzinger_t* List_name##_newEytzinger(const List_name* list) { \
+	List_name##_eytzinger_t* tree = malloc(sizeof(List_name##_eytzinger_t)); \
+	type* arr = DS_MALLOC((list->_size + 1) * sizeof(type)); \
+	if (!tree || !arr) { \
+		fprintf(stderr, "Error at List_name##_newEytzinger: malloc returned NULL\n"); \
+		exit(EXIT_FAILURE); \
+	} \
+	List_name##_eytzinger_build(arr, list->_size, list->_arr, 0, 1); \
+	tree->_arr = arr; \
+	tree->_size = list->_size; \
+	return tree; \
+} \
+ \
+void List_name##_deleteEytzinger(List_name##_eytzinger_t* tree) { \
+	DS_FREE(tree->_arr); \
+	free(tree); \
+} \
+ \
+const type* List_name##_eytzingerLowerBound(const List_name##_eytzinger_t* tree, type element) { \
+	/*The descendants of 'k' some levels down are the line at k * ahead.*/ \
+	const size_t ahead = sizeof(type) < LIST_SORTED_LINE ? LIST_SORTED_LINE / sizeof(type) : 1; \
+	const type* arr = tree->_arr; \
+	size_t k = 1; \
+	while (k <= tree->_size) { \
+		list_sorted_prefetch((const char*)arr + k * ahead * sizeof(type)); \
+		k = 2 * k + less(arr[k], element); \
+	} \
+	/*Every right turn after the last left turn added a 1 bit, the bound is where it turned left.*/ \
+	k >>= list_sorted_trailing_ones(k) + 1; \
+	return k ? arr + k : NULL; \
+} \
+ \
+int List_name##_eytzingerContains(const List_name##_eytzinger_t* tree, type element) { \
+	const type* bound = List_name##_eytzingerLowerBound(tree, element); \
+	return bound && !less(element, *bound); \
+}
+
+/* ========================= ALL ========================= */
+
+/**
+ * Generate lowerBound, upperBound, binarySearch, merge, union, intersection, difference
+ * and the Eytzinger copy for a sorted list.
+ * @param type The type of the elements.
+ * @param List_name The name of the list, generated with STRUCT_LIST.
+ * @param less The comparator the list is sorted with, as given to LIST_SORT.
+*/
+#define LIST_SORTED(type, List_name, less) \
+List_sorted_declare(List_name, type) \
+List_sorted_define(List_name, type, less, List_sorted_no_call)
+
+/**
+ * Generate the operations of LIST_SORTED for a list of an integer type, sorted from the
+ * smallest to the largest element, with a vectorized intersection.
+ * @param type The type of the elements, an integer type of 1, 2, 4 or 8 bytes.
+ * @param List_name The name of the list, generated with STRUCT_LIST.
+*/
+#define LIST_SORTED_INT(type, List_name) \
+List_sorted_declare(List_name, type) \
+List_sorted_define(List_name, type, LIST_LESS, List_sorted_int_call)
+
+#endif
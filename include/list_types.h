@@ -1,6 +1,10 @@
 #ifndef __LIST_TYPES_H__
 #define __LIST_TYPES_H__
 #include "list.h"
+#include "list_search.h"
+#include "list_reduce.h"
+#include "list_sort.h"
+#include "list_sorted.h"
 
 STRUCT_LIST(char,	ListChar)
 STRUCT_LIST(short,	ListShort)
@@ -37,4 +41,83 @@ STRUCT_LIST(unsigned long long*,ListULLongPtr)
 
 STRUCT_LIST(size_t,	ListSizeT)
 
-#endif
\ No newline at end of file
+LIST_SEARCH_INT(char,	ListChar)
+LIST_SEARCH_INT(short,	ListShort)
+LIST_SEARCH_INT(int,	ListInt)
+LIST_SEARCH_INT(long,	ListLong)
+LIST_SEARCH_FLOAT(float,	ListFloat)
+LIST_SEARCH_FLOAT(double,	ListDouble)
+LIST_SEARCH_INT(long long,	ListLLong)
+LIST_SEARCH_FLOAT(long double,	ListLDouble)
+LIST_SEARCH_INT(signed char,	ListSChar)
+LIST_SEARCH_INT(unsigned char,	ListUChar)
+LIST_SEARCH_INT(unsigned short,	ListUShort)
+LIST_SEARCH_INT(unsigned int,	ListUInt)
+LIST_SEARCH_INT(unsigned long,	ListULong)
+LIST_SEARCH_INT(unsigned long long,ListULLong)
+LIST_SEARCH_INT(size_t,	ListSizeT)
+
+LIST_REDUCE_INT(char,	ListChar,	long long)
+LIST_REDUCE_INT(short,	ListShort,	long long)
+LIST_REDUCE_INT(int,	ListInt,	long long)
+LIST_REDUCE_INT(long,	ListLong,	long long)
+LIST_REDUCE_FLOAT(float,	ListFloat,	double)
+LIST_REDUCE_FLOAT(double,	ListDouble,	double)
+LIST_REDUCE_INT(long long,	ListLLong,	long long)
+LIST_REDUCE_FLOAT(long double,	ListLDouble,	long double)
+LIST_REDUCE_INT(signed char,	ListSChar,	long long)
+LIST_REDUCE_INT(unsigned char,	ListUChar,	unsigned long long)
+LIST_REDUCE_INT(unsigned short,	ListUShort,	unsigned long long)
+LIST_REDUCE_INT(unsigned int,	ListUInt,	unsigned long long)
+LIST_REDUCE_INT(unsigned long,	ListULong,	unsigned long long)
+LIST_REDUCE_INT(unsigned long long,ListULLong,	unsigned long long)
+LIST_REDUCE_INT(size_t,	ListSizeT,	unsigned long long)
+
+LIST_SORT(char,	ListChar,	LIST_LESS)
+LIST_SORT(short,	ListShort,	LIST_LESS)
+LIST_SORT(int,	ListInt,	LIST_LESS)
+LIST_SORT(long,	ListLong,	LIST_LESS)
+LIST_SORT(float,	ListFloat,	LIST_LESS)
+LIST_SORT(double,	ListDouble,	LIST_LESS)
+LIST_SORT(long long,	ListLLong,	LIST_LESS)
+LIST_SORT(long double,	ListLDouble,	LIST_LESS)
+LIST_SORT(signed char,	ListSChar,	LIST_LESS)
+LIST_SORT(unsigned char,	ListUChar,	LIST_LESS)
+LIST_SORT(unsigned short,	ListUShort,	LIST_LESS)
+LIST_SORT(unsigned int,	ListUInt,	LIST_LESS)
+LIST_SORT(unsigned long,	ListULong,	LIST_LESS)
+LIST_SORT(unsigned long long,ListULLong,	LIST_LESS)
+LIST_SORT(size_t,	ListSizeT,	LIST_LESS)
+
+LIST_RADIX_SORT_INT(char,	ListChar)
+LIST_RADIX_SORT_INT(short,	ListShort)
+LIST_RADIX_SORT_INT(int,	ListInt)
+LIST_RADIX_SORT_INT(long,	ListLong)
+LIST_RADIX_SORT_FLOAT(float,	ListFloat)
+LIST_RADIX_SORT_FLOAT(double,	ListDouble)
+LIST_RADIX_SORT_INT(long long,	ListLLong)
+LIST_RADIX_SORT_INT(signed char,	ListSChar)
+LIST_RADIX_SORT_INT(unsigned char,	ListUChar)
+LIST_RADIX_SORT_INT(unsigned short,	ListUShort)
+LIST_RADIX_SORT_INT(unsigned int,	ListUInt)
+LIST_RADIX_SORT_INT(unsigned long,	ListULong)
+LIST_RADIX_SORT_INT(unsigned long long,ListULLong)
+LIST_RADIX_SORT_INT(size_t,	ListSizeT)
+
+LIST_SORTED_INT(char,	ListChar)
+LIST_SORTED_INT(short,	ListShort)
+LIST_SORTED_INT(int,	ListInt)
+LIST_SORTED_INT(long,	ListLong)
+LIST_SORTED(float,	ListFloat,	LIST_LESS)
+LIST_SORTED(double,	ListDouble,	LIST_LESS)
+LIST_SORTED_INT(long long,	ListLLong)
+LIST_SORTED(long double,	ListLDouble,	LIST_LESS)
+LIST_SORTED_INT(signed char,	ListSChar)
+LIST_SORTED_INT(unsigned char,	ListUChar)
+LIST_SORTED_INT(unsigned short,	ListUShort)
+LIST_SORTED_INT(unsigned int,	ListUInt)
+LIST_SORTED_INT(unsigned long,	ListULong)
+LIST_SORTED_INT(unsigned long long,ListULLong)
+LIST_SORTED_INT(size_t,	ListSizeT)
+
+#endif
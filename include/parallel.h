@@ -0,0 +1,41 @@
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+/**
+ * @file parallel.h
+ * @brief A minimal fork-join helper for the parallel operations of the data
+ * structures, runs a task on a number of threads and waits for all of them.
+*/
+
+#include<stddef.h>
+
+/**The most threads a parallel operation uses.*/
+#define DS_PARALLEL_MAX_THREADS 256
+
+/**
+ * A task that runs on every thread of a parallel operation.
+ * @param thread The index of the thread, from 0 to nthreads - 1.
+ * @param nthreads The amount of threads running the task.
+ * @param context The context that was passed to ds_parallel_run.
+*/
+typedef void (*ds_parallel_task_t)(size_t thread, size_t nthreads, void *context);
+
+/**
+ * Get the amount of threads to use for a requested amount.
+ * @param nthreads The requested amount of threads, 0 for one per processor.
+ * @return The amount of threads, at least 1 and at most DS_PARALLEL_MAX_THREADS.
+*/
+size_t ds_parallel_threads(size_t nthreads);
+
+/**
+ * Run a task on a number of threads and wait for all of them to finish. The
+ * calling thread runs the task as thread 0.
+ * @param nthreads The amount of threads, as returned by ds_parallel_threads.
+ * @param task The task to run.
+ * @param context The context to pass to the task.
+ * @note If some threads can't be created, their part of the task runs on the
+ * calling thread, the task always runs for every thread index.
+*/
+void ds_parallel_run(size_t nthreads, ds_parallel_task_t task, void *context);
+
+#endif
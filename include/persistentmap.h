@@ -0,0 +1,717 @@
+#ifndef __PERSISTENT_MAP_H__
+#define __PERSISTENT_MAP_H__
+
+/**
+ * @file persistentmap.h
+ * @brief A persistent hash map, a hash array mapped trie whose versions share
+ * structure. A snapshot of the map takes O(1), it's a reference counted
+ * immutable view of the current version, that readers on any thread can
+ * use while the writer keeps changing the map. A change copies only the path
+ * from the root to the changed entry, and only where the path is still
+ * shared with a snapshot, nodes that only the map holds are changed in place.
+ *
+ * Every node covers 5 bits of the hash, and holds a slot for every 5 bit
+ * value that has either an entry or a child node, two bitmaps tell which.
+ * Keys whose 64 bit hashes are equal end in a collision node, a plain list.
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<stdbool.h>
+#include<stdatomic.h>
+#include "errors.h"
+
+/**The amount of hash bits every level of the trie covers.*/
+#define PERSISTENTMAP_BITS 5
+/**The shift of the first level that is a collision node.*/
+#define PERSISTENTMAP_COLLISION_SHIFT 64
+
+/**
+ * Mix the bits of a hash, splitmix64's finalizer.
+ * @param hash The hash to mix.
+ * @return The mixed hash.
+*/
+static inline uint64_t persistentmap_mix(uint64_t hash) {
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ull;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebull;
+  hash ^= hash >> 31;
+  return hash;
+}
+
+/**
+ * Returns the amount of set bits in a word.
+*/
+static inline unsigned persistentmap_popcount(uint32_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcount(word);
+#else
+  unsigned count = 0;
+  for (; word; word &= word - 1) count++;
+  return count;
+#endif
+}
+
+/**Get the bit of a hash in the bitmaps of a node at a level.*/
+#define persistentmap_bit(hash, shift) \
+  ((uint32_t)1 << (((hash) >> (shift)) & ((1 << PERSISTENTMAP_BITS) - 1)))
+/**Get the index of the slot of a bit in a node.*/
+#define persistentmap_index(node, bit) \
+  persistentmap_popcount(((node)->datamap | (node)->nodemap) & ((bit) - 1))
+
+/* ========================= DECLARATIONS ========================= */
+
+#define PersistentMap_types_declare(hm_name) \
+typedef struct hm_name##_entry_t hm_name##_entry_t; \
+typedef struct hm_name##_node_t hm_name##_node_t; \
+typedef struct hm_name##_view_t hm_name##_view_t; \
+typedef struct hm_name hm_name;
+
+#define PersistentMap_hash_declare(hm_name, key_t, hash_t) \
+  extern hash_t (*const hm_name##_hash)(const key_t*);
+#define PersistentMap_keycmp_declare(hm_name, key_t) \
+  extern bool (*const hm_name##_keycmp)(const key_t*, const key_t*);
+
+#define PersistentMap_new_declare(hm_name) \
+/** \
+ * Allocates a new empty persistent map and returns a pointer to it. \
+ * @return A pointer to the new map. NULL on failure. \
+ * @note Returns NULL on failed memory allocation. \
+*/ \
+hm_name * hm_name##_new();
+
+#define PersistentMap_put_declare(hm_name, key_t, val_t) \
+/** \
+ * Adds or overwrites a key value pair to the map. Snapshots that were taken \
+ * before are not affected. \
+ * @param map The persistent map. \
+ * @param key The key by which to map the pair. \
+ * @param value The value to map to the key. \
+ * @return HMP_ADD if a new pair was added, HMP_SET if the key already exists \
+ * and it's paired value was overwritten. An error code on failure. \
+ * @note Errors:  \
+ * ERR_MEM - Memory allocation error, the map is left unchanged. \
+*/ \
+DS_codes_t hm_name##_put(hm_name *map, const key_t *key, const val_t *value);
+
+#define PersistentMap_has_declare(hm_name, key_t) \
+/** \
+ * Check if the map has a specified key stored. \
+ * @param map The persistent map. \
+ * @param key The key to search for. \
+ * @return True if the key is in the map, false otherwise. \
+*/ \
+bool hm_name##_has(const hm_name *map, const key_t *key);
+
+#define PersistentMap_get_declare(hm_name, key_t, val_t) \
+/** \
+ * Get the value mapped to a specified key. \
+ * @param map The persistent map. \
+ * @param key The key that the value was mapped to. \
+ * @return A pointer to the value, or NULL if it was not found. \
+ * @note The value may be shared with snapshots, use put() to change it. \
+*/ \
+const val_t * hm_name##_get(const hm_name *map, const key_t *key);
+
+#define PersistentMap_remove_declare(hm_name, key_t) \
+/** \
+ * Remove the value mapped to a specified key. Snapshots that were taken \
+ * before are not affected. \
+ * @param map The persistent map. \
+ * @param key The key that the value was mapped to. \
+ * @return DS_SUCCESS on successfull removal, an error code otherwise. \
+ * @note Errors:  \
+ * ERR_KEYNOTFOUND - If the key was not found in the map. \
+ * ERR_MEM - Memory allocation error. \
+*/ \
+DS_codes_t hm_name##_remove(hm_name *map, const key_t *key);
+
+#define PersistentMap_snapshot_declare(hm_name) \
+/** \
+ * Take an immutable snapshot of the current version of the map, in O(1). \
+ * @param map The persistent map. \
+ * @return A pointer to the new view, with a reference count of 1. NULL on \
+ * failed memory allocation. \
+ * @note The view can be read from any thread, while the map changes. \
+ * Release it with view_release(). \
+*/ \
+hm_name##_view_t * hm_name##_snapshot(const hm_name *map);
+
+#define PersistentMap_view_has_declare(hm_name, key_t) \
+/** \
+ * Check if a snapshot has a specified key stored. \
+ * @param view The snapshot. \
+ * @param key The key to search for. \
+ * @return True if the key is in the snapshot, false otherwise. \
+*/ \
+bool hm_name##_view_has(const hm_name##_view_t *view, const key_t *key);
+
+#define PersistentMap_view_get_declare(hm_name, key_t, val_t) \
+/** \
+ * Get the value mapped to a specified key in a snapshot. \
+ * @param view The snapshot. \
+ * @param key The key that the value was mapped to. \
+ * @return A pointer to the value, or NULL if it was not found. \
+*/ \
+const val_t * hm_name##_view_get(const hm_name##_view_t *view, const key_t *key);
+
+#define PersistentMap_view_for_each_declare(hm_name, key_t, val_t) \
+/** \
+ * Call a function for every entry of a snapshot. \
+ * @param view The snapshot. \
+ * @param func The function, it's given the key, the value and `ctx`. \
+ * @param ctx A context to pass to the function. \
+*/ \
+void hm_name##_view_for_each(const hm_name##_view_t *view, \
+  void (*func)(const key_t*, const val_t*, void*), void *ctx);
+
+#define PersistentMap_view_retain_declare(hm_name) \
+/** \
+ * Take another reference to a snapshot, to share it with another reader. \
+ * @param view The snapshot. \
+ * @return The snapshot. \
+*/ \
+hm_name##_view_t * hm_name##_view_retain(hm_name##_view_t *view);
+
+#define PersistentMap_view_release_declare(hm_name) \
+/** \
+ * Release a reference to a snapshot, the last release frees it and every \
+ * node that no other version shares. \
+ * @param view The snapshot. \
+*/ \
+void hm_name##_view_release(hm_name##_view_t *view);
+
+#define PersistentMap_free_declare(hm_name) \
+/** \
+ * Releases the map, snapshots of it stay valid until they're released. \
+ * @param map The persistent map. \
+*/ \
+void hm_name##_free(hm_name *map);
+
+/* ========================= DEFINITIONS ========================= */
+
+#define PersistentMap_types_define(hm_name, key_t, val_t) \
+/**Represents an entry in the persistent map.*/ \
+struct hm_name##_entry_t { \
+  /**The key of the entry*/ \
+  key_t key; \
+  /**The mixed hash of the key.*/ \
+  uint64_t hash; \
+  /**The value of the entry.*/ \
+  val_t val; \
+}; \
+/**A slot of a node, an entry or a child node, the bitmaps tell which.*/ \
+typedef union hm_name##_slot_t { \
+  hm_name##_entry_t entry; \
+  hm_name##_node_t *child; \
+} hm_name##_slot_t; \
+/**Represents a node of the trie, shared by every version that has it.*/ \
+struct hm_name##_node_t { \
+  /**The amount of versions and nodes that hold this node.*/ \
+  atomic_size_t refs; \
+  /**The bits whose slots are entries, 0 in a collision node.*/ \
+  uint32_t datamap; \
+  /**The bits whose slots are child nodes, 0 in a collision node.*/ \
+  uint32_t nodemap; \
+  /**The amount of slots.*/ \
+  uint32_t count; \
+  /**The slots, in the order of their bits.*/ \
+  hm_name##_slot_t slots[]; \
+}; \
+/**Represents an immutable snapshot of a persistent map.*/ \
+struct hm_name##_view_t { \
+  /**The amount of readers that hold this view.*/ \
+  atomic_size_t refs; \
+  /**The root of the version, NULL if it's empty.*/ \
+  hm_name##_node_t *root; \
+  /**The amount of entries in the version.*/ \
+  size_t size; \
+}; \
+/**Represents a persistent map data structure.*/ \
+struct hm_name { \
+  /**The root of the current version, NULL if the map is empty.*/ \
+  hm_name##_node_t *root; \
+  /**The amount of entries in the map.*/ \
+  size_t size; \
+};
+
+#define PersistentMap_hash_define(hm_name, key_t, hash_t, hash) \
+/**A pointer to a function that hashes a key.*/ \
+hash_t (*const hm_name##_hash)(const key_t*) = hash;
+
+#define PersistentMap_keycmp_define(hm_name, key_t, keycmp) \
+/**A pointer to a function that compares two keys and returns true if they're equal.*/ \
+bool (*const hm_name##_keycmp)(const key_t*, const key_t*) = keycmp;
+
+#define PersistentMap_node_define(hm_name, key_t, val_t) \
+/**Allocate a node of `count` slots, held once.*/ \
+static hm_name##_node_t * hm_name##_node_alloc(uint32_t count) { \
+  hm_name##_node_t *node = malloc(sizeof(hm_name##_node_t) + \
+    count * sizeof(hm_name##_slot_t)); \
+  if (node == NULL) return NULL; \
+  atomic_init(&node->refs, 1); \
+  node->datamap = 0; \
+  node->nodemap = 0; \
+  node->count = count; \
+  return node; \
+} \
+/**Take a reference to every child of a node.*/ \
+static void hm_name##_node_retain_children(hm_name##_node_t *node) { \
+  uint32_t bits = node->datamap | node->nodemap; \
+  for (uint32_t i = 0; bits != 0; i++, bits &= bits - 1) { \
+    if (node->nodemap & bits & -bits) { \
+      atomic_fetch_add_explicit(&node->slots[i].child->refs, 1, memory_order_relaxed); \
+    } \
+  } \
+} \
+/**Release a reference to a node, the last one frees it and releases it's \
+ * children.*/ \
+static void hm_name##_node_release(hm_name##_node_t *node) { \
+  if (node == NULL) return; \
+  if (atomic_fetch_sub_explicit(&node->refs, 1, memory_order_acq_rel) != 1) return; \
+  uint32_t bits = node->datamap | node->nodemap; \
+  for (uint32_t i = 0; bits != 0; i++, bits &= bits - 1) { \
+    if (node->nodemap & bits & -bits) hm_name##_node_release(node->slots[i].child); \
+  } \
+  free(node); \
+} \
+/**Check if a node can be changed in place, if the path to it and the node \
+ * itself are held only by the map.*/ \
+static inline bool hm_name##_node_owned(hm_name##_node_t *node, bool path_owned) { \
+  return path_owned && atomic_load_explicit(&node->refs, memory_order_acquire) == 1; \
+} \
+/**Copy a node, the copy holds it's own references to the children.*/ \
+static hm_name##_node_t * hm_name##_node_clone(hm_name##_node_t *node) { \
+  hm_name##_node_t *copy = hm_name##_node_alloc(node->count); \
+  if (copy == NULL) return NULL; \
+  copy->datamap = node->datamap; \
+  copy->nodemap = node->nodemap; \
+  memcpy(copy->slots, node->slots, node->count * sizeof(hm_name##_slot_t)); \
+  hm_name##_node_retain_children(copy); \
+  return copy; \
+} \
+/**Copy a node with an entry inserted at slot `index`, for bit `bit`.*/ \
+static hm_name##_node_t * hm_name##_node_insert(hm_name##_node_t *node, \
+  uint32_t index, uint32_t bit, const hm_name##_entry_t *entry) { \
+  hm_name##_node_t *copy = hm_name##_node_alloc(node->count + 1); \
+  if (copy == NULL) return NULL; \
+  copy->datamap = node->datamap | bit; \
+  copy->nodemap = node->nodemap; \
+  memcpy(copy->slots, node->slots, index * sizeof(hm_name##_slot_t)); \
+  copy->slots[index].entry = *entry; \
+  memcpy(copy->slots + index + 1, node->slots + index, \
+    (node->count - index) * sizeof(hm_name##_slot_t)); \
+  hm_name##_node_retain_children(copy); \
+  return copy; \
+} \
+/**Copy a node without slot `index`, of bit `bit`.*/ \
+static hm_name##_node_t * hm_name##_node_erase(hm_name##_node_t *node, \
+  uint32_t index, uint32_t bit) { \
+  hm_name##_node_t *copy = hm_name##_node_alloc(node->count - 1); \
+  if (copy == NULL) return NULL; \
+  copy->datamap = node->datamap & ~bit; \
+  copy->nodemap = node->nodemap & ~bit; \
+  memcpy(copy->slots, node->slots, index * sizeof(hm_name##_slot_t)); \
+  memcpy(copy->slots + index, node->slots + index + 1, \
+    (node->count - index - 1) * sizeof(hm_name##_slot_t)); \
+  hm_name##_node_retain_children(copy); \
+  return copy; \
+} \
+/**Make a node at level `shift` that holds two entries with different keys.*/ \
+static hm_name##_node_t * hm_name##_node_pair(const hm_name##_entry_t *entry1, \
+  const hm_name##_entry_t *entry2, unsigned shift) { \
+  hm_name##_node_t *node; \
+  if (shift >= PERSISTENTMAP_COLLISION_SHIFT) { \
+    node = hm_name##_node_alloc(2); \
+    if (node == NULL) return NULL; \
+    node->slots[0].entry = *entry1; \
+    node->slots[1].entry = *entry2; \
+    return node; \
+  } \
+  uint32_t bit1 = persistentmap_bit(entry1->hash, shift); \
+  uint32_t bit2 = persistentmap_bit(entry2->hash, shift); \
+  if (bit1 == bit2) { \
+    hm_name##_node_t *child = hm_name##_node_pair(entry1, entry2, shift + PERSISTENTMAP_BITS); \
+    if (child == NULL) return NULL; \
+    node = hm_name##_node_alloc(1); \
+    if (node == NULL) { \
+      hm_name##_node_release(child); \
+      return NULL; \
+    } \
+    node->nodemap = bit1; \
+    node->slots[0].child = child; \
+    return node; \
+  } \
+  node = hm_name##_node_alloc(2); \
+  if (node == NULL) return NULL; \
+  node->datamap = bit1 | bit2; \
+  node->slots[bit1 < bit2 ? 0 : 1].entry = *entry1; \
+  node->slots[bit1 < bit2 ? 1 : 0].entry = *entry2; \
+  return node; \
+} \
+/**Find the entry of a key in a trie, NULL if it's not there.*/ \
+static const hm_name##_entry_t * hm_name##_node_find(const hm_name##_node_t *node, \
+  const key_t *key, uint64_t hash) { \
+  for (unsigned shift = 0; node != NULL; shift += PERSISTENTMAP_BITS) { \
+    if (shift >= PERSISTENTMAP_COLLISION_SHIFT) { \
+      for (uint32_t i = 0; i < node->count; i++) { \
+        const hm_name##_entry_t *entry = &node->slots[i].entry; \
+        if (entry->hash == hash && hm_name##_keycmp(key, &entry->key)) return entry; \
+      } \
+      return NULL; \
+    } \
+    uint32_t bit = persistentmap_bit(hash, shift); \
+    uint32_t index = persistentmap_index(node, bit); \
+    if (node->datamap & bit) { \
+      const hm_name##_entry_t *entry = &node->slots[index].entry; \
+      return entry->hash == hash && hm_name##_keycmp(key, &entry->key) ? entry : NULL; \
+    } \
+    if (!(node->nodemap & bit)) return NULL; \
+    node = node->slots[index].child; \
+  } \
+  return NULL; \
+} \
+/**Call a function for every entry of a trie.*/ \
+static void hm_name##_node_for_each(const hm_name##_node_t *node, \
+  void (*func)(const key_t*, const val_t*, void*), void *ctx) { \
+  if (node == NULL) return; \
+  uint32_t bits = node->datamap | node->nodemap; \
+  if (bits == 0) { \
+    for (uint32_t i = 0; i < node->count; i++) { \
+      func(&node->slots[i].entry.key, &node->slots[i].entry.val, ctx); \
+    } \
+    return; \
+  } \
+  for (uint32_t i = 0; bits != 0; i++, bits &= bits - 1) { \
+    if (node->nodemap & bits & -bits) hm_name##_node_for_each(node->slots[i].child, func, ctx); \
+    else func(&node->slots[i].entry.key, &node->slots[i].entry.val, ctx); \
+  } \
+}
+
+#define PersistentMap_new_define(hm_name) \
+hm_name * hm_name##_new() { \
+  hm_name *map = malloc(sizeof(hm_name)); \
+  if (map == NULL) return NULL; \
+  map->root = NULL; \
+  map->size = 0; \
+  return map; \
+}
+
+#define PersistentMap_put_define(hm_name, key_t, val_t, hash_t) \
+/**Put an entry in the trie under `node`, at level `shift`. Returns the node \
+ * that replaces `node`, `node` itself if it was changed in place or on \
+ * failure. A new node holds it's own references, the caller releases the \
+ * replaced node.*/ \
+static hm_name##_node_t * hm_name##_node_put(hm_name##_node_t *node, bool owned, \
+  unsigned shift, const hm_name##_entry_t *entry, DS_codes_t *res) { \
+  if (node == NULL) { \
+    node = hm_name##_node_alloc(1); \
+    *res = node != NULL ? HMP_ADD : ERR_MEM; \
+    if (node == NULL) return NULL; \
+    if (shift < PERSISTENTMAP_COLLISION_SHIFT) node->datamap = persistentmap_bit(entry->hash, shift); \
+    node->slots[0].entry = *entry; \
+    return node; \
+  } \
+  owned = hm_name##_node_owned(node, owned); \
+  hm_name##_node_t *target; \
+ \
+  uint32_t bit = 0, index = node->count; \
+  if (shift < PERSISTENTMAP_COLLISION_SHIFT) { \
+    bit = persistentmap_bit(entry->hash, shift); \
+    index = persistentmap_index(node, bit); \
+  } else { \
+    for (uint32_t i = 0; i < node->count; i++) { \
+      hm_name##_entry_t *other = &node->slots[i].entry; \
+      if (other->hash == entry->hash && hm_name##_keycmp(&entry->key, &other->key)) index = i; \
+    } \
+  } \
+ \
+  if (shift >= PERSISTENTMAP_COLLISION_SHIFT ? index < node->count : (node->datamap & bit) != 0) { \
+    hm_name##_entry_t *other = &node->slots[index].entry; \
+    if (other->hash == entry->hash && hm_name##_keycmp(&entry->key, &other->key)) { \
+      /* Key exists, set the value. */ \
+      target = owned ? node : hm_name##_node_clone(node); \
+      *res = target != NULL ? HMP_SET : ERR_MEM; \
+      if (target == NULL) return node; \
+      target->slots[index].entry.val = entry->val; \
+      return target; \
+    } \
+    /* Another key has the slot, push both down to a new child. */ \
+    hm_name##_node_t *child = hm_name##_node_pair(other, entry, shift + PERSISTENTMAP_BITS); \
+    target = child == NULL ? NULL : owned ? node : hm_name##_node_clone(node); \
+    if (target == NULL) { \
+      hm_name##_node_release(child); \
+      *res = ERR_MEM; \
+      return node; \
+    } \
+    target->datamap &= ~bit; \
+    target->nodemap |= bit; \
+    target->slots[index].child = child; \
+    *res = HMP_ADD; \
+    return target; \
+  } \
+ \
+  if (node->nodemap & bit) { \
+    hm_name##_node_t *child = node->slots[index].child; \
+    hm_name##_node_t *new_child = hm_name##_node_put(child, owned, \
+      shift + PERSISTENTMAP_BITS, entry, res); \
+    if (new_child == child) return node; \
+    target = owned ? node : hm_name##_node_clone(node); \
+    if (target == NULL) { \
+      hm_name##_node_release(new_child); \
+      *res = ERR_MEM; \
+      return node; \
+    } \
+    target->slots[index].child = new_child; \
+    hm_name##_node_release(child); \
+    return target; \
+  } \
+ \
+  /* An empty slot, or a new key in a collision node. */ \
+  target = hm_name##_node_insert(node, index, bit, entry); \
+  *res = target != NULL ? HMP_ADD : ERR_MEM; \
+  return target != NULL ? target : node; \
+} \
+ \
+DS_codes_t hm_name##_put(hm_name *map, const key_t *key, const val_t *value) { \
+  hm_name##_entry_t entry = { \
+    .key = *key, \
+    .hash = persistentmap_mix((uint64_t)hm_name##_hash(key)), \
+    .val = *value \
+  }; \
+  DS_codes_t res; \
+  hm_name##_node_t *root = hm_name##_node_put(map->root, true, 0, &entry, &res); \
+  if (root != map->root) { \
+    hm_name##_node_release(map->root); \
+    map->root = root; \
+  } \
+  if (res == HMP_ADD) map->size++; \
+  return res; \
+}
+
+#define PersistentMap_has_define(hm_name, key_t, hash_t) \
+bool hm_name##_has(const hm_name *map, const key_t *key) { \
+  uint64_t hash = persistentmap_mix((uint64_t)hm_name##_hash(key)); \
+  return hm_name##_node_find(map->root, key, hash) != NULL; \
+}
+
+#define PersistentMap_get_define(hm_name, key_t, val_t, hash_t) \
+const val_t * hm_name##_get(const hm_name *map, const key_t *key) { \
+  uint64_t hash = persistentmap_mix((uint64_t)hm_name##_hash(key)); \
+  const hm_name##_entry_t *entry = hm_name##_node_find(map->root, key, hash); \
+  return entry != NULL ? &entry->val : NULL; \
+}
+
+#define PersistentMap_remove_define(hm_name, key_t, hash_t) \
+/**Remove a key from the trie under `node`, at level `shift`. Returns the \
+ * node that replaces `node`, NULL if it's left empty, `node` itself if it \
+ * was changed in place or on failure.*/ \
+static hm_name##_node_t * hm_name##_node_remove(hm_name##_node_t *node, bool owned, \
+  unsigned shift, const key_t *key, uint64_t hash, DS_codes_t *res) { \
+  *res = ERR_KEYNOTFOUND; \
+  if (node == NULL) return NULL; \
+  owned = hm_name##_node_owned(node, owned); \
+  hm_name##_node_t *target; \
+ \
+  uint32_t bit = 0, index = node->count; \
+  if (shift < PERSISTENTMAP_COLLISION_SHIFT) { \
+    bit = persistentmap_bit(hash, shift); \
+    index = persistentmap_index(node, bit); \
+    if (node->nodemap & bit) { \
+      hm_name##_node_t *child = node->slots[index].child; \
+      hm_name##_node_t *new_child = hm_name##_node_remove(child, owned, \
+        shift + PERSISTENTMAP_BITS, key, hash, res); \
+      if (*res != DS_SUCCESS) return node; \
+      if (new_child == NULL) { \
+        if (node->count == 1) return NULL; \
+        target = hm_name##_node_erase(node, index, bit); \
+        if (target == NULL) *res = ERR_MEM; \
+        return target != NULL ? target : node; \
+      } \
+      /* A child left with a single entry is pulled up into this node. */ \
+      bool pull = new_child->count == 1 && (new_child->datamap != 0 || \
+        shift + PERSISTENTMAP_BITS >= PERSISTENTMAP_COLLISION_SHIFT); \
+      if (new_child == child && !pull) return node; \
+      target = owned ? node : hm_name##_node_clone(node); \
+      if (target == NULL) { \
+        if (new_child != child) hm_name##_node_release(new_child); \
+        *res = ERR_MEM; \
+        return node; \
+      } \
+      if (pull) { \
+        target->nodemap &= ~bit; \
+        target->datamap |= bit; \
+        target->slots[index].entry = new_child->slots[0].entry; \
+        if (new_child != child) hm_name##_node_release(new_child); \
+      } else { \
+        target->slots[index].child = new_child; \
+      } \
+      hm_name##_node_release(child); \
+      return target; \
+    } \
+    if (!(node->datamap & bit)) return node; \
+    hm_name##_entry_t *entry = &node->slots[index].entry; \
+    if (entry->hash != hash || !hm_name##_keycmp(key, &entry->key)) return node; \
+  } else { \
+    for (uint32_t i = 0; i < node->count; i++) { \
+      hm_name##_entry_t *entry = &node->slots[i].entry; \
+      if (entry->hash == hash && hm_name##_keycmp(key, &entry->key)) index = i; \
+    } \
+    if (index == node->count) return node; \
+  } \
+ \
+  /* The entry is at `index`, remove it's slot. */ \
+  *res = DS_SUCCESS; \
+  if (node->count == 1) return NULL; \
+  target = hm_name##_node_erase(node, index, bit); \
+  if (target == NULL) *res = ERR_MEM; \
+  return target != NULL ? target : node; \
+} \
+ \
+DS_codes_t hm_name##_remove(hm_name *map, const key_t *key) { \
+  uint64_t hash = persistentmap_mix((uint64_t)hm_name##_hash(key)); \
+  DS_codes_t res; \
+  hm_name##_node_t *root = hm_name##_node_remove(map->root, true, 0, key, hash, &res); \
+  if (root != map->root) { \
+    hm_name##_node_release(map->root); \
+    map->root = root; \
+  } \
+  if (res == DS_SUCCESS) map->size--; \
+  return res; \
+}
+
+#define PersistentMap_snapshot_define(hm_name) \
+hm_name##_view_t * hm_name##_snapshot(const hm_name *map) { \
+  hm_name##_view_t *view = malloc(sizeof(hm_name##_view_t)); \
+  if (view == NULL) return NULL; \
+  atomic_init(&view->refs, 1); \
+  view->root = map->root; \
+  view->size = map->size; \
+  if (view->root != NULL) { \
+    atomic_fetch_add_explicit(&view->root->refs, 1, memory_order_relaxed); \
+  } \
+  return view; \
+}
+
+#define PersistentMap_view_has_define(hm_name, key_t, hash_t) \
+bool hm_name##_view_has(const hm_name##_view_t *view, const key_t *key) { \
+  uint64_t hash = persistentmap_mix((uint64_t)hm_name##_hash(key)); \
+  return hm_name##_node_find(view->root, key, hash) != NULL; \
+}
+
+#define PersistentMap_view_get_define(hm_name, key_t, val_t, hash_t) \
+const val_t * hm_name##_view_get(const hm_name##_view_t *view, const key_t *key) { \
+  uint64_t hash = persistentmap_mix((uint64_t)hm_name##_hash(key)); \
+  const hm_name##_entry_t *entry = hm_name##_node_find(view->root, key, hash); \
+  return entry != NULL ? &entry->val : NULL; \
+}
+
+#define PersistentMap_view_for_each_define(hm_name, key_t, val_t) \
+void hm_name##_view_for_each(const hm_name##_view_t *view, \
+  void (*func)(const key_t*, const val_t*, void*), void *ctx) { \
+  hm_name##_node_for_each(view->root, func, ctx); \
+}
+
+#define PersistentMap_view_retain_define(hm_name) \
+hm_name##_view_t * hm_name##_view_retain(hm_name##_view_t *view) { \
+  atomic_fetch_add_explicit(&view->refs, 1, memory_order_relaxed); \
+  return view; \
+}
+
+#define PersistentMap_view_release_define(hm_name) \
+void hm_name##_view_release(hm_name##_view_t *view) { \
+  if (view == NULL) return; \
+  if (atomic_fetch_sub_explicit(&view->refs, 1, memory_order_acq_rel) != 1) return; \
+  hm_name##_node_release(view->root); \
+  free(view); \
+}
+
+#define PersistentMap_free_define(hm_name) \
+void hm_name##_free(hm_name *map) { \
+  if (map == NULL) return; \
+  hm_name##_node_release(map->root); \
+  free(map); \
+}
+
+/* ========================= ALL ========================= */
+
+/**
+ * Generate the declarations for a persistent map data structure for a given
+ * key and value types.
+ * @param hm_name The name to generate the map struct as, and prefix all the
+ * map methods with.
+ * @param key_t The data type of the key for the map.
+ * @param val_t The data type of the value for the map.
+ * @param hash_t The data type of the hash.
+ * @note It's best to put this macro in a header file.
+*/
+#define PersistentMap_declare(hm_name, key_t, val_t, hash_t) \
+PersistentMap_types_declare(hm_name) \
+PersistentMap_hash_declare(hm_name, key_t, hash_t) \
+PersistentMap_keycmp_declare(hm_name, key_t) \
+PersistentMap_new_declare(hm_name) \
+PersistentMap_put_declare(hm_name, key_t, val_t) \
+PersistentMap_has_declare(hm_name, key_t) \
+PersistentMap_get_declare(hm_name, key_t, val_t) \
+PersistentMap_remove_declare(hm_name, key_t) \
+PersistentMap_snapshot_declare(hm_name) \
+PersistentMap_view_has_declare(hm_name, key_t) \
+PersistentMap_view_get_declare(hm_name, key_t, val_t) \
+PersistentMap_view_for_each_declare(hm_name, key_t, val_t) \
+PersistentMap_view_retain_declare(hm_name) \
+PersistentMap_view_release_declare(hm_name) \
+PersistentMap_free_declare(hm_name)
+
+/**
+ * Generate the definitions for the persistent map data structure for a given
+ * key and value types.
+ * @param hm_name The name to generate the map struct as, and prefix all the
+ * map methods with.
+ * @param key_t The data type of the key for the map.
+ * @param val_t The data type of the value for the map.
+ * @param hash_t The data type of the hash.
+ * @param hash A pointer to the hash function for hashing keys.
+ * @param keycmp A pointer to a function for comparing keys.
+ * @note It's best to put this macro in a code file.
+*/
+#define PersistentMap_define(hm_name, key_t, val_t, hash_t, hash, keycmp) \
+PersistentMap_types_define(hm_name, key_t, val_t) \
+PersistentMap_hash_define(hm_name, key_t, hash_t, hash) \
+PersistentMap_keycmp_define(hm_name, key_t, keycmp) \
+PersistentMap_node_define(hm_name, key_t, val_t) \
+PersistentMap_new_define(hm_name) \
+PersistentMap_put_define(hm_name, key_t, val_t, hash_t) \
+PersistentMap_has_define(hm_name, key_t, hash_t) \
+PersistentMap_get_define(hm_name, key_t, val_t, hash_t) \
+PersistentMap_remove_define(hm_name, key_t, hash_t) \
+PersistentMap_snapshot_define(hm_name) \
+PersistentMap_view_has_define(hm_name, key_t, hash_t) \
+PersistentMap_view_get_define(hm_name, key_t, val_t, hash_t) \
+PersistentMap_view_for_each_define(hm_name, key_t, val_t) \
+PersistentMap_view_retain_define(hm_name) \
+PersistentMap_view_release_define(hm_name) \
+PersistentMap_free_define(hm_name)
+
+/**
+ * Generate a full persistent map data structure implementation for a given
+ * key and value types.
+ * @param hm_name The name to generate the map struct as, and prefix all the
+ * map methods with.
+ * @param key_t The data type of the key for the map.
+ * @param val_t The data type of the value for the map.
+ * @param hash_t The data type of the hash.
+ * @param hash A pointer to the hash function for hashing keys.
+ * @param keycmp A pointer to a function for comparing keys.
+ * @note Only one thread may change the map, but any amount of threads can
+ * read snapshots of it at the same time. The keys and values are copied
+ * between versions, for pointer keys or values the map doesn't own what
+ * they point to.
+*/
+#define PersistentMap(hm_name, key_t, val_t, hash_t, hash, keycmp) \
+PersistentMap_declare(hm_name, key_t, val_t, hash_t) \
+PersistentMap_define(hm_name, key_t, val_t, hash_t, hash, keycmp)
+
+#endif
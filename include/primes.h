@@ -4,8 +4,8 @@
 #include<stddef.h>
 
 #define MIN_PRIME (7)
-#define MAX_PRIME (7199369)
-#define PRIME_TOOBIG (primes_size)
+#define MAX_PRIME (2050761299)
+#define PRIME_TOOBIG ((size_t)-1)
 
 /*Because hash functions use primes to compute hashes, prime number sizes work
 well for hash table sizes, taken straight from microsoft's implementation.*/
@@ -19,7 +19,7 @@ const size_t primes[] = {
   36353, 43627, 52361, 62851, 75431, 90523, 108631, 130363, 156437, 187751,
   225307, 270371, 324449, 389357, 467237, 560689, 672827, 807403, 968897,
   1162687, 1395263, 1674319, 2009191, 2411033, 2893249, 3471899, 4166287,
-  4999559, 5999471, 7199369
+  4999559, 5999471, 7199369, ... 2050761299
 };
 */
 
@@ -31,7 +31,7 @@ const extern size_t primes_size;
  * Returns the smallest prime number that's bigger then the specified number.
  * @param num The number to find a prime for.
  * @return The smallest prime number that's bigger then `num`.
- * returns PRIMES_TOOBIG if the number is higher than MAX_PRIME.
+ * returns PRIME_TOOBIG if the number is higher than MAX_PRIME.
 */
 size_t nearest_prime(size_t num);
 
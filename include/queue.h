@@ -0,0 +1,389 @@
+#ifndef __QUEUE_H__
+#define __QUEUE_H__
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<stdatomic.h>
+
+/*Bounded lock free queues for passing elements between threads.
+ *Both are ring buffers of a power of 2 size, their head and tail are counters that only grow,
+ *the index of a counter is it's value masked by the size.
+ *SPSC: one producer thread and one consumer thread.
+ *MPMC: any amount of producer and consumer threads, every slot has a sequence number
+ *that tells which round of the ring it's ready for(Dmitry Vyukov's bounded queue).*/
+
+/*The size of a cache line, the head and the tail of a queue are on different lines.*/
+#define QUEUE_CACHE_LINE 64
+
+/*Returns the smallest power of 2 that's at least 'size', and at least 2.*/
+static inline size_t queue_roundSize(size_t size) {
+	size_t round = 2;
+	while (round < size) round *= 2;
+	return round;
+}
+
+/*Allocates a queue struct, they're aligned to a cache line.*/
+static inline void* queue_allocStruct(size_t size) {
+	return aligned_alloc(QUEUE_CACHE_LINE, (size + QUEUE_CACHE_LINE - 1) / QUEUE_CACHE_LINE * QUEUE_CACHE_LINE);
+}
+
+/* ========================= DECLARATIONS ========================= */
+
+#define Queue_struct_declare(Queue_name) typedef struct Queue_name Queue_name;
+
+#define Queue_new_declare(Queue_name) \
+/** \
+ * Create a new queue that can hold a given amount of elements. \
+ * @param size The maximum amount of elements, rounded up to a power of 2. \
+ * @return A new(malloc'd) queue. \
+*/ \
+Queue_name* Queue_name##_new(size_t size);
+
+#define Queue_enqueue_declare(Queue_name, type) \
+/** \
+ * Adds an element to the back of the queue, if it's not full. \
+ * @param queue The pointer to the queue. \
+ * @param element The element to add. \
+ * @return 1 if the element was added, 0 if the queue is full. \
+*/ \
+int Queue_name##_enqueue(Queue_name* queue, type element);
+
+#define Queue_dequeue_declare(Queue_name, type) \
+/** \
+ * Removes the element at the front of the queue, if it's not empty. \
+ * @param queue The pointer to the queue. \
+ * @param element A pointer to store the removed element in. \
+ * @return 1 if an element was removed, 0 if the queue is empty. \
+*/ \
+int Queue_name##_dequeue(Queue_name* queue, type* element);
+
+#define Queue_enqueueArray_declare(Queue_name, type) \
+/** \
+ * Adds as many elements of an array as fit to the back of the queue, in order. \
+ * The elements are published together, with a single synchronization. \
+ * @param queue The pointer to the queue. \
+ * @param arr The array of elements to add. \
+ * @param size The size of the array. \
+ * @return The amount of elements that were added, from the start of 'arr'. \
+*/ \
+size_t Queue_name##_enqueueArray(Queue_name* queue, const type* arr, size_t size);
+
+#define Queue_dequeueArray_declare(Queue_name, type) \
+/** \
+ * Removes up to a given amount of elements from the front of the queue, in order. \
+ * @param queue The pointer to the queue. \
+ * @param arr The array to store the removed elements in. \
+ * @param size The size of the array, the most elements to remove. \
+ * @return The amount of elements that were removed. \
+*/ \
+size_t Queue_name##_dequeueArray(Queue_name* queue, type* arr, size_t size);
+
+#define Queue_size_declare(Queue_name) \
+/** \
+ * Returns the amount of elements in the queue. \
+ * @param queue The pointer to the queue. \
+ * @return The amount of elements, only a snapshot while other threads use the queue. \
+*/ \
+size_t Queue_name##_size(Queue_name* queue);
+
+#define Queue_delete_declare(Queue_name) \
+/** \
+ * Free all the memory used by the queue. \
+ * @param queue The pointer to the queue. \
+ * @note No thread may use the queue anymore. \
+*/ \
+void Queue_name##_delete(Queue_name* queue);
+
+#define Queue_declare(Queue_name, type) \
+Queue_struct_declare(Queue_name) \
+Queue_new_declare(Queue_name) \
+Queue_enqueue_declare(Queue_name, type) \
+Queue_dequeue_declare(Queue_name, type) \
+Queue_enqueueArray_declare(Queue_name, type) \
+Queue_dequeueArray_declare(Queue_name, type) \
+Queue_size_declare(Queue_name) \
+Queue_delete_declare(Queue_name)
+
+
+/* ========================= SPSC DEFINITIONS ========================= */
+
+
+#define SPSCQueue_struct_define(Queue_name, type) \
+struct Queue_name { \
+	type* _arr; \
+	size_t _mask; \
+	/*the consumer's line, the count of removed elements and the last tail it saw*/ \
+	_Alignas(QUEUE_CACHE_LINE) atomic_size_t _head; \
+	size_t _tailCache; \
+	/*the producer's line, the count of added elements and the last head it saw*/ \
+	_Alignas(QUEUE_CACHE_LINE) atomic_size_t _tail; \
+	size_t _headCache; \
+};
+
+#define SPSCQueue_new_define(Queue_name, type) \
+Queue_name* Queue_name##_new(size_t size) { \
+	Queue_name* queue = (Queue_name*)queue_allocStruct(sizeof(Queue_name)); \
+	if (!queue){ \
+		fprintf(stderr, "Error at Queue_name##_new: malloc returned NULL\n"); \
+		exit(EXIT_FAILURE); \
+	} \
+	size = queue_roundSize(size); \
+	queue->_arr = (type*)malloc(size * sizeof(type)); \
+	if (!queue->_arr){ \
+		fprintf(stderr, "Error at Queue_name##_new: malloc returned NULL\n"); \
+		exit(EXIT_FAILURE); \
+	} \
+	queue->_mask = size - 1; \
+	atomic_init(&queue->_head, 0); \
+	atomic_init(&queue->_tail, 0); \
+	queue->_tailCache = 0; \
+	queue->_headCache = 0; \
+	return queue; \
+}
+
+#define SPSCQueue_enqueueArray_define(Queue_name, type) \
+size_t Queue_name##_enqueueArray(Queue_name* queue, const type* arr, size_t size) { \
+	size_t tail = atomic_load_explicit(&queue->_tail, memory_order_relaxed); \
+	size_t capacity = queue->_mask + 1; \
+	/*only read the consumer's line when the cached head says there's no room*/ \
+	if (capacity - (tail - queue->_headCache) < size) { \
+		queue->_headCache = atomic_load_explicit(&queue->_head, memory_order_acquire); \
+	} \
+	size_t room = capacity - (tail - queue->_headCache); \
+	if (size > room) size = room; \
+	if (!size) return 0; \
+ \
+	size_t index = tail & queue->_mask; \
+	size_t firstSize = capacity - index < size ? capacity - index : size; \
+	memcpy(queue->_arr + index, arr, firstSize * sizeof(type)); \
+	memcpy(queue->_arr, arr + firstSize, (size - firstSize) * sizeof(type)); \
+	atomic_store_explicit(&queue->_tail, tail + size, memory_order_release); \
+	return size; \
+}
+
+#define SPSCQueue_dequeueArray_define(Queue_name, type) \
+size_t Queue_name##_dequeueArray(Queue_name* queue, type* arr, size_t size) { \
+	size_t head = atomic_load_explicit(&queue->_head, memory_order_relaxed); \
+	size_t capacity = queue->_mask + 1; \
+	/*only read the producer's line when the cached tail says there's not enough*/ \
+	if (queue->_tailCache - head < size) { \
+		queue->_tailCache = atomic_load_explicit(&queue->_tail, memory_order_acquire); \
+	} \
+	size_t available = queue->_tailCache - head; \
+	if (size > available) size = available; \
+	if (!size) return 0; \
+ \
+	size_t index = head & queue->_mask; \
+	size_t firstSize = capacity - index < size ? capacity - index : size; \
+	memcpy(arr, queue->_arr + index, firstSize * sizeof(type)); \
+	memcpy(arr + firstSize, queue->_arr, (size - firstSize) * sizeof(type)); \
+	atomic_store_explicit(&queue->_head, head + size, memory_order_release); \
+	return size; \
+}
+
+#define SPSCQueue_enqueue_define(Queue_name, type) \
+int Queue_name##_enqueue(Queue_name* queue, type element) { \
+	size_t tail = atomic_load_explicit(&queue->_tail, memory_order_relaxed); \
+	if (tail - queue->_headCache > queue->_mask) { \
+		queue->_headCache = atomic_load_explicit(&queue->_head, memory_order_acquire); \
+		if (tail - queue->_headCache > queue->_mask) return 0; \
+	} \
+	queue->_arr[tail & queue->_mask] = element; \
+	atomic_store_explicit(&queue->_tail, tail + 1, memory_order_release); \
+	return 1; \
+}
+
+#define SPSCQueue_dequeue_define(Queue_name, type) \
+int Queue_name##_dequeue(Queue_name* queue, type* element) { \
+	size_t head = atomic_load_explicit(&queue->_head, memory_order_relaxed); \
+	if (head == queue->_tailCache) { \
+		queue->_tailCache = atomic_load_explicit(&queue->_tail, memory_order_acquire); \
+		if (head == queue->_tailCache) return 0; \
+	} \
+	*element = queue->_arr[head & queue->_mask]; \
+	atomic_store_explicit(&queue->_head, head + 1, memory_order_release); \
+	return 1; \
+}
+
+#define SPSCQueue_size_define(Queue_name) \
+size_t Queue_name##_size(Queue_name* queue) { \
+	size_t head = atomic_load_explicit(&queue->_head, memory_order_acquire); \
+	return atomic_load_explicit(&queue->_tail, memory_order_acquire) - head; \
+}
+
+#define SPSCQueue_delete_define(Queue_name) \
+void Queue_name##_delete(Queue_name* queue) { \
+	free(queue->_arr); \
+	queue->_arr = NULL; \
+	free(queue); \
+}
+
+#define SPSCQueue_define(Queue_name, type) \
+SPSCQueue_struct_define(Queue_name, type) \
+SPSCQueue_new_define(Queue_name, type) \
+SPSCQueue_enqueue_define(Queue_name, type) \
+SPSCQueue_dequeue_define(Queue_name, type) \
+SPSCQueue_enqueueArray_define(Queue_name, type) \
+SPSCQueue_dequeueArray_define(Queue_name, type) \
+SPSCQueue_size_define(Queue_name) \
+SPSCQueue_delete_define(Queue_name)
+
+
+/* ========================= MPMC DEFINITIONS ========================= */
+
+
+#define MPMCQueue_struct_define(Queue_name, type) \
+typedef struct Queue_name##_slot { \
+	/*equals the position the slot is free for, or the position plus 1 once it's filled*/ \
+	atomic_size_t _seq; \
+	type _data; \
+} Queue_name##_slot; \
+ \
+struct Queue_name { \
+	Queue_name##_slot* _slots; \
+	size_t _mask; \
+	/*the next position to fill, shared by the producers*/ \
+	_Alignas(QUEUE_CACHE_LINE) atomic_size_t _tail; \
+	/*the next position to empty, shared by the consumers*/ \
+	_Alignas(QUEUE_CACHE_LINE) atomic_size_t _head; \
+};
+
+#define MPMCQueue_new_define(Queue_name, type) \
+Queue_name* Queue_name##_new(size_t size) { \
+	Queue_name* queue = (Queue_name*)queue_allocStruct(sizeof(Queue_name)); \
+	if (!queue){ \
+		fprintf(stderr, "Error at Queue_name##_new: malloc returned NULL\n"); \
+		exit(EXIT_FAILURE); \
+	} \
+	size = queue_roundSize(size); \
+	queue->_slots = (Queue_name##_slot*)malloc(size * sizeof(Queue_name##_slot)); \
+	if (!queue->_slots){ \
+		fprintf(stderr, "Error at Queue_name##_new: malloc returned NULL\n"); \
+		exit(EXIT_FAILURE); \
+	} \
+	for (size_t i = 0; i < size; i++) atomic_init(&queue->_slots[i]._seq, i); \
+	queue->_mask = size - 1; \
+	atomic_init(&queue->_tail, 0); \
+	atomic_init(&queue->_head, 0); \
+	return queue; \
+}
+
+#define MPMCQueue_enqueueArray_define(Queue_name, type) \
+size_t Queue_name##_enqueueArray(Queue_name* queue, const type* arr, size_t size) { \
+	size_t pos = atomic_load_explicit(&queue->_tail, memory_order_relaxed); \
+	size_t count; \
+	for (;;) { \
+		/*count the free slots from 'pos', then claim them all at once*/ \
+		for (count = 0; count < size && count <= queue->_mask; count++) { \
+			Queue_name##_slot* slot = &queue->_slots[(pos + count) & queue->_mask]; \
+			size_t seq = atomic_load_explicit(&slot->_seq, memory_order_acquire); \
+			if (seq != pos + count) break; \
+		} \
+		if (!count) { \
+			size_t seq = atomic_load_explicit(&queue->_slots[pos & queue->_mask]._seq, memory_order_acquire); \
+			/*the slot still holds an element of the last round, the queue is full*/ \
+			if ((intptr_t)(seq - pos) < 0) return 0; \
+			pos = atomic_load_explicit(&queue->_tail, memory_order_relaxed); \
+			continue; \
+		} \
+		if (atomic_compare_exchange_weak_explicit(&queue->_tail, &pos, pos + count, \
+			memory_order_relaxed, memory_order_relaxed)) break; \
+	} \
+	for (size_t i = 0; i < count; i++) { \
+		Queue_name##_slot* slot = &queue->_slots[(pos + i) & queue->_mask]; \
+		slot->_data = arr[i]; \
+		atomic_store_explicit(&slot->_seq, pos + i + 1, memory_order_release); \
+	} \
+	return count; \
+}
+
+#define MPMCQueue_dequeueArray_define(Queue_name, type) \
+size_t Queue_name##_dequeueArray(Queue_name* queue, type* arr, size_t size) { \
+	size_t pos = atomic_load_explicit(&queue->_head, memory_order_relaxed); \
+	size_t count; \
+	for (;;) { \
+		/*count the filled slots from 'pos', then claim them all at once*/ \
+		for (count = 0; count < size && count <= queue->_mask; count++) { \
+			Queue_name##_slot* slot = &queue->_slots[(pos + count) & queue->_mask]; \
+			size_t seq = atomic_load_explicit(&slot->_seq, memory_order_acquire); \
+			if (seq != pos + count + 1) break; \
+		} \
+		if (!count) { \
+			size_t seq = atomic_load_explicit(&queue->_slots[pos & queue->_mask]._seq, memory_order_acquire); \
+			/*the slot wasn't filled for this round yet, the queue is empty*/ \
+			if ((intptr_t)(seq - (pos + 1)) < 0) return 0; \
+			pos = atomic_load_explicit(&queue->_head, memory_order_relaxed); \
+			continue; \
+		} \
+		if (atomic_compare_exchange_weak_explicit(&queue->_head, &pos, pos + count, \
+			memory_order_relaxed, memory_order_relaxed)) break; \
+	} \
+	for (size_t i = 0; i < count; i++) { \
+		Queue_name##_slot* slot = &queue->_slots[(pos + i) & queue->_mask]; \
+		arr[i] = slot->_data; \
+		/*free the slot for the next round*/ \
+		atomic_store_explicit(&slot->_seq, pos + i + queue->_mask + 1, memory_order_release); \
+	} \
+	return count; \
+}
+
+#define MPMCQueue_enqueue_define(Queue_name, type) \
+int Queue_name##_enqueue(Queue_name* queue, type element) { \
+	return Queue_name##_enqueueArray(queue, &element, 1) == 1; \
+}
+
+#define MPMCQueue_dequeue_define(Queue_name, type) \
+int Queue_name##_dequeue(Queue_name* queue, type* element) { \
+	return Queue_name##_dequeueArray(queue, element, 1) == 1; \
+}
+
+#define MPMCQueue_size_define(Queue_name) \
+size_t Queue_name##_size(Queue_name* queue) { \
+	size_t head = atomic_load_explicit(&queue->_head, memory_order_acquire); \
+	size_t tail = atomic_load_explicit(&queue->_tail, memory_order_acquire); \
+	/*claimed positions may run ahead of each other while elements move*/ \
+	return tail > head ? tail - head : 0; \
+}
+
+#define MPMCQueue_delete_define(Queue_name) \
+void Queue_name##_delete(Queue_name* queue) { \
+	free(queue->_slots); \
+	queue->_slots = NULL; \
+	free(queue); \
+}
+
+#define MPMCQueue_define(Queue_name, type) \
+MPMCQueue_struct_define(Queue_name, type) \
+MPMCQueue_new_define(Queue_name, type) \
+MPMCQueue_enqueueArray_define(Queue_name, type) \
+MPMCQueue_dequeueArray_define(Queue_name, type) \
+MPMCQueue_enqueue_define(Queue_name, type) \
+MPMCQueue_dequeue_define(Queue_name, type) \
+MPMCQueue_size_define(Queue_name) \
+MPMCQueue_delete_define(Queue_name)
+
+
+/* ========================= ALL ========================= */
+
+
+/**
+ * Generate a bounded queue for one producer thread and one consumer thread.
+ * @param type The type of the elements.
+ * @param Queue_name The name of the queue.
+*/
+#define STRUCT_SPSC_QUEUE(type, Queue_name) \
+Queue_declare(Queue_name, type) \
+SPSCQueue_define(Queue_name, type)
+
+/**
+ * Generate a bounded queue for any amount of producer and consumer threads.
+ * @param type The type of the elements.
+ * @param Queue_name The name of the queue.
+*/
+#define STRUCT_MPMC_QUEUE(type, Queue_name) \
+Queue_declare(Queue_name, type) \
+MPMCQueue_define(Queue_name, type)
+
+#endif
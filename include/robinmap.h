@@ -0,0 +1,350 @@
+#ifndef __ROBIN_MAP_H__
+#define __ROBIN_MAP_H__
+
+/**
+ * @file robinmap.h
+ * @brief An open addressing hash map with Robin Hood hashing, with the same
+ * API as the hash map in hashmap.h. Every slot stores how far it's entry is
+ * from the slot it hashed to, an insert takes the slot of any entry that is
+ * closer to home than itself, which keeps the probe lengths short and even.
+ * A lookup stops as soon as it meets an entry closer to home than the key
+ * would be, so misses end early. Removing shifts the following entries back,
+ * so there are no tombstones.
+*/
+
+#include<stdint.h>
+#include "hashmap.h"
+
+/**The default capacity of a robin map.*/
+#define ROBINMAP_DEFAULT_CAP 8
+/**The maximum load of the map, in eighths, before it grows.*/
+#define ROBINMAP_MAX_LOAD 7
+/**The longest probe distance an entry can have before the map grows.*/
+#define ROBINMAP_MAX_DIST 250
+/**How many times the map doubles to fit its entries before giving up.*/
+#define ROBINMAP_MAX_GROWS 4
+
+/**
+ * Mix the bits of a hash, splitmix64's finalizer.
+ * @param hash The hash to mix.
+ * @return The mixed hash.
+*/
+static inline uint64_t robinmap_mix(uint64_t hash) {
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ull;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebull;
+  hash ^= hash >> 31;
+  return hash;
+}
+
+/**Get the home slot of a hash, the slot the probe starts from.*/
+#define robinmap_home(map, hash) \
+  ((size_t)robinmap_mix((uint64_t)(hash)) & ((map)->cap - 1))
+
+/**
+ * Iterate over every entry in a robin map.
+ * @param map A pointer to the map to iterate over.
+ * @param entry A pointer for iterating over entries.
+ * @param slot An indexer for iterating over slots.
+ * @note Accesses the entries directly, overwriting anything except the value
+ * is unsafe and should not be done.
+*/
+#define robinmap_for_each_entry(map, entry, slot) \
+  for ((slot) = 0; (slot) < (map)->cap; (slot)++) \
+  for ((entry) = (map)->dists[(slot)] ? &(map)->entries[(slot)] : NULL; \
+    (entry) != NULL; (entry) = NULL)
+
+/* ========================= DEFINITIONS ========================= */
+
+#define RobinMap_entry_define(hm_name, key_t, val_t, hash_t) \
+/**Represents an entry in the robin map.*/ \
+struct hm_name##_entry_t { \
+  /**The key of the entry*/ \
+  const key_t key; \
+  /**The hash of the key.*/ \
+  const hash_t key_hash; \
+  /**The value of the entry.*/ \
+  val_t val; \
+};
+
+#define RobinMap_struct_define(hm_name) \
+/**Represents a robin hood hash map data structure.*/ \
+struct hm_name { \
+  /**The slots of the map, all the Key-Value pairs.*/ \
+  hm_name##_entry_t *entries; \
+  /**The probe distance of every slot plus 1, 0 means the slot is empty.*/ \
+  unsigned char *dists; \
+  /**The amount of entries in the map.*/ \
+  size_t size; \
+  /**The amount of slots in the map, a power of 2.*/ \
+  size_t cap; \
+};
+
+#define RobinMap_find_define(hm_name, key_t, hash_t) \
+/**Find the slot of a key, -1 if the key is not in the map.*/ \
+static ssize_t hm_name##_find(const hm_name *map, const key_t *key) { \
+  hash_t hash = hm_name##_hash(key); \
+  size_t mask = map->cap - 1; \
+  size_t i = robinmap_home(map, hash); \
+  /* Stop at the first entry closer to it's home than the key would be. */ \
+  for (unsigned dist = 1; map->dists[i] >= dist; dist++, i = (i + 1) & mask) { \
+    hm_name##_entry_t *entry = map->entries + i; \
+    if (map->dists[i] == dist && entry->key_hash == hash && \
+      hm_name##_keycmp(key, &entry->key)) return i; \
+  } \
+  return -1; \
+}
+
+#define RobinMap_place_define(hm_name) \
+/**Place an entry that is not in the map. Returns false without changing \
+ * the map if some probe distance would get too long, the map has to grow.*/ \
+static bool hm_name##_place(hm_name *map, const hm_name##_entry_t *new_entry) { \
+  size_t mask = map->cap - 1; \
+  size_t i = robinmap_home(map, new_entry->key_hash); \
+  unsigned dist = 1; \
+ \
+  /* Walk the probe first, only the distances decide where it ends. */ \
+  while (map->dists[i] != 0) { \
+    if (map->dists[i] < dist) dist = map->dists[i]; \
+    i = (i + 1) & mask; \
+    if (++dist > ROBINMAP_MAX_DIST) return false; \
+  } \
+ \
+  hm_name##_entry_t carry, swap; \
+  memcpy(&carry, new_entry, sizeof(carry)); \
+  i = robinmap_home(map, carry.key_hash); \
+  dist = 1; \
+  while (map->dists[i] != 0) { \
+    /* Take the slot from an entry that is closer to it's home. */ \
+    if (map->dists[i] < dist) { \
+      unsigned char tmp = map->dists[i]; \
+      map->dists[i] = dist; \
+      dist = tmp; \
+      memcpy(&swap, map->entries + i, sizeof(swap)); \
+      memcpy(map->entries + i, &carry, sizeof(carry)); \
+      memcpy(&carry, &swap, sizeof(carry)); \
+    } \
+    i = (i + 1) & mask; \
+    dist++; \
+  } \
+  map->dists[i] = dist; \
+  memcpy(map->entries + i, &carry, sizeof(carry)); \
+  map->size++; \
+  return true; \
+}
+
+#define RobinMap_init_define(hm_name) \
+DS_codes_t hm_name##_init(hm_name *map, size_t size) { \
+  size_t cap = ROBINMAP_DEFAULT_CAP; \
+  while (cap / 8 * ROBINMAP_MAX_LOAD <= size) cap *= 2; \
+ \
+  map->dists = calloc(cap, sizeof(unsigned char)); \
+  if (map->dists == NULL) return ERR_MEM; \
+  map->entries = malloc(cap * sizeof(hm_name##_entry_t)); \
+  if (map->entries == NULL) { \
+    free(map->dists); \
+    return ERR_MEM; \
+  } \
+  map->size = 0; \
+  map->cap = cap; \
+ \
+  return DS_SUCCESS; \
+}
+
+#define RobinMap_put_define(hm_name, key_t, val_t, hash_t) \
+DS_codes_t hm_name##_put(hm_name *map, const key_t *key, const val_t *value) { \
+  ssize_t i = hm_name##_find(map, key); \
+  if (i != -1) { \
+    map->entries[i].val = *value; \
+    return HMP_SET; \
+  } \
+ \
+  hm_name##_entry_t new_entry = { \
+    .key = *key, \
+    .key_hash = hm_name##_hash(key), \
+    .val = *value \
+  }; \
+  /* Grow when the map is full or the probe gets too long, the entry is \
+   * placed with the others so a failed grow leaves the map as it was. */ \
+  if (map->size + 1 > map->cap / 8 * ROBINMAP_MAX_LOAD || \
+    !hm_name##_place(map, &new_entry)) { \
+    if (map->cap > SIZE_MAX / 2 / sizeof(hm_name##_entry_t)) return ERR_TOOBIG; \
+    DS_codes_t res = hm_name##_rehash(map, map->cap * 2, &new_entry); \
+    if (res != DS_SUCCESS) return res; \
+  } \
+  return HMP_ADD; \
+}
+
+#define RobinMap_has_define(hm_name, key_t) \
+bool hm_name##_has(const hm_name *map, const key_t *key) { \
+  return hm_name##_find(map, key) != -1; \
+}
+
+#define RobinMap_get_define(hm_name, key_t, val_t) \
+val_t * hm_name##_get(const hm_name *map, const key_t *key) { \
+  ssize_t i = hm_name##_find(map, key); \
+  return i != -1 ? &map->entries[i].val : NULL; \
+}
+
+#define RobinMap_remove_define(hm_name, key_t) \
+DS_codes_t hm_name##_remove(hm_name *map, const key_t *key) { \
+  ssize_t i = hm_name##_find(map, key); \
+  if (i == -1) return ERR_KEYNOTFOUND; \
+ \
+  /* Shift back the following entries until one that is at it's home. */ \
+  size_t mask = map->cap - 1; \
+  size_t next = (i + 1) & mask; \
+  while (map->dists[next] > 1) { \
+    map->dists[i] = map->dists[next] - 1; \
+    memcpy(map->entries + i, map->entries + next, sizeof(hm_name##_entry_t)); \
+    i = next; \
+    next = (next + 1) & mask; \
+  } \
+  map->dists[i] = 0; \
+  map->size--; \
+  return DS_SUCCESS; \
+}
+
+#define RobinMap_clear_define(hm_name) \
+void hm_name##_clear(hm_name *map) { \
+  memset(map->dists, 0, map->cap); \
+  map->size = 0; \
+}
+
+#define RobinMap_rehash_define(hm_name) \
+/**Place every entry and an extra one, if it's not NULL, in 'cap' new slots. \
+ * If one of them probes too far try again with twice as many slots, up to \
+ * ROBINMAP_MAX_GROWS times. On failure the map is left as it was.*/ \
+static DS_codes_t hm_name##_rehash(hm_name *map, size_t cap, \
+  const hm_name##_entry_t *extra) { \
+  hm_name old = *map; \
+  for (int grows = 0; ; grows++) { \
+    map->dists = calloc(cap, sizeof(unsigned char)); \
+    map->entries = malloc(cap * sizeof(hm_name##_entry_t)); \
+    if (map->dists == NULL || map->entries == NULL) { \
+      free(map->dists); \
+      free(map->entries); \
+      *map = old; \
+      return ERR_MEM; \
+    } \
+    map->size = 0; \
+    map->cap = cap; \
+ \
+    bool placed = extra == NULL || hm_name##_place(map, extra); \
+    for (size_t i = 0; i < old.cap && placed; i++) { \
+      if (old.dists[i] != 0) placed = hm_name##_place(map, old.entries + i); \
+    } \
+    if (placed) break; \
+    free(map->dists); \
+    free(map->entries); \
+    *map = old; \
+    if (grows == ROBINMAP_MAX_GROWS || \
+      cap > SIZE_MAX / 2 / sizeof(hm_name##_entry_t)) return ERR_TOOBIG; \
+    cap *= 2; \
+  } \
+ \
+  free(old.dists); \
+  free(old.entries); \
+  return DS_SUCCESS; \
+}
+
+#define RobinMap_resize_define(hm_name) \
+DS_codes_t hm_name##_resize(hm_name *map, size_t new_size) { \
+  if (new_size < map->size) return ERR_TOOSMALL; \
+ \
+  size_t cap = ROBINMAP_DEFAULT_CAP; \
+  while (cap / 8 * ROBINMAP_MAX_LOAD <= new_size) { \
+    if (cap > SIZE_MAX / 2 / sizeof(hm_name##_entry_t)) return ERR_TOOBIG; \
+    cap *= 2; \
+  } \
+  return hm_name##_rehash(map, cap, NULL); \
+}
+
+#define RobinMap_destroy_define(hm_name) \
+void hm_name##_destroy(hm_name *map) { \
+  if (map->dists != NULL) free(map->dists); \
+  if (map->entries != NULL) free(map->entries); \
+}
+
+/* ========================= ALL ========================= */
+
+/**
+ * Generate the declarations for a robin hood hash map data structure for a
+ * given key and value types.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @param hash_t The data type of the hash.
+ * @note It's best to put this macro in a header file.
+*/
+#define RobinMap_declare(hm_name, key_t, val_t, hash_t) \
+HashMap_entry_declare(hm_name) \
+HashMap_struct_declare(hm_name) \
+HashMap_hash_declare(hm_name, key_t, hash_t) \
+HashMap_keycmp_declare(hm_name, key_t) \
+HashMap_new_declare(hm_name) \
+HashMap_snew_declare(hm_name) \
+HashMap_init_declare(hm_name) \
+HashMap_put_declare(hm_name, key_t, val_t) \
+HashMap_has_declare(hm_name, key_t) \
+HashMap_get_declare(hm_name, key_t, val_t) \
+HashMap_remove_declare(hm_name, key_t) \
+HashMap_clear_declare(hm_name) \
+HashMap_resize_declare(hm_name) \
+HashMap_destroy_declare(hm_name) \
+HashMap_free_declare(hm_name)
+
+/**
+ * Generate the definitions for the robin hood hash map data structure for a
+ * given key and value types.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @param hash_t The data type of the hash.
+ * @param hash A pointer to the hash function for hashing keys.
+ * @param keycmp A pointer to a function for comparing keys.
+ * @note It's best to put this macro in a code file.
+*/
+#define RobinMap_define(hm_name, key_t, val_t, hash_t, hash, keycmp) \
+RobinMap_entry_define(hm_name, key_t, val_t, hash_t) \
+RobinMap_struct_define(hm_name) \
+HashMap_hash_define(hm_name, key_t, hash_t, hash) \
+HashMap_keycmp_define(hm_name, key_t, keycmp) \
+RobinMap_find_define(hm_name, key_t, hash_t) \
+RobinMap_place_define(hm_name) \
+RobinMap_rehash_define(hm_name) \
+HashMap_new_define(hm_name) \
+HashMap_snew_define(hm_name) \
+RobinMap_init_define(hm_name) \
+RobinMap_put_define(hm_name, key_t, val_t, hash_t) \
+RobinMap_has_define(hm_name, key_t) \
+RobinMap_get_define(hm_name, key_t, val_t) \
+RobinMap_remove_define(hm_name, key_t) \
+RobinMap_clear_define(hm_name) \
+RobinMap_resize_define(hm_name) \
+RobinMap_destroy_define(hm_name) \
+HashMap_free_define(hm_name)
+
+/**
+ * Generate a full robin hood hash map data structure implementation for a
+ * given key and value types. Has the same basic functions as the HashMap
+ * macro, so the two can be swapped by changing the macro. remove_if, retain,
+ * shrink_to_fit, set_auto_shrink and the filter functions are HashMap only.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param key_t The data type of the key for the hash map.
+ * @param val_t The data type of the value for the hash map.
+ * @param hash_t The data type of the hash.
+ * @param hash A pointer to the hash function for hashing keys.
+ * @param keycmp A pointer to a function for comparing keys.
+ * @note Entries move on insert and remove, pointers returned by get() are
+ * only valid until the next put() or remove().
+*/
+#define RobinMap(hm_name, key_t, val_t, hash_t, hash, keycmp) \
+RobinMap_declare(hm_name, key_t, val_t, hash_t) \
+RobinMap_define(hm_name, key_t, val_t, hash_t, hash, keycmp)
+
+#endif
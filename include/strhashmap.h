@@ -0,0 +1,525 @@
+#ifndef __STR_HASH_MAP_H__
+#define __STR_HASH_MAP_H__
+
+/**
+ * @file strhashmap.h
+ * @brief A hash map for string keys that owns it's keys. Keys of up to
+ * STRHASHMAP_INLINE bytes are stored inline in the entry, longer keys store
+ * their length and first bytes in the entry and the rest in an arena owned
+ * by the map. Comparing keys reads the entry itself, and only reaches into
+ * the arena for long keys whose length and prefix already matched, and
+ * putting a key never allocates memory just for it.
+ * The keys are hashed by a built-in hash function, and the map has the same
+ * chained layout and API as the hash map in hashmap.h, with the keys passed
+ * as null terminated strings.
+*/
+
+#include<stdint.h>
+#include "hashmap.h"
+
+/**The longest key that is stored inline in the entry.*/
+#define STRHASHMAP_INLINE 23
+/**The amount of first bytes of a long key that are stored in the entry.*/
+#define STRHASHMAP_PREFIX 8
+/**The initial size of the arena of long keys.*/
+#define STRHASHMAP_ARENA_SIZE 256
+
+/**A string key as it is stored in an entry.*/
+typedef struct strhashmap_key_t {
+  /**The length of the key, without the null terminator.*/
+  uint32_t len;
+  union {
+    /**A short key, the whole key and a null terminator.*/
+    char str[STRHASHMAP_INLINE + 1];
+    /**A long key, where it is in the arena.*/
+    struct {
+      /**The first bytes of the key.*/
+      char prefix[STRHASHMAP_PREFIX];
+      /**The offset of the whole key in the arena.*/
+      size_t offset;
+    } spilled;
+  };
+} strhashmap_key_t;
+
+/**
+ * Hash a string, 64 bit FNV-1a.
+ * @param str The string.
+ * @param len The length of the string.
+ * @return The hash of the string.
+*/
+static inline uint64_t strhashmap_hash(const char *str, size_t len) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= (unsigned char)str[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+/**
+ * Compare a stored key to a string.
+ * @param key The stored key.
+ * @param arena The arena of the map the key is stored in.
+ * @param str The string.
+ * @param len The length of the string.
+ * @return True if the key and the string are equal.
+*/
+static inline bool strhashmap_key_equals(const strhashmap_key_t *key,
+  const char *arena, const char *str, size_t len) {
+  if (key->len != len) return false;
+  if (len <= STRHASHMAP_INLINE) return memcmp(key->str, str, len) == 0;
+  return memcmp(key->spilled.prefix, str, STRHASHMAP_PREFIX) == 0 &&
+    memcmp(arena + key->spilled.offset, str, len) == 0;
+}
+
+/**
+ * Get the key of an entry as a null terminated string.
+ * @param map A pointer to a string hash map.
+ * @param entry A pointer to an entry of the map.
+ * @note A long key is in the arena, the string is only valid until the next
+ * put() or resize().
+*/
+#define strmap_entry_key(map, entry) \
+  ((entry)->key.len <= STRHASHMAP_INLINE ? (entry)->key.str \
+    : (map)->arena + (entry)->key.spilled.offset)
+
+/* ========================= DECLARATIONS ========================= */
+
+#define StrHashMap_put_declare(hm_name, val_t) \
+/** \
+ * Adds or overwrites a key value pair to the map. The map stores a copy of \
+ * the key. \
+ * @param map The hash map. \
+ * @param key The key by which to map the pair, a null terminated string. \
+ * @param value The value to map to the key. \
+ * @return HMP_ADD if a new pair was added, HMP_SET if the key already exists \
+ * and it's paired value was overwritten. An error code on failure. Can only \
+ * while adding a new pair, not when setting. \
+ * @note Errors:  \
+ * ERR_MEM - Memory allocation error. \
+ * ERR_TOOBIG - The key is longer than 4GB. \
+*/ \
+DS_codes_t hm_name##_put(hm_name *map, const char *key, const val_t *value);
+
+#define StrHashMap_has_declare(hm_name) \
+/** \
+ * Check if the map has a specified key stored. \
+ * @param map The hash map. \
+ * @param key The key to search for, a null terminated string. \
+ * @return True if the key is in the map, false otherwise. \
+*/ \
+bool hm_name##_has(const hm_name *map, const char *key);
+
+#define StrHashMap_get_declare(hm_name, val_t) \
+/** \
+ * Get the value mapped to a specified key. \
+ * @param map The hash map. \
+ * @param key The key that the value was mapped to, a null terminated string. \
+ * @return A pointer to the value, or NULL if it was not found. \
+*/ \
+val_t * hm_name##_get(const hm_name *map, const char *key);
+
+#define StrHashMap_remove_declare(hm_name) \
+/** \
+ * Remove the value mapped to a specified key. \
+ * @param map The hash map. \
+ * @param key The key that the value was mapped to, a null terminated string. \
+ * @return DS_SUCCESS on successfull removal, an error code otherwise. \
+ * @note Errors:  \
+ * ERR_KEYNOTFOUND - If the key was not found in the map. \
+*/ \
+DS_codes_t hm_name##_remove(hm_name *map, const char *key);
+
+/* ========================= DEFINITIONS ========================= */
+
+#define StrHashMap_entry_define(hm_name, val_t) \
+/**Represents an entry in the string hash map.*/ \
+struct hm_name##_entry_t { \
+  /**The key of the entry.*/ \
+  strhashmap_key_t key; \
+  /**The hash of the key.*/ \
+  uint64_t key_hash; \
+  /**The index of the next entry in case of hash collisions.*/ \
+  ssize_t next; \
+  /**The value of the entry.*/ \
+  val_t val; \
+};
+
+#define StrHashMap_struct_define(hm_name) \
+/**Represents a string hash map data structure.*/ \
+struct hm_name { \
+  /**The entries of the map, all the Key-Value pairs.*/ \
+  hm_name##_entry_t *entries; \
+  /**An array of indices that maps a normalized hash to an entry index. \
+   * Index -1 means there is no such entry.*/ \
+  ssize_t* buckets; \
+  /**The amount of entries in the map.*/ \
+  size_t size; \
+  /**The next empty cell in the entries array.*/ \
+  size_t next_empty; \
+  /**The maximum capacity of the map.*/ \
+  size_t cap; \
+  /**The long keys of the map, null terminated.*/ \
+  char *arena; \
+  /**The amount of bytes used in the arena.*/ \
+  size_t arena_size; \
+  /**The capacity of the arena.*/ \
+  size_t arena_cap; \
+  /**The amount of bytes in the arena of keys that were removed.*/ \
+  size_t arena_garbage; \
+};
+
+#define StrHashMap_find_define(hm_name) \
+/**Find the index of the entry of a key, -1 if the key is not in the map.*/ \
+static ssize_t hm_name##_find(const hm_name *map, const char *key, size_t len, \
+  uint64_t hash) { \
+  size_t bucket = hash % map->cap; \
+  for (ssize_t i = map->buckets[bucket]; i != -1; i = map->entries[i].next) { \
+    hm_name##_entry_t *entry = map->entries + i; \
+    if (entry->key_hash == hash && \
+      strhashmap_key_equals(&entry->key, map->arena, key, len)) return i; \
+  } \
+  return -1; \
+}
+
+#define StrHashMap_init_define(hm_name) \
+DS_codes_t hm_name##_init(hm_name *map, size_t size) { \
+  size_t initial = nearest_prime(size); \
+ \
+  map->buckets = malloc(initial*sizeof(ssize_t)); \
+  if (map->buckets == NULL) return ERR_MEM; \
+  for(size_t i = 0; i < initial; i++) map->buckets[i] = -1; \
+ \
+  map->entries = malloc(initial*sizeof(hm_name##_entry_t)); \
+  if (map->entries == NULL) { \
+    free(map->buckets); \
+    return ERR_MEM; \
+  } \
+  for(size_t i = 0; i < initial; i++) { \
+    map->entries[i].next = i+1; \
+  } \
+ \
+  map->cap = initial; \
+  map->size = 0; \
+  map->next_empty = 0; \
+  map->arena = NULL; \
+  map->arena_size = 0; \
+  map->arena_cap = 0; \
+  map->arena_garbage = 0; \
+ \
+  return DS_SUCCESS; \
+}
+
+#define StrHashMap_put_define(hm_name, val_t) \
+DS_codes_t hm_name##_put(hm_name *map, const char *key, const val_t *value) { \
+  size_t len = strlen(key); \
+  if (len > UINT32_MAX) return ERR_TOOBIG; \
+  uint64_t hash = strhashmap_hash(key, len); \
+  ssize_t found = hm_name##_find(map, key, len, hash); \
+  if (found != -1) { \
+    map->entries[found].val = *value; \
+    return HMP_SET; \
+  } \
+ \
+  /* Copy the key, a long key to the end of the arena. */ \
+  strhashmap_key_t stored; \
+  stored.len = len; \
+  if (len <= STRHASHMAP_INLINE) { \
+    memcpy(stored.str, key, len + 1); \
+  } else { \
+    /* Drop the removed keys before growing the arena, so churn doesn't grow it. */ \
+    if (map->arena_size + len + 1 > map->arena_cap && map->arena_garbage > map->arena_size / 2) { \
+      DS_codes_t res = hm_name##_compact(map); \
+      if (res != DS_SUCCESS) return res; \
+    } \
+    if (map->arena_size + len + 1 > map->arena_cap) { \
+      size_t arena_cap = map->arena_cap ? map->arena_cap : STRHASHMAP_ARENA_SIZE; \
+      while (map->arena_size + len + 1 > arena_cap) arena_cap *= 2; \
+      char *arena = realloc(map->arena, arena_cap); \
+      if (arena == NULL) return ERR_MEM; \
+      map->arena = arena; \
+      map->arena_cap = arena_cap; \
+    } \
+    memcpy(stored.spilled.prefix, key, STRHASHMAP_PREFIX); \
+    stored.spilled.offset = map->arena_size; \
+    memcpy(map->arena + map->arena_size, key, len + 1); \
+    map->arena_size += len + 1; \
+  } \
+ \
+  /* Reserve the next empty slot, and set the next empty to be the "next next". */ \
+  size_t bucket = hash % map->cap; \
+  size_t empty = map->next_empty; \
+  hm_name##_entry_t *entry = map->entries + empty; \
+  map->next_empty = entry->next; \
+  entry->key = stored; \
+  entry->key_hash = hash; \
+  entry->next = map->buckets[bucket]; \
+  entry->val = *value; \
+  map->buckets[bucket] = empty; \
+ \
+  /* Check if resize needed. */ \
+  map->size++; \
+  if (map->size == map->cap) { \
+    DS_codes_t res = hm_name##_resize(map, map->cap + 1); \
+    if (res != DS_SUCCESS) return res; \
+  } \
+ \
+  return HMP_ADD; \
+}
+
+#define StrHashMap_has_define(hm_name) \
+bool hm_name##_has(const hm_name *map, const char *key) { \
+  size_t len = strlen(key); \
+  return hm_name##_find(map, key, len, strhashmap_hash(key, len)) != -1; \
+}
+
+#define StrHashMap_get_define(hm_name, val_t) \
+val_t * hm_name##_get(const hm_name *map, const char *key) { \
+  size_t len = strlen(key); \
+  ssize_t i = hm_name##_find(map, key, len, strhashmap_hash(key, len)); \
+  return i != -1 ? &map->entries[i].val : NULL; \
+}
+
+#define StrHashMap_remove_define(hm_name) \
+DS_codes_t hm_name##_remove(hm_name *map, const char *key) { \
+  size_t len = strlen(key); \
+  uint64_t hash = strhashmap_hash(key, len); \
+  size_t bucket = hash % map->cap; \
+  ssize_t prev = -1; \
+ \
+  for (ssize_t i = map->buckets[bucket]; i != -1; i = map->entries[i].next) { \
+    hm_name##_entry_t *entry = map->entries + i; \
+    /* Exact Match Found. Key exists at i. */ \
+    if (entry->key_hash == hash && \
+      strhashmap_key_equals(&entry->key, map->arena, key, len)) { \
+      /* Unlink entry from the bucket. */ \
+      if (prev == -1) map->buckets[bucket] = entry->next; \
+      else map->entries[prev].next = entry->next; \
+      /* The arena space of a long key is reclaimed by the next compaction. */ \
+      if (len > STRHASHMAP_INLINE) map->arena_garbage += len + 1; \
+      /* Set the entry's index as the next empty slot. */ \
+      entry->next = map->next_empty; \
+      map->next_empty = i; \
+      map->size--; \
+      return DS_SUCCESS; \
+    } \
+    prev = i; \
+  } \
+ \
+  return ERR_KEYNOTFOUND; \
+}
+
+#define StrHashMap_clear_define(hm_name) \
+void hm_name##_clear(hm_name *map) { \
+  for (size_t i = 0; i < map->cap; i++) { \
+    map->buckets[i] = -1; \
+    map->entries[i].next = i + 1; \
+  } \
+  map->next_empty = 0; \
+  map->size = 0; \
+  map->arena_size = 0; \
+  map->arena_garbage = 0; \
+}
+
+#define StrHashMap_compact_define(hm_name) \
+/**Move the long keys to a new arena without the removed keys.*/ \
+static DS_codes_t hm_name##_compact(hm_name *map) { \
+  size_t arena_cap = STRHASHMAP_ARENA_SIZE; \
+  while (arena_cap < map->arena_size - map->arena_garbage) arena_cap *= 2; \
+  char *arena = malloc(arena_cap); \
+  if (arena == NULL) return ERR_MEM; \
+ \
+  size_t arena_size = 0; \
+  for (size_t b = 0; b < map->cap; b++) { \
+    for (ssize_t i = map->buckets[b]; i != -1; i = map->entries[i].next) { \
+      strhashmap_key_t *key = &map->entries[i].key; \
+      if (key->len <= STRHASHMAP_INLINE) continue; \
+      memcpy(arena + arena_size, map->arena + key->spilled.offset, key->len + 1); \
+      key->spilled.offset = arena_size; \
+      arena_size += key->len + 1; \
+    } \
+  } \
+ \
+  free(map->arena); \
+  map->arena = arena; \
+  map->arena_size = arena_size; \
+  map->arena_cap = arena_cap; \
+  map->arena_garbage = 0; \
+  return DS_SUCCESS; \
+}
+
+#define StrHashMap_shrink_define(hm_name) \
+/**Resize the map to a smaller capacity, the entries at indices past the new \
+ * capacity are moved to empty entries below it.*/ \
+static DS_codes_t hm_name##_shrink(hm_name *map, size_t new_size) { \
+  ssize_t *new_buckets = malloc(new_size * sizeof(ssize_t)); \
+  bool *used = calloc(map->cap, sizeof(bool)); \
+  if (new_buckets == NULL || used == NULL) { \
+    free(new_buckets); \
+    free(used); \
+    return ERR_MEM; \
+  } \
+  for (size_t i = 0; i < new_size; i++) new_buckets[i] = -1; \
+  for (size_t b = 0; b < map->cap; b++) { \
+    for (ssize_t i = map->buckets[b]; i != -1; i = map->entries[i].next) used[i] = true; \
+  } \
+ \
+  /* Relink every entry to the new buckets, moving the entries past the new \
+   * capacity to the empty entries below it. */ \
+  size_t empty = 0; \
+  for (size_t b = 0; b < map->cap; b++) { \
+    while (map->buckets[b] != -1) { \
+      ssize_t entry_pos = map->buckets[b]; \
+      hm_name##_entry_t *entry = &map->entries[entry_pos]; \
+      map->buckets[b] = entry->next; \
+      if ((size_t)entry_pos >= new_size) { \
+        while (used[empty]) empty++; \
+        used[empty] = true; \
+        map->entries[empty] = *entry; \
+        entry_pos = empty; \
+        entry = &map->entries[entry_pos]; \
+      } \
+      size_t bucket = entry->key_hash % new_size; \
+      entry->next = new_buckets[bucket]; \
+      new_buckets[bucket] = entry_pos; \
+    } \
+  } \
+ \
+  /* Chain the empty entries below the new capacity. */ \
+  ssize_t next_empty = new_size; \
+  for (size_t i = new_size; i-- > 0;) { \
+    if (used[i]) continue; \
+    map->entries[i].next = next_empty; \
+    next_empty = i; \
+  } \
+  map->next_empty = next_empty; \
+  free(used); \
+ \
+  /* If the smaller block can't be had, keep the bigger one. */ \
+  hm_name##_entry_t *tmp = realloc(map->entries, new_size * sizeof(hm_name##_entry_t)); \
+  if (tmp != NULL) map->entries = tmp; \
+  free(map->buckets); \
+  map->buckets = new_buckets; \
+  map->cap = new_size; \
+  return DS_SUCCESS; \
+}
+
+#define StrHashMap_resize_define(hm_name) \
+DS_codes_t hm_name##_resize(hm_name *map, size_t new_size) { \
+  if (new_size < map->size) return ERR_TOOSMALL; \
+ \
+  /* Drop the removed keys from the arena once they're most of it. */ \
+  if (map->arena_garbage > map->arena_size / 2) { \
+    DS_codes_t res = hm_name##_compact(map); \
+    if (res != DS_SUCCESS) return res; \
+  } \
+ \
+  /* Find the next prime size, it has to leave room for the next put. */ \
+  new_size = nearest_prime(new_size); \
+  if (new_size != PRIME_TOOBIG && new_size <= map->size) { \
+    new_size = nearest_prime(map->size + 1); \
+  } \
+  if (new_size == PRIME_TOOBIG) return ERR_TOOBIG; \
+  if (new_size < map->cap) return hm_name##_shrink(map, new_size); \
+  /* Resize entries. */ \
+  hm_name##_entry_t *tmp = realloc(map->entries, new_size * sizeof(hm_name##_entry_t)); \
+  if (tmp == NULL) return ERR_MEM; \
+  map->entries = tmp; \
+  for (size_t i = map->cap; i < new_size; i++) map->entries[i].next = i + 1; \
+ \
+  /* Allocate new buckets. */ \
+  ssize_t *new_buckets = malloc(new_size * sizeof(ssize_t)); \
+  if (new_buckets == NULL) return ERR_MEM; \
+  for (size_t i = 0; i < new_size; i++) new_buckets[i] = -1; \
+ \
+  /* Relink every entry to it's bucket in the new buckets. */ \
+  for (size_t i = 0; i < map->cap; i++) { \
+    while (map->buckets[i] != -1) { \
+      ssize_t entry_pos = map->buckets[i]; \
+      hm_name##_entry_t *entry = &map->entries[entry_pos]; \
+      size_t bucket = entry->key_hash % new_size; \
+      map->buckets[i] = entry->next; \
+      entry->next = new_buckets[bucket]; \
+      new_buckets[bucket] = entry_pos; \
+    } \
+  } \
+ \
+  map->cap = new_size; \
+  free(map->buckets); \
+  map->buckets = new_buckets; \
+  return DS_SUCCESS; \
+}
+
+#define StrHashMap_destroy_define(hm_name) \
+void hm_name##_destroy(hm_name *map) { \
+  if (map->buckets != NULL) free(map->buckets); \
+  if (map->entries != NULL) free(map->entries); \
+  if (map->arena != NULL) free(map->arena); \
+}
+
+/* ========================= ALL ========================= */
+
+/**
+ * Generate the declarations for a string hash map data structure for a given
+ * value type.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param val_t The data type of the value for the hash map.
+ * @note It's best to put this macro in a header file.
+*/
+#define StrHashMap_declare(hm_name, val_t) \
+HashMap_entry_declare(hm_name) \
+HashMap_struct_declare(hm_name) \
+HashMap_new_declare(hm_name) \
+HashMap_snew_declare(hm_name) \
+HashMap_init_declare(hm_name) \
+StrHashMap_put_declare(hm_name, val_t) \
+StrHashMap_has_declare(hm_name) \
+StrHashMap_get_declare(hm_name, val_t) \
+StrHashMap_remove_declare(hm_name) \
+HashMap_clear_declare(hm_name) \
+HashMap_resize_declare(hm_name) \
+HashMap_destroy_declare(hm_name) \
+HashMap_free_declare(hm_name)
+
+/**
+ * Generate the definitions for the string hash map data structure for a
+ * given value type.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param val_t The data type of the value for the hash map.
+ * @note It's best to put this macro in a code file.
+*/
+#define StrHashMap_define(hm_name, val_t) \
+StrHashMap_entry_define(hm_name, val_t) \
+StrHashMap_struct_define(hm_name) \
+StrHashMap_find_define(hm_name) \
+HashMap_new_define(hm_name) \
+HashMap_snew_define(hm_name) \
+StrHashMap_init_define(hm_name) \
+StrHashMap_compact_define(hm_name) \
+StrHashMap_shrink_define(hm_name) \
+StrHashMap_put_define(hm_name, val_t) \
+StrHashMap_has_define(hm_name) \
+StrHashMap_get_define(hm_name, val_t) \
+StrHashMap_remove_define(hm_name) \
+StrHashMap_clear_define(hm_name) \
+StrHashMap_resize_define(hm_name) \
+StrHashMap_destroy_define(hm_name) \
+HashMap_free_define(hm_name)
+
+/**
+ * Generate a full string hash map data structure implementation for a given
+ * value type. The keys are null terminated strings that the map copies, no
+ * hash or compare functions are needed.
+ * @param hm_name The name to generate the hash map struct as, and prefix
+ * all the hash map methods with.
+ * @param val_t The data type of the value for the hash map.
+ * @note The entries can be iterated with map_for_each_entry from hashmap.h,
+ * and their keys read with strmap_entry_key.
+*/
+#define StrHashMap(hm_name, val_t) \
+StrHashMap_declare(hm_name, val_t) \
+StrHashMap_define(hm_name, val_t)
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef __STRSORT_H__
+#define __STRSORT_H__
+
+/**
+ * @file strsort.h
+ * @brief Sort arrays and lists of strings, in the order of strcmp(). A
+ * multikey quicksort on 8 bytes of the strings at a time: the 8 bytes at the
+ * current depth of every string are cached as an integer next to it's
+ * pointer, the strings are partitioned by the cached integers, and only the
+ * strings that are equal so far are read again, 8 bytes deeper. So a common
+ * prefix is read once per string instead of once per comparison, and the
+ * partitioning doesn't chase the pointers.
+*/
+
+#include<stddef.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include "errors.h"
+
+/**
+ * Sort an array of strings in place, in the order of strcmp().
+ * @param strings The array of strings, none of them NULL.
+ * @param size The amount of strings.
+ * @return DS_SUCCESS on success, an error code on failure.
+ * @note Errors:
+ * ERR_MEM - Failed to allocate the cache of the strings, the array is
+ * unchanged.
+ * @note The sort isn't stable, equal strings may change their order.
+*/
+DS_codes_t ds_strsort(char **strings, size_t size);
+
+/**
+ * Generate List_name##_sortStrings() for a list of strings, that sorts the
+ * list in place with ds_strsort().
+ * @param List_name The name of the list, generated with STRUCT_LIST(char*, List_name).
+ * @note The program must be linked with strsort.c.
+*/
+#define LIST_SORT_STRINGS(List_name) \
+/** \
+ * Sorts the list of strings in place, in the order of strcmp(). \
+ * @param list The pointer to the list, none of it's strings NULL. \
+*/ \
+void List_name##_sortStrings(List_name* list); \
+void List_name##_sortStrings(List_name* list) { \
+  if (ds_strsort(list->_arr, list->_size) != DS_SUCCESS) { \
+    fprintf(stderr, "Error at List_name##_sortStrings: malloc returned NULL\n"); \
+    exit(EXIT_FAILURE); \
+  } \
+}
+
+#endif
@@ -0,0 +1,154 @@
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "bigalloc.h"
+
+/**The header before every block, right before the pointer that's returned.*/
+typedef struct bigalloc_header_t {
+  /**The size that was requested.*/
+  size_t size;
+  /**The length of the mapping of a mapped block, 0 for a block from malloc.*/
+  size_t mapped;
+} bigalloc_header_t;
+
+/**The offset of a mapped block from the start of it's mapping, a cache line
+ * so the block stays cache line aligned.*/
+#define BIGALLOC_MAP_OFFSET 64
+
+/* The memory policies of mbind, from linux/mempolicy.h. */
+#define BIGALLOC_MPOL_INTERLEAVE 3
+#define BIGALLOC_MPOL_LOCAL 4
+/**The most NUMA nodes an interleave spreads over.*/
+#define BIGALLOC_MAX_NODES 64
+
+static size_t bigalloc_threshold = DS_BIGALLOC_THRESHOLD;
+static ds_numa_policy_t bigalloc_numa = DS_NUMA_DEFAULT;
+
+void ds_bigalloc_set_threshold(size_t threshold) {
+  bigalloc_threshold = threshold ? threshold : DS_BIGALLOC_THRESHOLD;
+}
+
+void ds_bigalloc_set_numa(ds_numa_policy_t policy) {
+  bigalloc_numa = policy;
+}
+
+static inline bigalloc_header_t* bigalloc_header(void *ptr) {
+  return (bigalloc_header_t*)ptr - 1;
+}
+
+/**The length of the mapping for a block of `size` bytes.*/
+static inline size_t bigalloc_map_length(size_t size) {
+  return (size + BIGALLOC_MAP_OFFSET + DS_BIGALLOC_HUGE_PAGE - 1) &
+    ~(DS_BIGALLOC_HUGE_PAGE - 1);
+}
+
+/**Advise huge pages for a mapping, and apply the NUMA policy. Both are
+ * hints, failures are ignored.*/
+static void bigalloc_advise(void *base, size_t length) {
+#ifdef MADV_HUGEPAGE
+  madvise(base, length, MADV_HUGEPAGE);
+#endif
+#ifdef SYS_mbind
+  if (bigalloc_numa == DS_NUMA_INTERLEAVE) {
+    unsigned long nodes = ~0ul;
+    syscall(SYS_mbind, base, length, BIGALLOC_MPOL_INTERLEAVE, &nodes,
+      BIGALLOC_MAX_NODES + 1, 0);
+  } else if (bigalloc_numa == DS_NUMA_LOCAL) {
+    syscall(SYS_mbind, base, length, BIGALLOC_MPOL_LOCAL, NULL, 0, 0);
+  }
+#endif
+}
+
+/**Map `length` bytes aligned to a huge page. Returns NULL on failure.*/
+static char* bigalloc_reserve(size_t length) {
+  /* Map a huge page more, and trim the unaligned head and the tail. */
+  char *raw = mmap(NULL, length + DS_BIGALLOC_HUGE_PAGE, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) return NULL;
+  char *base = (char*)(((uintptr_t)raw + DS_BIGALLOC_HUGE_PAGE - 1) &
+    ~(DS_BIGALLOC_HUGE_PAGE - 1));
+  if (base != raw) munmap(raw, base - raw);
+  munmap(base + length, raw + DS_BIGALLOC_HUGE_PAGE - base);
+  return base;
+}
+
+/**Map a block, aligned to a huge page. Returns the block, not the mapping.*/
+static void* bigalloc_map(size_t size) {
+  size_t length = bigalloc_map_length(size);
+  if (length < size) return NULL;
+  char *base = bigalloc_reserve(length);
+  if (!base) return NULL;
+  bigalloc_advise(base, length);
+
+  void *ptr = base + BIGALLOC_MAP_OFFSET;
+  bigalloc_header(ptr)->size = size;
+  bigalloc_header(ptr)->mapped = length;
+  return ptr;
+}
+
+void* ds_bigalloc(size_t size) {
+  if (size >= bigalloc_threshold) return bigalloc_map(size);
+  if (size > SIZE_MAX - sizeof(bigalloc_header_t)) return NULL;
+  bigalloc_header_t *header = malloc(sizeof(bigalloc_header_t) + size);
+  if (!header) return NULL;
+  header->size = size;
+  header->mapped = 0;
+  return header + 1;
+}
+
+void* ds_bigrealloc(void *ptr, size_t size) {
+  if (!ptr) return ds_bigalloc(size);
+  bigalloc_header_t *header = bigalloc_header(ptr);
+  bool big = size >= bigalloc_threshold;
+
+  if (!header->mapped && !big) {
+    if (size > SIZE_MAX - sizeof(bigalloc_header_t)) return NULL;
+    header = realloc(header, sizeof(bigalloc_header_t) + size);
+    if (!header) return NULL;
+    header->size = size;
+    return header + 1;
+  }
+#ifdef MREMAP_FIXED
+  if (header->mapped && big) {
+    size_t length = bigalloc_map_length(size);
+    if (length < size) return NULL;
+    size_t mapped = header->mapped;
+    char *base = (char*)ptr - BIGALLOC_MAP_OFFSET;
+    if (length != mapped && mremap(base, mapped, length, 0) == MAP_FAILED) {
+      /* It can't grow in place, move it to an aligned mapping. The kernel
+       * moves the pages, the contents are not copied. */
+      char *dest = bigalloc_reserve(length);
+      if (!dest) return NULL;
+      if (mremap(base, mapped, length, MREMAP_MAYMOVE | MREMAP_FIXED, dest) ==
+        MAP_FAILED) {
+        munmap(dest, length);
+        return NULL;
+      }
+      base = dest;
+    }
+    if (length > mapped) bigalloc_advise(base, length);
+    ptr = base + BIGALLOC_MAP_OFFSET;
+    bigalloc_header(ptr)->size = size;
+    bigalloc_header(ptr)->mapped = length;
+    return ptr;
+  }
+#endif
+
+  /* Moving between malloc and a mapping, copy. */
+  void *block = ds_bigalloc(size);
+  if (!block) return NULL;
+  memcpy(block, ptr, header->size < size ? header->size : size);
+  ds_bigfree(ptr);
+  return block;
+}
+
+void ds_bigfree(void *ptr) {
+  if (!ptr) return;
+  bigalloc_header_t *header = bigalloc_header(ptr);
+  if (header->mapped) munmap((char*)ptr - BIGALLOC_MAP_OFFSET, header->mapped);
+  else free(header);
+}
@@ -0,0 +1,48 @@
+#include <pthread.h>
+#include <unistd.h>
+#include "parallel.h"
+
+/**The arguments of a thread of a parallel operation.*/
+typedef struct parallel_thread_t {
+  ds_parallel_task_t task;
+  size_t thread;
+  size_t nthreads;
+  void *context;
+} parallel_thread_t;
+
+/**Start routine of the threads, unpacks the arguments and runs the task.*/
+static void* parallel_start(void *arg) {
+  parallel_thread_t *args = arg;
+  args->task(args->thread, args->nthreads, args->context);
+  return NULL;
+}
+
+size_t ds_parallel_threads(size_t nthreads) {
+  if (nthreads == 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = cpus > 0 ? (size_t)cpus : 1;
+  }
+  if (nthreads > DS_PARALLEL_MAX_THREADS) nthreads = DS_PARALLEL_MAX_THREADS;
+  return nthreads;
+}
+
+void ds_parallel_run(size_t nthreads, ds_parallel_task_t task, void *context) {
+  if (nthreads <= 1) {
+    task(0, 1, context);
+    return;
+  }
+  if (nthreads > DS_PARALLEL_MAX_THREADS) nthreads = DS_PARALLEL_MAX_THREADS;
+
+  pthread_t threads[DS_PARALLEL_MAX_THREADS];
+  parallel_thread_t args[DS_PARALLEL_MAX_THREADS];
+  size_t started;
+  for (started = 1; started < nthreads; started++) {
+    args[started] = (parallel_thread_t){task, started, nthreads, context};
+    if (pthread_create(&threads[started], NULL, parallel_start, &args[started]) != 0) break;
+  }
+
+  /* The threads that could not be started run on the calling thread. */
+  for (size_t i = started; i < nthreads; i++) task(i, nthreads, context);
+  task(0, nthreads, context);
+  for (size_t i = 1; i < started; i++) pthread_join(threads[i], NULL);
+}
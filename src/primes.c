@@ -7,7 +7,13 @@ const size_t primes[] = {
   36353, 43627, 52361, 62851, 75431, 90523, 108631, 130363, 156437, 187751,
   225307, 270371, 324449, 389357, 467237, 560689, 672827, 807403, 968897,
   1162687, 1395263, 1674319, 2009191, 2411033, 2893249, 3471899, 4166287,
-  4999559, 5999471, 7199369
+  4999559, 5999471, 7199369,
+  /* Extended past microsoft's table, each about 1.2 times the previous. */
+  8639249, 10367101, 12440521, 14928637, 17914367, 21497257, 25796711,
+  30956053, 37147273, 44576759, 53492113, 64190537, 77028659, 92434393,
+  110921273, 133105543, 159726653, 191671993, 230006431, 276007757, 331209331,
+  397451207, 476941459, 572329759, 686795723, 824154901, 988985923,
+  1186783133, 1424139767, 1708967731, 2050761299
 };
 
 const size_t primes_size = sizeof(primes) / sizeof(size_t);
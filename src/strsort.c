@@ -0,0 +1,158 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "strsort.h"
+
+/**Partitions of at most this many strings are sorted with insertion sort.*/
+#define STRSORT_INSERTION 16
+/**The amount of bytes of a string that are cached.*/
+#define STRSORT_CACHE 8
+
+/**A string and the bytes of it at the current depth.*/
+typedef struct strsort_item_t {
+  /**The bytes, big endian so integers compare like the bytes, and 0 past
+   * the end of the string. The lowest byte is 0 if the string ends here.*/
+  uint64_t key;
+  char *str;
+} strsort_item_t;
+
+/**Read the cached bytes of a string, from a depth it's at least as long as.*/
+static inline uint64_t strsort_key(const char *str) {
+  uint64_t key = 0;
+  for (int i = 0; i < STRSORT_CACHE; i++) {
+    unsigned char c = str[i];
+    key |= (uint64_t)c << (8 * (STRSORT_CACHE - 1 - i));
+    if (c == 0) break;
+  }
+  return key;
+}
+
+static inline void strsort_swap(strsort_item_t *a, strsort_item_t *b) {
+  strsort_item_t tmp = *a;
+  *a = *b;
+  *b = tmp;
+}
+
+/**Is item `a` before item `b`, their bytes before `depth` are equal.*/
+static inline int strsort_less(const strsort_item_t *a, const strsort_item_t *b,
+  size_t depth) {
+  if (a->key != b->key) return a->key < b->key;
+  if ((a->key & 0xff) == 0) return 0;
+  return strcmp(a->str + depth + STRSORT_CACHE, b->str + depth + STRSORT_CACHE) < 0;
+}
+
+static void strsort_insertion(strsort_item_t *items, size_t size, size_t depth) {
+  for (size_t i = 1; i < size; i++) {
+    strsort_item_t item = items[i];
+    size_t j = i;
+    for (; j > 0 && strsort_less(&item, &items[j - 1], depth); j--) {
+      items[j] = items[j - 1];
+    }
+    items[j] = item;
+  }
+}
+
+/**The median of the keys of 3 items.*/
+static inline uint64_t strsort_median(uint64_t a, uint64_t b, uint64_t c) {
+  if (a < b) return b < c ? b : a < c ? c : a;
+  return a < c ? a : b < c ? c : b;
+}
+
+static void strsort_sift_down(strsort_item_t *items, size_t root, size_t size,
+  size_t depth) {
+  strsort_item_t item = items[root];
+  for (size_t child; (child = 2 * root + 1) < size; root = child) {
+    if (child + 1 < size && strsort_less(&items[child], &items[child + 1], depth)) child++;
+    if (!strsort_less(&item, &items[child], depth)) break;
+    items[root] = items[child];
+  }
+  items[root] = item;
+}
+
+/**The fallback of partitions that split badly too many times.*/
+static void strsort_heapsort(strsort_item_t *items, size_t size, size_t depth) {
+  for (size_t i = size / 2; i-- > 0;) strsort_sift_down(items, i, size, depth);
+  for (size_t end = size; end-- > 1;) {
+    strsort_swap(&items[0], &items[end]);
+    strsort_sift_down(items, 0, end, depth);
+  }
+}
+
+/**The amount of partitions a range of `size` items gets before it's sorted
+ * with heapsort, 2 log2(size) like an introsort.*/
+static inline size_t strsort_budget(size_t size) {
+  size_t budget = 0;
+  while (size >>= 1) budget += 2;
+  return budget;
+}
+
+/**Cache the bytes of the strings 8 bytes deeper than `depth`.*/
+static inline void strsort_deeper(strsort_item_t *items, size_t size, size_t depth) {
+  for (size_t i = 0; i < size; i++) {
+    items[i].key = strsort_key(items[i].str + depth + STRSORT_CACHE);
+  }
+}
+
+/**Sort items whose strings are equal before `depth`, and whose keys are
+ * the bytes at `depth`. Recurses into the smaller partitions and loops on the
+ * biggest, so the stack is at most log2(size) deep, and turns to heapsort
+ * when the range runs out of it's `budget` of partitions.*/
+static void strsort_mkqs(strsort_item_t *items, size_t size, size_t depth,
+  size_t budget) {
+  while (size > STRSORT_INSERTION) {
+    if (budget == 0) {
+      strsort_heapsort(items, size, depth);
+      return;
+    }
+    budget--;
+    uint64_t pivot = strsort_median(items[0].key, items[size / 2].key,
+      items[size - 1].key);
+
+    /* Split to less than, equal to and greater than the pivot. */
+    size_t lt = 0, i = 0, gt = size;
+    while (i < gt) {
+      if (items[i].key < pivot) strsort_swap(&items[lt++], &items[i++]);
+      else if (items[i].key > pivot) strsort_swap(&items[i], &items[--gt]);
+      else i++;
+    }
+    strsort_item_t *less = items, *equal = items + lt, *greater = items + gt;
+    size_t less_size = lt, greater_size = size - gt;
+    /* The equal strings all ended, or they're sorted by their next bytes. */
+    size_t equal_size = (pivot & 0xff) == 0 ? 0 : gt - lt;
+    if (equal_size > 0) strsort_deeper(equal, equal_size, depth);
+
+    if (equal_size >= less_size && equal_size >= greater_size) {
+      strsort_mkqs(less, less_size, depth, budget);
+      strsort_mkqs(greater, greater_size, depth, budget);
+      items = equal;
+      size = equal_size;
+      depth += STRSORT_CACHE;
+      budget = strsort_budget(size);
+      continue;
+    }
+    strsort_mkqs(equal, equal_size, depth + STRSORT_CACHE, strsort_budget(equal_size));
+    if (less_size >= greater_size) {
+      strsort_mkqs(greater, greater_size, depth, budget);
+      size = less_size;
+    } else {
+      strsort_mkqs(less, less_size, depth, budget);
+      items = greater;
+      size = greater_size;
+    }
+  }
+  strsort_insertion(items, size, depth);
+}
+
+DS_codes_t ds_strsort(char **strings, size_t size) {
+  if (size < 2) return DS_SUCCESS;
+  strsort_item_t *items = malloc(size * sizeof(strsort_item_t));
+  if (!items) return ERR_MEM;
+  for (size_t i = 0; i < size; i++) {
+    items[i].key = strsort_key(strings[i]);
+    items[i].str = strings[i];
+  }
+  strsort_mkqs(items, size, 0, strsort_budget(size));
+  for (size_t i = 0; i < size; i++) strings[i] = items[i].str;
+  free(items);
+  return DS_SUCCESS;
+}
@@ -0,0 +1,109 @@
+#include<stdio.h>
+#include<stdint.h>
+#include<assert.h>
+#include<sys/mman.h>
+#define DS_BIGALLOC
+#include "hashmap.h"
+#include "list.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+unsigned long hash(const unsigned long *key) { return *key * 2654435761ul; }
+bool keycmp(const unsigned long *key1, const unsigned long *key2) {
+  return *key1 == *key2;
+}
+
+HashMap(Rows, unsigned long, long, unsigned long, hash, keycmp)
+STRUCT_LIST(long, ListLong)
+
+/* Small enough that the tests cross it, without using much memory. */
+#define TEST_THRESHOLD ((size_t)1 << 20)
+
+void test_blocks();
+void test_list();
+void test_map();
+
+int main() {
+  ds_bigalloc_set_threshold(TEST_THRESHOLD);
+  ds_bigalloc_set_numa(DS_NUMA_INTERLEAVE);
+  printf("Testing blocks:\n");
+  test_blocks();
+  printf("Testing a list:\n");
+  test_list();
+  printf("Testing a hash map:\n");
+  test_map();
+  printf("done!\n");
+  return 0;
+}
+
+static bool check_pattern(const unsigned char *block, size_t size) {
+  for (size_t i = 0; i < size; i++) if (block[i] != (unsigned char)(i * 7)) return false;
+  return true;
+}
+
+void test_blocks() {
+  unsigned char *block = ds_bigalloc(1000);
+  myassert(block != NULL && (uintptr_t)block % 16 == 0);
+  for (size_t i = 0; i < 1000; i++) block[i] = i * 7;
+
+  /* From malloc to a mapping, then a bigger mapping, then back. */
+  block = ds_bigrealloc(block, 3 * TEST_THRESHOLD);
+  myassert(block != NULL && (uintptr_t)block % 64 == 0);
+  myassert(check_pattern(block, 1000));
+  for (size_t i = 0; i < 3 * TEST_THRESHOLD; i++) block[i] = i * 7;
+  /* Take the pages after the mapping, so it has to move to grow, and stays
+   * aligned to a huge page when it does. */
+  char *end = (char*)(((uintptr_t)block + 3 * TEST_THRESHOLD + DS_BIGALLOC_HUGE_PAGE - 1) &
+    ~(uintptr_t)(DS_BIGALLOC_HUGE_PAGE - 1));
+  void *blocker = mmap(end, 4096, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+  block = ds_bigrealloc(block, 9 * TEST_THRESHOLD);
+  myassert(block != NULL && check_pattern(block, 3 * TEST_THRESHOLD));
+  myassert(((uintptr_t)block - 64) % DS_BIGALLOC_HUGE_PAGE == 0);
+  if (blocker != MAP_FAILED) munmap(blocker, 4096);
+  block = ds_bigrealloc(block, 2 * TEST_THRESHOLD);
+  myassert(block != NULL && check_pattern(block, 2 * TEST_THRESHOLD));
+  block = ds_bigrealloc(block, 500);
+  myassert(block != NULL && check_pattern(block, 500));
+  ds_bigfree(block);
+  ds_bigfree(NULL);
+
+  block = ds_bigrealloc(NULL, TEST_THRESHOLD);
+  myassert(block != NULL && (uintptr_t)block % 64 == 0);
+  DS_FREE(block);
+}
+
+void test_list() {
+  ListLong *list = ListLong_new();
+  size_t n = 4 * TEST_THRESHOLD / sizeof(long);
+  for (size_t i = 0; i < n; i++) ListLong_add(list, i);
+  long values[] = {-1, -2, -3};
+  ListLong_insertArray(list, values, 3, 10);
+  ListLong_insert(list, -4, 0);
+  bool ok = list->_size == n + 4 && list->_arr[0] == -4 && list->_arr[11] == -1;
+  for (size_t i = 14; i < n + 4; i++) ok &= list->_arr[i] == (long)i - 4;
+  myassert(ok);
+  ListLong_delete(list);
+}
+
+void test_map() {
+  Rows *map = Rows_new();
+  size_t n = 200000;
+  for (unsigned long key = 0; key < n; key++) {
+    long val = key * 3;
+    Rows_put(map, &key, &val);
+  }
+  myassert(map->cap * sizeof(Rows_entry_t) >= TEST_THRESHOLD);
+  for (unsigned long key = 0; key < n; key += 2) Rows_remove(map, &key);
+  myassert(Rows_shrink_to_fit(map) == DS_SUCCESS);
+  bool ok = map->size == n / 2;
+  for (unsigned long key = 0; key < n; key++) {
+    long *val = Rows_get(map, &key);
+    ok &= key % 2 ? val != NULL && *val == (long)key * 3 : val == NULL;
+  }
+  myassert(ok);
+  Rows_free(map);
+}
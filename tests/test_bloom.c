@@ -0,0 +1,130 @@
+#include<stdio.h>
+#include<assert.h>
+#include "hashmap.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+unsigned long hash(const unsigned long *key) { return *key; }
+bool keycmp(const unsigned long *key1, const unsigned long *key2) {
+  return *key1 == *key2;
+}
+
+HashMap(Ids, unsigned long, int, unsigned long, hash, keycmp)
+
+#define COUNT 100000
+
+void test_filter();
+void test_map();
+void test_map_remove();
+
+int main() {
+  printf("Testing the filter:\n");
+  test_filter();
+  printf("Testing a map with a filter:\n");
+  test_map();
+  printf("Testing removing from a map with a filter:\n");
+  test_map_remove();
+  printf("All tests passed!\n");
+  return 0;
+}
+
+void test_filter() {
+  BloomFilter *filter = BloomFilter_new(COUNT, 0);
+  myassert(filter != NULL);
+  myassert(filter->bits_per_key == BLOOM_DEFAULT_BITS_PER_KEY);
+  myassert(((uintptr_t)filter->blocks % 64) == 0);
+
+  for (uint64_t i = 0; i < COUNT; i++) BloomFilter_add(filter, i);
+  myassert(filter->count == COUNT);
+
+  bool all = true;
+  for (uint64_t i = 0; i < COUNT; i++) all = all && BloomFilter_may_contain(filter, i);
+  myassert(all);
+
+  size_t false_positives = 0;
+  for (uint64_t i = COUNT; i < 2 * COUNT; i++) {
+    false_positives += BloomFilter_may_contain(filter, i);
+  }
+  printf("False positives: %zu of %d\n", false_positives, COUNT);
+  myassert(false_positives < COUNT / 20);
+
+  BloomFilter_clear(filter);
+  myassert(filter->count == 0);
+  myassert(!BloomFilter_may_contain(filter, 1));
+  BloomFilter_free(filter);
+}
+
+void test_map() {
+  Ids *map = Ids_new();
+  myassert(Ids_enable_filter(map, 0) == DS_SUCCESS);
+  myassert(map->filter != NULL);
+
+  /* Grows through many resizes, each one rebuilds the filter. */
+  for (unsigned long i = 0; i < COUNT; i++) {
+    unsigned long key = i * 2;
+    int val = i;
+    Ids_put(map, &key, &val);
+  }
+  myassert(map->filter->count == COUNT);
+
+  bool ok = true;
+  size_t filtered = 0;
+  for (unsigned long i = 0; i < 2 * COUNT; i++) {
+    int *val = Ids_get(map, &i);
+    if (i % 2 == 0) ok = ok && val != NULL && *val == (int)(i / 2) && Ids_has(map, &i);
+    else ok = ok && val == NULL && !Ids_has(map, &i);
+    if (i % 2 == 1) filtered += !BloomFilter_may_contain(map->filter, i);
+  }
+  myassert(ok);
+  printf("Misses answered by the filter: %zu of %d\n", filtered, COUNT);
+  myassert(filtered > COUNT * 9 / 10);
+
+  Ids_clear(map);
+  unsigned long key = 4;
+  myassert(!Ids_has(map, &key));
+  myassert(map->filter->count == 0);
+
+  Ids_disable_filter(map);
+  myassert(map->filter == NULL);
+  int val = 1;
+  Ids_put(map, &key, &val);
+  myassert(Ids_has(map, &key));
+  Ids_free(map);
+}
+
+void test_map_remove() {
+  Ids *map = Ids_new();
+  for (unsigned long i = 0; i < COUNT; i++) {
+    int val = i;
+    Ids_put(map, &i, &val);
+  }
+  /* Enabling a filter on a full map adds all it's keys. */
+  myassert(Ids_enable_filter(map, 16) == DS_SUCCESS);
+  myassert(map->filter->count == COUNT);
+
+  for (unsigned long i = 0; i < COUNT; i += 2) {
+    Ids_remove(map, &i);
+  }
+  /* Enough removals to rebuild the filter without the removed keys. */
+  myassert(map->filter->count < COUNT);
+  myassert(map->filter->stale < map->cap / 4 + 1);
+
+  bool ok = true;
+  for (unsigned long i = 0; i < COUNT; i++) {
+    ok = ok && Ids_has(map, &i) == (i % 2 == 1);
+  }
+  myassert(ok);
+
+  /* Shrinking moves entries and rebuilds the filter for the new capacity. */
+  myassert(Ids_shrink_to_fit(map) == DS_SUCCESS);
+  myassert(map->filter->count == map->size);
+  for (unsigned long i = 0; i < COUNT; i++) {
+    ok = ok && Ids_has(map, &i) == (i % 2 == 1);
+  }
+  myassert(ok);
+  Ids_free(map);
+}
@@ -0,0 +1,95 @@
+#include<stdio.h>
+#include<assert.h>
+#include "cuckoomap.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+unsigned long hash(const int *key) {
+  return (unsigned long)*key;
+}
+bool keycmp(const int *key1, const int *key2) {
+  return *key1 == *key2;
+}
+
+CuckooMap(Acl, int, int, unsigned long, hash, keycmp)
+
+void test_basic();
+void test_random();
+
+int main() {
+  printf("Testing basic operations:\n");
+  test_basic();
+  printf("Testing random operations:\n");
+  test_random();
+  printf("done!\n");
+  return 0;
+}
+
+void test_basic() {
+  Acl map;
+  int key, val;
+  myassert(Acl_init(&map, 0) == DS_SUCCESS);
+
+  key = 1; val = 10;
+  myassert(Acl_put(&map, &key, &val) == HMP_ADD);
+  val = 11;
+  myassert(Acl_put(&map, &key, &val) == HMP_SET);
+  myassert(*Acl_get(&map, &key) == 11);
+  key = 2;
+  myassert(!Acl_has(&map, &key) && Acl_get(&map, &key) == NULL);
+  myassert(Acl_remove(&map, &key) == ERR_KEYNOTFOUND);
+  key = 1;
+  myassert(Acl_remove(&map, &key) == DS_SUCCESS);
+  myassert(!Acl_has(&map, &key) && map.size == 0);
+
+  for (key = 0; key < 1000; key++) Acl_put(&map, &key, &key);
+  myassert(map.size == 1000);
+  size_t count = 0, slot;
+  Acl_entry_t *entry;
+  cuckoomap_for_each_entry(&map, entry, slot) {
+    assert(entry->key == entry->val);
+    count++;
+  }
+  myassert(count == 1000);
+  myassert(Acl_resize(&map, 10) == ERR_TOOSMALL);
+  myassert(Acl_resize(&map, 1000) == DS_SUCCESS);
+  for (key = 0; key < 1000; key++) assert(*Acl_get(&map, &key) == key);
+  myassert((double)map.size / map.cap > 0.45);
+
+  Acl_clear(&map);
+  key = 5;
+  myassert(map.size == 0 && !Acl_has(&map, &key));
+  Acl_destroy(&map);
+}
+
+void test_random() {
+  enum { N = 20000 };
+  static int present[N], values[N];
+  Acl *map = Acl_new();
+  unsigned long long seed = 42;
+
+  for (int i = 0; i < 400000; i++) {
+    seed = seed * 6364136223846793005u + 1442695040888963407u;
+    int key = (seed >> 33) % N, op = (seed >> 20) % 3, val = i;
+    if (op == 0) {
+      assert(Acl_remove(map, &key) == (present[key] ? DS_SUCCESS : ERR_KEYNOTFOUND));
+      present[key] = 0;
+    } else {
+      assert(Acl_put(map, &key, &val) == (present[key] ? HMP_SET : HMP_ADD));
+      present[key] = 1;
+      values[key] = val;
+    }
+  }
+  size_t size = 0;
+  for (int key = 0; key < N; key++) {
+    int *val = Acl_get(map, &key);
+    assert(present[key] ? val != NULL && *val == values[key] : val == NULL);
+    size += present[key];
+  }
+  myassert(map->size == size);
+  Acl_free(map);
+}
@@ -0,0 +1,104 @@
+#include<stdio.h>
+#include<assert.h>
+#include<stdbool.h>
+#include "deque.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+STRUCT_DEQUE(int, DequeInt)
+
+void test_basic();
+void test_segments();
+void test_random();
+
+int main() {
+  printf("Testing basic operations:\n");
+  test_basic();
+  printf("Testing segments:\n");
+  test_segments();
+  printf("Testing random operations:\n");
+  test_random();
+  printf("done!\n");
+  return 0;
+}
+
+void test_basic() {
+  DequeInt *deque = DequeInt_news(5);
+  myassert(deque->_maxSize == 8);
+  for (int i = 0; i < 4; i++) DequeInt_pushBack(deque, i);
+  for (int i = 1; i <= 4; i++) DequeInt_pushFront(deque, -i);
+  myassert(DequeInt_size(deque) == 8 && deque->_maxSize == 8);
+  /* -4 -3 -2 -1 0 1 2 3, then it grows. */
+  DequeInt_pushFront(deque, -5);
+  myassert(deque->_maxSize == 16);
+  bool ok = true;
+  for (int i = 0; i < 9; i++) ok &= DequeInt_get(deque, i) == i - 5;
+  myassert(ok);
+  DequeInt_set(deque, 100, 0);
+  myassert(*DequeInt_at(deque, 0) == 100);
+  myassert(DequeInt_popFront(deque) == 100);
+  myassert(DequeInt_popBack(deque) == 3);
+  myassert(DequeInt_size(deque) == 7);
+  DequeInt_clear(deque);
+  myassert(DequeInt_size(deque) == 0);
+  DequeInt_delete(deque);
+}
+
+void test_segments() {
+  DequeInt *deque = DequeInt_news(8);
+  for (int i = 0; i < 6; i++) DequeInt_pushBack(deque, i);
+  for (int i = 0; i < 4; i++) DequeInt_popFront(deque);
+  int values[] = {6, 7, 8, 9};
+  DequeInt_pushArray(deque, values, 4);
+  myassert(deque->_maxSize == 8);
+
+  int *first, *second;
+  size_t firstSize, secondSize;
+  DequeInt_segments(deque, &first, &firstSize, &second, &secondSize);
+  myassert(firstSize == 4 && secondSize == 2);
+  myassert(first[0] == 4 && first[3] == 7 && second[0] == 8 && second[1] == 9);
+
+  /* Growing keeps the order of wrapped elements. */
+  int more[20];
+  for (int i = 0; i < 20; i++) more[i] = 10 + i;
+  DequeInt_pushArray(deque, more, 20);
+  bool ok = DequeInt_size(deque) == 26;
+  for (int i = 0; i < 26; i++) ok &= DequeInt_get(deque, i) == i + 4;
+  myassert(ok);
+  DequeInt_segments(deque, &first, &firstSize, &second, &secondSize);
+  myassert(firstSize + secondSize == 26);
+  DequeInt_delete(deque);
+}
+
+void test_random() {
+  /* A plain array in the middle of a big buffer, as the expected deque. */
+  static int expected[40000];
+  size_t front = 20000, back = 20000;
+  DequeInt *deque = DequeInt_news(1);
+  bool ok = true;
+  srand(3);
+  for (int op = 0; op < 50000; op++) {
+    int value = rand();
+    switch (rand() % 5) {
+      case 0: DequeInt_pushBack(deque, value); expected[back++] = value; break;
+      case 1: DequeInt_pushFront(deque, value); expected[--front] = value; break;
+      case 2: if (back > front) ok &= DequeInt_popBack(deque) == expected[--back]; break;
+      case 3: if (back > front) ok &= DequeInt_popFront(deque) == expected[front++]; break;
+      case 4: {
+        int values[3] = {value, value + 1, value + 2};
+        DequeInt_pushArray(deque, values, 3);
+        memcpy(expected + back, values, sizeof(values));
+        back += 3;
+      }
+    }
+    if (front < 3 || back > 40000 - 3) break;
+  }
+  ok &= DequeInt_size(deque) == back - front;
+  for (size_t i = 0; i < back - front; i++) ok &= DequeInt_get(deque, i) == expected[front + i];
+  myassert(ok);
+  DequeInt_delete(deque);
+}
@@ -0,0 +1,132 @@
+#include<stdio.h>
+#include<assert.h>
+#include "expiremap.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+unsigned long hash(const int *key) {
+  return (unsigned long)*key * 2654435761u;
+}
+bool keycmp(const int *key1, const int *key2) {
+  return *key1 == *key2;
+}
+
+ExpireMap(Sessions, int, int, unsigned long, hash, keycmp)
+
+void test_advance();
+void test_batches();
+void test_random();
+void test_shrink();
+
+int main() {
+  printf("Testing advance:\n");
+  test_advance();
+  printf("Testing batches:\n");
+  test_batches();
+  printf("Testing random deadlines:\n");
+  test_random();
+  printf("Testing shrinking:\n");
+  test_shrink();
+  printf("done!\n");
+  return 0;
+}
+
+void test_advance() {
+  Sessions *map = Sessions_new();
+  int keys[8], vals[8], key, val;
+
+  key = 1; val = 10;
+  myassert(Sessions_put(map, &key, &val, 5) == HMP_ADD);
+  key = 2; val = 20;
+  myassert(Sessions_put(map, &key, &val, 100) == HMP_ADD);
+  key = 3; val = 30;
+  myassert(Sessions_put(map, &key, &val, EXPIREMAP_NEVER) == HMP_ADD);
+  key = 4; val = 40;
+  myassert(Sessions_put(map, &key, &val, 1 << 30) == HMP_ADD);
+
+  myassert(Sessions_advance(map, 4, keys, vals, 8) == 0);
+  myassert(Sessions_advance(map, 5, keys, vals, 8) == 1);
+  myassert(keys[0] == 1 && vals[0] == 10);
+  key = 1;
+  myassert(!Sessions_has(map, &key));
+
+  key = 2;
+  myassert(Sessions_set_deadline(map, &key, 1000) == DS_SUCCESS);
+  myassert(Sessions_advance(map, 999, keys, vals, 8) == 0);
+  myassert(Sessions_advance(map, 5000, keys, NULL, 8) == 1);
+  myassert(keys[0] == 2);
+
+  key = 4;
+  myassert(Sessions_remove(map, &key) == DS_SUCCESS);
+  myassert(Sessions_advance(map, (uint64_t)1 << 40, keys, NULL, 8) == 0);
+  myassert(map->size == 1 && map->now == (uint64_t)1 << 40);
+  key = 5;
+  myassert(Sessions_set_deadline(map, &key, 0) == ERR_KEYNOTFOUND);
+  Sessions_free(map);
+}
+
+void test_batches() {
+  Sessions *map = Sessions_new();
+  int keys[16], seen[100] = {0};
+
+  for (int i = 0; i < 100; i++) Sessions_put(map, &i, &i, 50 + i % 3);
+  size_t total = 0, count;
+  while ((count = Sessions_advance(map, 60, keys, NULL, 16)) > 0) {
+    assert(count <= 16);
+    for (size_t i = 0; i < count; i++) seen[keys[i]]++;
+    total += count;
+  }
+  myassert(total == 100 && map->size == 0);
+  for (int i = 0; i < 100; i++) assert(seen[i] == 1);
+  Sessions_free(map);
+}
+
+void test_random() {
+  enum { N = 5000 };
+  static uint64_t deadlines[N];
+  static int alive[N];
+  Sessions *map = Sessions_new();
+  int keys[64];
+  uint64_t now = 0, seed = 12345;
+
+  for (int i = 0; i < N; i++) {
+    seed = seed * 6364136223846793005u + 1442695040888963407u;
+    deadlines[i] = (seed >> 33) % ((seed >> 20 & 1) ? 300 : 30000000);
+    alive[i] = 1;
+    Sessions_put(map, &i, &i, deadlines[i]);
+  }
+  while (map->size > 0) {
+    seed = seed * 6364136223846793005u + 1442695040888963407u;
+    now += (seed >> 33) % 100000;
+    size_t count;
+    while ((count = Sessions_advance(map, now, keys, NULL, 64)) > 0) {
+      for (size_t i = 0; i < count; i++) {
+        assert(alive[keys[i]] && deadlines[keys[i]] <= now);
+        alive[keys[i]] = 0;
+      }
+    }
+    for (int i = 0; i < N; i++) assert(alive[i] == (deadlines[i] > now));
+  }
+  myassert(map->size == 0);
+  Sessions_free(map);
+}
+
+void test_shrink() {
+  Sessions *map = Sessions_new();
+  int keys[128], seen[1000] = {0};
+  for (int i = 0; i < 1000; i++) Sessions_put(map, &i, &i, 10 + i % 7);
+  for (int i = 0; i < 900; i++) Sessions_remove(map, &i);
+  /* The entries left are at the end of the array, shrinking moves them. */
+  myassert(Sessions_resize(map, 100) == DS_SUCCESS);
+  myassert(map->cap < 1000 && map->size == 100);
+
+  size_t count = Sessions_advance(map, 100, keys, NULL, 128);
+  myassert(count == 100 && map->size == 0);
+  for (size_t i = 0; i < count; i++) seen[keys[i]]++;
+  for (int i = 0; i < 1000; i++) assert(seen[i] == (i >= 900));
+  Sessions_free(map);
+}
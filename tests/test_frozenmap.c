@@ -0,0 +1,106 @@
+#include<stdio.h>
+#include<assert.h>
+#include "frozenmap.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+typedef const char* str_t;
+
+long long hash(const str_t *key) {
+  long long hash = 0;
+  const char *k = *key;
+  for (; *k; k++) {
+    hash = hash * 31 + *k;
+  }
+  return hash;
+}
+bool keycmp(const str_t *key1, const str_t *key2) {
+  return !strcmp(*key1, *key2);
+}
+
+HashMap(Keywords, str_t, int, long long, hash, keycmp)
+FrozenMap(Keywords, str_t, int)
+
+void write_key(FILE *out, const str_t *key) { fprintf(out, "\"%s\"", *key); }
+void write_val(FILE *out, const int *val) { fprintf(out, "%d", *val); }
+
+void test_keywords();
+void test_many();
+void test_empty();
+
+int main() {
+  printf("Testing keywords:\n");
+  test_keywords();
+  printf("Testing many keys:\n");
+  test_many();
+  printf("Testing empty map:\n");
+  test_empty();
+  printf("done!\n");
+  return 0;
+}
+
+void test_keywords() {
+  static str_t words[] = {
+    "if", "else", "while", "for", "do", "switch", "case", "default", "break",
+    "continue", "return", "goto", "struct", "union", "enum", "typedef"
+  };
+  const size_t count = sizeof(words) / sizeof(*words);
+  Keywords *map = Keywords_new();
+  for (int i = 0; i < count; i++) Keywords_put(map, &words[i], &i);
+
+  Keywords_frozen_t *frozen = Keywords_freeze(map);
+  myassert(frozen != NULL && frozen->size == count);
+  for (int i = 0; i < count; i++) {
+    const int *val = Keywords_frozen_get(frozen, &words[i]);
+    assert(val != NULL && *val == i);
+  }
+  const char *key = "sizeof";
+  myassert(!Keywords_frozen_has(frozen, &key));
+  key = "i";
+  myassert(Keywords_frozen_get(frozen, &key) == NULL);
+
+  FILE *out = tmpfile();
+  myassert(Keywords_frozen_write_c(frozen, out, "keywords", write_key, write_val) == DS_SUCCESS);
+  myassert(ftell(out) > 0);
+  fclose(out);
+  myassert(Keywords_frozen_write_c(frozen, NULL, "keywords", write_key, write_val) == ERR_NULL);
+
+  Keywords_frozen_free(frozen);
+  Keywords_free(map);
+}
+
+void test_many() {
+  enum { N = 100000 };
+  static char names[N][8];
+  static str_t keys[N];
+  Keywords *map = Keywords_snew(N);
+  for (int i = 0; i < N; i++) {
+    sprintf(names[i], "k%d", i);
+    keys[i] = names[i];
+    Keywords_put(map, &keys[i], &i);
+  }
+
+  Keywords_frozen_t *frozen = Keywords_freeze(map);
+  myassert(frozen != NULL && frozen->size == N);
+  for (int i = 0; i < N; i++) {
+    const int *val = Keywords_frozen_get(frozen, &keys[i]);
+    assert(val != NULL && *val == i);
+  }
+  const char *key = "k-1";
+  myassert(!Keywords_frozen_has(frozen, &key));
+  Keywords_frozen_free(frozen);
+  Keywords_free(map);
+}
+
+void test_empty() {
+  Keywords *map = Keywords_new();
+  Keywords_frozen_t *frozen = Keywords_freeze(map);
+  const char *key = "if";
+  myassert(frozen != NULL && !Keywords_frozen_has(frozen, &key));
+  Keywords_frozen_free(frozen);
+  Keywords_free(map);
+}
@@ -22,6 +22,8 @@ void primes_test();
 void hashmap_test();
 void hashmap_forEachTest();
 void hashmap_forEachTest2();
+void hashmap_removeIfTest();
+void hashmap_shrinkTest();
 void hashmap_print(const HashMap_name *map);
 
 int main(int argc, char const *argv[]) {
@@ -29,6 +31,8 @@ int main(int argc, char const *argv[]) {
   hashmap_test();
   hashmap_forEachTest();
   hashmap_forEachTest2();
+  hashmap_removeIfTest();
+  hashmap_shrinkTest();
   return 0;
 }
 
@@ -209,6 +213,85 @@ void hashmap_forEachTest2() {
   HashMap_name_destroy(&map);
 }
 
+bool is_below(const char **key, int *val, void *ctx) {
+  return *val < *(int*)ctx;
+}
+
+void hashmap_removeIfTest() {
+  HashMap_name *map = HashMap_name_new();
+  static char keys[100][8];
+  for (int i = 0; i < 100; i++) {
+    sprintf(keys[i], "k%d", i);
+    const char *key = keys[i];
+    HashMap_name_put(map, &key, &i);
+  }
+
+  int limit = 30;
+  size_t removed = HashMap_name_remove_if(map, is_below, &limit);
+  printf("remove_if(val < 30): removed %zd, size %zd\n", removed, map->size);
+  limit = 80;
+  removed = HashMap_name_retain(map, is_below, &limit);
+  printf("retain(val < 80): removed %zd, size %zd\n", removed, map->size);
+
+  size_t i, count = 0;
+  HashMap_name_entry_t *entry;
+  map_for_each_entry(map, entry, i) {
+    if (entry->val < 30 || entry->val >= 80) printf("Wrong entry: %s\n", entry->key);
+    count++;
+  }
+  printf("Entries left: %zd\n", count);
+
+  /* The removed entries are reused by put. */
+  for (int i = 0; i < 30; i++) {
+    const char *key = keys[i];
+    HashMap_name_put(map, &key, &i);
+  }
+  printf("After putting back 30: size %zd, cap %zd\n", map->size, map->cap);
+  HashMap_name_free(map);
+}
+
+void hashmap_shrinkTest() {
+  HashMap_name *map = HashMap_name_new();
+  static char keys[5000][8];
+  for (int i = 0; i < 5000; i++) {
+    sprintf(keys[i], "k%d", i);
+    const char *key = keys[i];
+    HashMap_name_put(map, &key, &i);
+  }
+  printf("Filled: size %zd, cap %zd\n", map->size, map->cap);
+  for (int i = 0; i < 4990; i++) {
+    const char *key = keys[i];
+    HashMap_name_remove(map, &key);
+  }
+  printf("Removed: size %zd, cap %zd\n", map->size, map->cap);
+  HashMap_name_shrink_to_fit(map);
+  printf("shrink_to_fit: size %zd, cap %zd\n", map->size, map->cap);
+  for (int i = 4990; i < 5000; i++) {
+    const char *key = keys[i];
+    int *val = HashMap_name_get(map, &key);
+    if (val == NULL || *val != i) printf("Lost entry: %s\n", key);
+  }
+
+  /* With auto shrink, the capacity follows the size down. */
+  HashMap_name_set_auto_shrink(map, true);
+  for (int i = 0; i < 5000; i++) {
+    const char *key = keys[i];
+    HashMap_name_put(map, &key, &i);
+  }
+  printf("Auto shrink, filled: size %zd, cap %zd\n", map->size, map->cap);
+  for (int i = 0; i < 4990; i++) {
+    const char *key = keys[i];
+    HashMap_name_remove(map, &key);
+  }
+  printf("Auto shrink, removed: size %zd, cap %zd\n", map->size, map->cap);
+  for (int i = 4990; i < 5000; i++) {
+    const char *key = keys[i];
+    int *val = HashMap_name_get(map, &key);
+    if (val == NULL || *val != i) printf("Lost entry: %s\n", key);
+  }
+  HashMap_name_free(map);
+}
+
 void hashmap_print(const HashMap_name *map) {
   printf("Hash Map:\n");
   printf("\tBuckets: [");
@@ -0,0 +1,97 @@
+#include<stdio.h>
+#include<assert.h>
+#include "hashmap_build.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+unsigned long hash(const unsigned long *key) { return *key * 2654435761ul; }
+bool keycmp(const unsigned long *key1, const unsigned long *key2) {
+  return *key1 == *key2;
+}
+
+HashMap(Rows, unsigned long, long, unsigned long, hash, keycmp)
+HashMap_from_arrays(Rows, unsigned long, long, unsigned long)
+
+void test_small();
+void test_build(size_t n, size_t range, size_t nthreads);
+
+int main() {
+  printf("Testing small maps:\n");
+  test_small();
+  printf("Testing unique keys:\n");
+  test_build(200000, 0, 4);
+  printf("Testing duplicate keys:\n");
+  test_build(200000, 50000, 4);
+  printf("Testing one thread per processor:\n");
+  test_build(1000000, 700000, 0);
+  printf("done!\n");
+  return 0;
+}
+
+void test_small() {
+  Rows *map = Rows_from_arrays(NULL, NULL, 0, 4);
+  myassert(map != NULL && map->size == 0);
+  unsigned long key = 3;
+  long val = 30;
+  myassert(Rows_put(map, &key, &val) == HMP_ADD && *Rows_get(map, &key) == 30);
+  Rows_free(map);
+
+  unsigned long keys[] = {1, 2, 1, 3, 2};
+  long vals[] = {10, 20, 11, 30, 21};
+  map = Rows_from_arrays(keys, vals, 5, 1);
+  myassert(map->size == 3);
+  myassert(*Rows_get(map, &keys[0]) == 11);
+  myassert(*Rows_get(map, &keys[1]) == 21);
+  myassert(*Rows_get(map, &keys[3]) == 30);
+  /* The entries left by duplicates are reused. */
+  for (key = 100; key < 200; key++) Rows_put(map, &key, &val);
+  myassert(map->size == 103 && *Rows_get(map, &keys[0]) == 11);
+  Rows_free(map);
+}
+
+/**Build a map of `n` pairs from arrays, and check it against putting the
+ * pairs one by one. Keys are below `range`, or unique if it's 0.*/
+void test_build(size_t n, size_t range, size_t nthreads) {
+  unsigned long *keys = malloc(n * sizeof(unsigned long));
+  long *vals = malloc(n * sizeof(long));
+  srand(n + range);
+  for (size_t i = 0; i < n; i++) {
+    keys[i] = range ? (unsigned long)rand() % range : i * 7;
+    vals[i] = rand();
+  }
+
+  Rows *built = Rows_from_arrays(keys, vals, n, nthreads);
+  Rows *expected = Rows_new();
+  for (size_t i = 0; i < n; i++) Rows_put(expected, &keys[i], &vals[i]);
+  myassert(built != NULL);
+  myassert(built->size == expected->size);
+
+  bool ok = true;
+  size_t bucket;
+  Rows_entry_t *entry;
+  map_for_each_entry(expected, entry, bucket) {
+    long *val = Rows_get(built, &entry->key);
+    ok = ok && val != NULL && *val == entry->val;
+  }
+  myassert(ok);
+
+  /* The built map keeps working as a normal map. */
+  for (size_t i = 0; i < n / 2; i++) {
+    Rows_remove(built, &keys[i]);
+    Rows_remove(expected, &keys[i]);
+  }
+  for (unsigned long key = 0; key < 1000; key++) {
+    long val = key;
+    ok = ok && Rows_put(built, &key, &val) == Rows_put(expected, &key, &val);
+  }
+  myassert(ok && built->size == expected->size);
+
+  Rows_free(built);
+  Rows_free(expected);
+  free(keys);
+  free(vals);
+}
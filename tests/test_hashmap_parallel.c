@@ -0,0 +1,115 @@
+#include<stdio.h>
+#include<assert.h>
+#include<stdatomic.h>
+#include "hashmap_parallel.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+unsigned long hash(const unsigned long *key) { return *key * 2654435761ul; }
+bool keycmp(const unsigned long *key1, const unsigned long *key2) {
+  return *key1 == *key2;
+}
+
+HashMap(Rows, unsigned long, long, unsigned long, hash, keycmp)
+HashMap_parallel(Rows, unsigned long, long)
+
+void test_for_each(size_t n, size_t nthreads);
+void test_reduce(size_t n, size_t nthreads);
+
+int main() {
+  printf("Testing a small map:\n");
+  test_for_each(100, 4);
+  test_reduce(100, 4);
+  printf("Testing a large map:\n");
+  test_for_each(300000, 4);
+  test_reduce(300000, 4);
+  printf("Testing one thread per processor:\n");
+  test_reduce(300000, 0);
+  printf("done!\n");
+  return 0;
+}
+
+static Rows * make_map(size_t n) {
+  Rows *map = Rows_new();
+  for (unsigned long key = 0; key < n; key++) {
+    long val = (long)(key * 37 % 1001);
+    Rows_put(map, &key, &val);
+  }
+  /* Leave holes in the entries. */
+  for (unsigned long key = 0; key < n; key += 3) Rows_remove(map, &key);
+  return map;
+}
+
+static void double_value(const unsigned long *key, long *val, void *ctx) {
+  *val *= 2;
+  atomic_fetch_add((atomic_size_t*)ctx, 1);
+}
+
+void test_for_each(size_t n, size_t nthreads) {
+  Rows *map = make_map(n);
+  atomic_size_t visited = 0;
+  Rows_parallel_for_each(map, nthreads, double_value, &visited);
+  myassert(visited == map->size);
+
+  bool ok = true;
+  for (unsigned long key = 0; key < n; key++) {
+    long *val = Rows_get(map, &key);
+    ok &= key % 3 == 0 ? val == NULL : *val == (long)(key * 37 % 1001) * 2;
+  }
+  myassert(ok);
+  Rows_free(map);
+}
+
+/* Sums the values and keeps the largest 3 keys. */
+typedef struct Summary {
+  long sum;
+  size_t count;
+  unsigned long top[3];
+} Summary;
+
+static void summary_init(void *acc, void *ctx) {
+  *(Summary*)acc = (Summary){0};
+}
+static void summary_insert(Summary *summary, unsigned long key) {
+  for (int i = 0; i < 3; i++) {
+    if (key > summary->top[i]) {
+      unsigned long tmp = summary->top[i];
+      summary->top[i] = key;
+      key = tmp;
+    }
+  }
+}
+static void summary_add(void *acc, const unsigned long *key, const long *val, void *ctx) {
+  Summary *summary = acc;
+  summary->sum += *val;
+  summary->count++;
+  summary_insert(summary, *key);
+}
+static void summary_combine(void *result, const void *acc, void *ctx) {
+  Summary *summary = result;
+  const Summary *other = acc;
+  summary->sum += other->sum;
+  summary->count += other->count;
+  for (int i = 0; i < 3; i++) summary_insert(summary, other->top[i]);
+  (*(int*)ctx)++;
+}
+
+void test_reduce(size_t n, size_t nthreads) {
+  Rows *map = make_map(n);
+  Summary expected = {0}, result = {0};
+  size_t bucket;
+  Rows_entry_t *entry;
+  map_for_each_entry(map, entry, bucket) summary_add(&expected, &entry->key, &entry->val, NULL);
+
+  int combined = 0;
+  myassert(Rows_parallel_reduce(map, nthreads, &result, sizeof(Summary),
+    summary_init, summary_add, summary_combine, &combined) == DS_SUCCESS);
+  myassert(combined >= 1);
+  myassert(result.count == map->size && result.sum == expected.sum);
+  myassert(memcmp(result.top, expected.top, sizeof(result.top)) == 0);
+  Rows_free(map);
+}
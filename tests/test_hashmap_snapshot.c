@@ -0,0 +1,164 @@
+#include<stdio.h>
+#include<assert.h>
+#include "hashmap_snapshot.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+typedef struct Point { int x, y; } Point;
+
+unsigned int hash(const int *key) { return *key; }
+bool keycmp(const int *key1, const int *key2) { return *key1 == *key2; }
+
+HashMap(Points, int, Point, unsigned int, hash, keycmp)
+HashMap_snapshot(Points, int, Point)
+
+HashMap(Counts, int, short, unsigned int, hash, keycmp)
+HashMap_snapshot(Counts, int, short)
+
+#define COUNT 20000
+
+void test_roundtrip(const char *path);
+void test_rejects(const char *path);
+void test_deterministic(const char *path);
+
+int main() {
+  char path[] = "/tmp/test_hashmap_snapshotXXXXXX";
+  int fd = mkstemp(path);
+  myassert(fd >= 0);
+  close(fd);
+
+  printf("Testing save and map_file:\n");
+  test_roundtrip(path);
+  printf("Testing bad files:\n");
+  test_rejects(path);
+  printf("Testing the bytes of saved files:\n");
+  test_deterministic(path);
+
+  unlink(path);
+  printf("All tests passed!\n");
+  return 0;
+}
+
+void test_roundtrip(const char *path) {
+  Points *map = Points_new();
+  myassert(map != NULL);
+  for (int i = 0; i < COUNT; i++) {
+    int key = i * 7;
+    Point point = {i, -i};
+    Points_put(map, &key, &point);
+  }
+  for (int i = 0; i < COUNT; i += 3) {
+    int key = i * 7;
+    Points_remove(map, &key);
+  }
+
+  int fd = open(path, O_WRONLY | O_TRUNC);
+  myassert(Points_save(map, fd) == DS_SUCCESS);
+  close(fd);
+
+  const Points *mapped = Points_map_file(path);
+  myassert(mapped != NULL);
+  myassert(mapped->size == map->size);
+  myassert(mapped->cap == map->cap);
+  bool ok = true;
+  for (int i = 0; i < COUNT; i++) {
+    int key = i * 7;
+    Point *p = Points_get(mapped, &key);
+    if (i % 3 == 0) ok = ok && p == NULL && !Points_has(mapped, &key);
+    else ok = ok && p != NULL && p->x == i && p->y == -i;
+  }
+  myassert(ok);
+  int missing = 1, seven = 7;
+  myassert(Points_get(mapped, &missing) == NULL);
+
+  /* Writes through get() stay private to the mapping. */
+  Points_get(mapped, &seven)->x = 100;
+  myassert(Points_get(mapped, &seven)->x == 100);
+  Points_unmap(mapped);
+  mapped = Points_map_file(path);
+  myassert(Points_get(mapped, &seven)->x == 1);
+  Points_unmap(mapped);
+
+  Points_free(map);
+}
+
+void test_rejects(const char *path) {
+  /* The file holds a map of Points, not of Counts. */
+  myassert(Counts_map_file(path) == NULL);
+  myassert(Points_map_file("/tmp/no/such/snapshot") == NULL);
+
+  int fd = open(path, O_WRONLY | O_TRUNC);
+  myassert(write(fd, "not a snapshot", 14) == 14);
+  close(fd);
+  myassert(Points_map_file(path) == NULL);
+}
+
+/* Fill the bytes of every entry around it's fields with `junk`, and the empty
+ * entries whole except for their link, like leftovers of the heap. */
+void scribble(Counts *map, int junk) {
+  bool *used = calloc(map->cap, sizeof(bool));
+  for (size_t b = 0; b < map->cap; b++) {
+    for (ssize_t i = map->buckets[b]; i != -1; i = map->entries[i].next) used[i] = true;
+  }
+  for (size_t i = 0; i < map->cap; i++) {
+    Counts_entry_t copy;
+    memcpy(&copy, &map->entries[i], sizeof(copy));
+    memset(&map->entries[i], junk, sizeof(copy));
+    map->entries[i].next = copy.next;
+    if (!used[i]) continue;
+    memcpy((void*)&map->entries[i].key, &copy.key, sizeof(copy.key));
+    memcpy((void*)&map->entries[i].key_hash, &copy.key_hash, sizeof(copy.key_hash));
+    map->entries[i].val = copy.val;
+  }
+  free(used);
+}
+
+/* Read a whole file to a new buffer. */
+char *read_file(const char *path, size_t *size) {
+  FILE *file = fopen(path, "rb");
+  fseek(file, 0, SEEK_END);
+  *size = ftell(file);
+  rewind(file);
+  char *buffer = malloc(*size);
+  myassert(fread(buffer, 1, *size, file) == *size);
+  fclose(file);
+  return buffer;
+}
+
+void test_deterministic(const char *path) {
+  /* Counts entries have padding after the value, and the map has empty entries. */
+  Counts *map = Counts_new();
+  for (int i = 0; i < COUNT; i++) {
+    short count = i % 100;
+    Counts_put(map, &i, &count);
+  }
+  for (int i = 0; i < COUNT; i += 2) Counts_remove(map, &i);
+
+  size_t sizes[2];
+  char *files[2];
+  for (int pass = 0; pass < 2; pass++) {
+    scribble(map, pass ? 0xab : 0xcd);
+    int fd = open(path, O_WRONLY | O_TRUNC);
+    myassert(Counts_save(map, fd) == DS_SUCCESS);
+    close(fd);
+    files[pass] = read_file(path, &sizes[pass]);
+  }
+  myassert(sizes[0] == sizes[1] && memcmp(files[0], files[1], sizes[0]) == 0);
+  free(files[0]);
+  free(files[1]);
+
+  /* The saved map still answers like the map. */
+  const Counts *mapped = Counts_map_file(path);
+  bool ok = mapped != NULL && mapped->size == map->size;
+  for (int i = 0; ok && i < COUNT; i++) {
+    short *count = Counts_get(mapped, &i);
+    ok = i % 2 ? count != NULL && *count == i % 100 : count == NULL;
+  }
+  myassert(ok);
+  Counts_unmap(mapped);
+  Counts_free(map);
+}
@@ -0,0 +1,134 @@
+#include<stdio.h>
+#include<assert.h>
+#include "inthashmap.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+IntHashMap(Counts, long long, long long)
+IntHashMap(Small, short, char)
+
+void test_basic();
+void test_empty_key();
+void test_random();
+
+int main() {
+  printf("Testing basic operations:\n");
+  test_basic();
+  printf("Testing the empty key:\n");
+  test_empty_key();
+  printf("Testing random operations:\n");
+  test_random();
+  printf("done!\n");
+  return 0;
+}
+
+void test_basic() {
+  Counts map;
+  long long key, val;
+  myassert(Counts_init(&map, 0) == DS_SUCCESS);
+  /* No stored hash, an entry is the key and the value. */
+  myassert(sizeof(Counts_entry_t) == 2 * sizeof(long long));
+
+  key = 1; val = 10;
+  myassert(Counts_put(&map, &key, &val) == HMP_ADD);
+  val = 11;
+  myassert(Counts_put(&map, &key, &val) == HMP_SET);
+  myassert(*Counts_get(&map, &key) == 11);
+  key = -1;
+  myassert(!Counts_has(&map, &key) && Counts_get(&map, &key) == NULL);
+  myassert(Counts_remove(&map, &key) == ERR_KEYNOTFOUND);
+  key = 1;
+  myassert(Counts_remove(&map, &key) == DS_SUCCESS);
+  myassert(!Counts_has(&map, &key) && map.size == 0);
+
+  for (key = -500; key < 500; key++) Counts_put(&map, &key, &key);
+  myassert(map.size == 1000);
+  size_t count = 0, slot;
+  Counts_entry_t *entry;
+  intmap_for_each_entry(&map, entry, slot) {
+    assert(entry->key == entry->val);
+    count++;
+  }
+  myassert(count == 1000);
+  myassert(Counts_resize(&map, 10) == ERR_TOOSMALL);
+  myassert(Counts_resize(&map, 5000) == DS_SUCCESS);
+  for (key = -500; key < 500; key++) assert(*Counts_get(&map, &key) == key);
+
+  Counts_clear(&map);
+  key = 5;
+  myassert(map.size == 0 && !Counts_has(&map, &key));
+  key = 0;
+  myassert(!Counts_has(&map, &key));
+  Counts_destroy(&map);
+}
+
+void test_empty_key() {
+  Small *map = Small_new();
+  short key = 0;
+  char val = 'z';
+  myassert(!Small_has(map, &key));
+  myassert(Small_put(map, &key, &val) == HMP_ADD);
+  myassert(Small_has(map, &key) && *Small_get(map, &key) == 'z');
+  myassert(map->size == 1);
+
+  /* The empty key survives growing. */
+  for (short k = 1; k < 200; k++) Small_put(map, &k, &val);
+  myassert(*Small_get(map, &key) == 'z');
+  size_t count = 0, slot;
+  Small_entry_t *entry;
+  intmap_for_each_entry(map, entry, slot) count++;
+  myassert(count == 200);
+
+  myassert(Small_remove(map, &key) == DS_SUCCESS);
+  myassert(!Small_has(map, &key) && map->size == 199);
+  myassert(Small_remove(map, &key) == ERR_KEYNOTFOUND);
+  Small_free(map);
+}
+
+#define RANGE 4096
+#define OPS 500000
+
+void test_random() {
+  Counts *map = Counts_new();
+  static long long expected[RANGE];
+  static bool present[RANGE];
+  size_t size = 0;
+  srand(1234);
+
+  bool ok = true;
+  for (int op = 0; op < OPS && ok; op++) {
+    /* Keys spaced by a power of 2, to stress the mixer. */
+    long long i = rand() % RANGE;
+    long long key = (i - RANGE / 2) * (1 << 20);
+    long long val = rand();
+    switch (rand() % 3) {
+    case 0:
+      ok = Counts_put(map, &key, &val) == (present[i] ? HMP_SET : HMP_ADD);
+      if (!present[i]) size++;
+      present[i] = true;
+      expected[i] = val;
+      break;
+    case 1:
+      ok = Counts_remove(map, &key) == (present[i] ? DS_SUCCESS : ERR_KEYNOTFOUND);
+      if (present[i]) size--;
+      present[i] = false;
+      break;
+    default: {
+      long long *got = Counts_get(map, &key);
+      ok = present[i] ? got != NULL && *got == expected[i] : got == NULL;
+    }
+    }
+    ok = ok && map->size == size;
+  }
+  myassert(ok);
+  for (long long i = 0; i < RANGE; i++) {
+    long long key = (i - RANGE / 2) * (1 << 20);
+    ok = ok && Counts_has(map, &key) == present[i];
+  }
+  myassert(ok);
+  Counts_free(map);
+}
@@ -0,0 +1,160 @@
+#include<stdio.h>
+#include<assert.h>
+#include "linkedhashmap.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+long long hash(const char **key) {
+  long long hash = 0;
+  const char *k = *key;
+  for (; *k; k++) {
+    hash += *k * 31 + 5;
+  }
+  return hash;
+}
+bool keycmp(const char **key1, const char **key2) {
+  return !strcmp(*key1, *key2);
+}
+
+LinkedHashMap(Cache, const char*, int, long long, hash, keycmp)
+
+void test_order();
+void test_touch();
+void test_put_evict();
+void test_shrink();
+
+int main() {
+  printf("Testing order:\n");
+  test_order();
+  printf("Testing touch:\n");
+  test_touch();
+  printf("Testing put_evict:\n");
+  test_put_evict();
+  printf("Testing shrinking:\n");
+  test_shrink();
+  printf("done!\n");
+  return 0;
+}
+
+/**Put the keys "0".."n-1" with values 0..n-1.*/
+void put_numbers(Cache *map, int n) {
+  static const char *names[] = {
+    "0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11", "12", "13",
+    "14", "15", "16", "17", "18", "19"
+  };
+  for (int i = 0; i < n; i++) Cache_put(map, &names[i], &i);
+}
+
+void test_order() {
+  Cache *map = Cache_new();
+  Cache_entry_t *entry;
+  put_numbers(map, 20);
+  myassert(map->size == 20);
+
+  int expected = 0;
+  linkedmap_for_each_entry(map, entry) {
+    assert(entry->val == expected);
+    expected++;
+  }
+  myassert(expected == 20);
+
+  const char *key = "5";
+  myassert(Cache_remove(map, &key) == DS_SUCCESS);
+  key = "0";
+  myassert(Cache_remove(map, &key) == DS_SUCCESS);
+  key = "19";
+  myassert(Cache_remove(map, &key) == DS_SUCCESS);
+  int val = 100;
+  key = "1";
+  myassert(Cache_put(map, &key, &val) == HMP_SET);
+
+  expected = 1;
+  linkedmap_for_each_entry(map, entry) {
+    if (expected == 5) expected++;
+    assert(entry->val == (expected == 1 ? 100 : expected));
+    expected++;
+  }
+  myassert(expected == 19);
+
+  const char *popped; int popped_val;
+  myassert(Cache_pop_oldest(map, &popped, &popped_val) == DS_SUCCESS);
+  myassert(!strcmp(popped, "1") && popped_val == 100);
+  myassert(!Cache_has(map, &popped));
+
+  Cache_clear(map);
+  myassert(Cache_pop_oldest(map, NULL, NULL) == ERR_EMPTY);
+  myassert(linkedmap_oldest_entry(map) == NULL);
+  Cache_free(map);
+}
+
+void test_touch() {
+  Cache *map = Cache_new();
+  put_numbers(map, 4);
+
+  const char *key = "0";
+  myassert(Cache_touch(map, &key) == DS_SUCCESS);
+  key = "2";
+  myassert(Cache_touch(map, &key) == DS_SUCCESS);
+  key = "none";
+  myassert(Cache_touch(map, &key) == ERR_KEYNOTFOUND);
+
+  int order[] = {1, 3, 0, 2}, i = 0;
+  Cache_entry_t *entry;
+  linkedmap_for_each_entry(map, entry) {
+    assert(entry->val == order[i]);
+    i++;
+  }
+  myassert(i == 4);
+  Cache_free(map);
+}
+
+void test_put_evict() {
+  static const char *names[] = {"a", "b", "c", "d", "e"};
+  Cache *map = Cache_snew(4);
+  const char *evicted; int evicted_val, val;
+  size_t cap = map->cap;
+
+  for (val = 0; val < 3; val++) {
+    assert(Cache_put_evict(map, &names[val], &val, 3, &evicted, &evicted_val) == HMP_ADD);
+  }
+  val = 0;
+  myassert(Cache_touch(map, &names[0]) == DS_SUCCESS);
+  myassert(Cache_put_evict(map, &names[3], &val, 3, &evicted, &evicted_val) == HMP_EVICT);
+  myassert(!strcmp(evicted, "b") && evicted_val == 1);
+  myassert(Cache_put_evict(map, &names[4], &val, 3, &evicted, &evicted_val) == HMP_EVICT);
+  myassert(!strcmp(evicted, "c") && evicted_val == 2);
+  myassert(Cache_put_evict(map, &names[0], &val, 3, &evicted, &evicted_val) == HMP_SET);
+  myassert(map->size == 3 && map->cap == cap);
+  myassert(Cache_put_evict(map, &names[0], &val, 0, NULL, NULL) == ERR_TOOSMALL);
+  Cache_free(map);
+}
+
+void test_shrink() {
+  Cache *map = Cache_new();
+  Cache_entry_t *entry;
+  put_numbers(map, 20);
+  for (int i = 0; i < 15; i++) {
+    const char *key = linkedmap_oldest_entry(map)->key;
+    Cache_remove(map, &key);
+  }
+  /* The entries left are at the end of the array, shrinking moves them. */
+  myassert(Cache_resize(map, 6) == DS_SUCCESS);
+  myassert(map->cap < 20 && map->size == 5);
+
+  int expected = 15;
+  linkedmap_for_each_entry(map, entry) {
+    assert(entry->val == expected);
+    expected++;
+  }
+  myassert(expected == 20);
+  const char *popped;
+  myassert(Cache_pop_oldest(map, &popped, NULL) == DS_SUCCESS);
+  myassert(!strcmp(popped, "15"));
+  put_numbers(map, 3);
+  myassert(!strcmp(linkedmap_newer_entry(map, linkedmap_oldest_entry(map))->key, "17"));
+  Cache_free(map);
+}
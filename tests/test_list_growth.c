@@ -0,0 +1,112 @@
+#include<stdio.h>
+#include<assert.h>
+#include<stdbool.h>
+#include "list.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+STRUCT_LIST(int, ListInt)
+STRUCT_LIST_GROWTH(int, ListIntHalf, 3, 2)
+
+void test_factor();
+void test_grow_ops();
+void test_capacity();
+
+int main() {
+  printf("Testing growth factors:\n");
+  test_factor();
+  printf("Testing operations that grow the list:\n");
+  test_grow_ops();
+  printf("Testing reserve, shrink_to_fit and resize:\n");
+  test_capacity();
+  printf("done!\n");
+  return 0;
+}
+
+void test_factor() {
+  ListInt *doubling = ListInt_news(8);
+  ListIntHalf *half = ListIntHalf_news(8);
+  for (int i = 0; i < 9; i++) {
+    ListInt_add(doubling, i);
+    ListIntHalf_add(half, i);
+  }
+  myassert(doubling->_maxSize == 16);
+  myassert(half->_maxSize == 12);
+  for (int i = 9; i < 1000; i++) ListIntHalf_add(half, i);
+  bool ok = half->_size == 1000;
+  for (int i = 0; i < 1000; i++) ok &= half->_arr[i] == i;
+  myassert(ok);
+  ListInt_delete(doubling);
+  ListIntHalf_delete(half);
+
+  /* A list of size 0 or 1 still grows. */
+  ListIntHalf *tiny = ListIntHalf_news(0);
+  for (int i = 0; i < 5; i++) ListIntHalf_add(tiny, i);
+  myassert(tiny->_size == 5 && tiny->_arr[4] == 4);
+  ListIntHalf_delete(tiny);
+}
+
+void test_grow_ops() {
+  int expected[4096];
+  size_t size = 0;
+  ListIntHalf *list = ListIntHalf_news(1);
+  int values[100];
+  for (int i = 0; i < 100; i++) values[i] = -i;
+
+  for (int round = 0; round < 30; round++) {
+    size_t index = size ? (size_t)(round * 37) % size : 0;
+    ListIntHalf_insert(list, round, index);
+    memmove(expected + index + 1, expected + index, (size - index) * sizeof(int));
+    expected[index] = round;
+    size++;
+
+    index = (size_t)(round * 13) % size;
+    ListIntHalf_insertArray(list, values, round + 1, index);
+    memmove(expected + index + round + 1, expected + index, (size - index) * sizeof(int));
+    memcpy(expected + index, values, (round + 1) * sizeof(int));
+    size += round + 1;
+
+    ListIntHalf_addArray(list, values, round);
+    memcpy(expected + size, values, round * sizeof(int));
+    size += round;
+  }
+  myassert(list->_size == size && list->_maxSize > size);
+  myassert(memcmp(list->_arr, expected, size * sizeof(int)) == 0);
+  ListIntHalf_delete(list);
+}
+
+void test_capacity() {
+  ListInt *list = ListInt_new();
+  ListInt_reserve(list, 1000);
+  myassert(list->_maxSize == 1000);
+  int *arr = list->_arr;
+  /* A reused list doesn't allocate once it has reserved enough. */
+  for (int batch = 0; batch < 5; batch++) {
+    ListInt_resize(list, 0, 0);
+    for (int i = 0; i < 999; i++) ListInt_add(list, i);
+  }
+  myassert(list->_arr == arr && list->_maxSize == 1000);
+  ListInt_reserve(list, 10);
+  myassert(list->_maxSize == 1000);
+
+  ListInt_resize(list, 10, 0);
+  ListInt_shrink_to_fit(list);
+  myassert(list->_size == 10 && list->_maxSize == 10 && list->_arr[9] == 9);
+  ListInt_resize(list, 15, -1);
+  myassert(list->_size == 15 && list->_maxSize == 15);
+  myassert(list->_arr[9] == 9 && list->_arr[10] == -1 && list->_arr[14] == -1);
+  ListInt_add(list, 15);
+  myassert(list->_size == 16 && list->_arr[15] == 15);
+
+  ListInt_resize(list, 0, 0);
+  ListInt_shrink_to_fit(list);
+  myassert(list->_size == 0 && list->_maxSize == 1);
+  ListInt_add(list, 1);
+  ListInt_add(list, 2);
+  myassert(list->_size == 2 && list->_arr[1] == 2);
+  ListInt_delete(list);
+}
@@ -0,0 +1,158 @@
+#include<stdio.h>
+#include<assert.h>
+#include<stdbool.h>
+#include<math.h>
+#include "list_types.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+LIST_REDUCE_PARALLEL(long, ListLong, long long)
+LIST_REDUCE_PARALLEL(double, ListDouble, double)
+
+/* Check the reductions of a list against plain loops, on every size up to
+ * 300 and on sizes that cross the blocks of argmin and argmax. Values are
+ * small integers, so the sums of floats are exact too. */
+#define REDUCE_TEST(type, List_name, sum_t, low) { \
+  bool ok = true; \
+  List_name *list = List_name##_new(), *other = List_name##_new(); \
+  size_t sizes[] = {1000, 2048, 2049, 5000}; \
+  for (size_t s = 0; s < 301 + 4; s++) { \
+    size_t size = s < 301 ? s : sizes[s - 301]; \
+    List_name##_resize(list, size, 0); \
+    List_name##_resize(other, size, 0); \
+    for (size_t i = 0; i < size; i++) { \
+      list->_arr[i] = (type)(rand() % 100 + low); \
+      other->_arr[i] = (type)(rand() % 100 + low); \
+    } \
+    sum_t sum = 0, dot = 0; \
+    size_t min = 0, max = 0; \
+    for (size_t i = 0; i < size; i++) { \
+      sum += list->_arr[i]; \
+      dot += (sum_t)list->_arr[i] * other->_arr[i]; \
+      if (list->_arr[i] < list->_arr[min]) min = i; \
+      if (list->_arr[i] > list->_arr[max]) max = i; \
+    } \
+    ok &= List_name##_sum(list) == sum; \
+    ok &= List_name##_dot(list, other) == dot; \
+    if (size == 0) { \
+      ok &= List_name##_argmin(list) == -1 && List_name##_argmax(list) == -1; \
+      continue; \
+    } \
+    ok &= List_name##_min(list) == list->_arr[min]; \
+    ok &= List_name##_max(list) == list->_arr[max]; \
+    ok &= List_name##_argmin(list) == (ssize_t)min; \
+    ok &= List_name##_argmax(list) == (ssize_t)max; \
+  } \
+  List_name##_delete(list); \
+  List_name##_delete(other); \
+  myassert(ok); \
+}
+
+void test_extremes();
+void test_accuracy();
+void test_parallel();
+
+int main() {
+  srand(6);
+  printf("Testing integer lists:\n");
+  REDUCE_TEST(char, ListChar, long long, 0)
+  REDUCE_TEST(signed char, ListSChar, long long, -50)
+  REDUCE_TEST(unsigned char, ListUChar, unsigned long long, 100)
+  REDUCE_TEST(short, ListShort, long long, -50)
+  REDUCE_TEST(unsigned short, ListUShort, unsigned long long, 60000)
+  REDUCE_TEST(int, ListInt, long long, -50)
+  REDUCE_TEST(unsigned int, ListUInt, unsigned long long, 4000000000u)
+  REDUCE_TEST(long, ListLong, long long, -50)
+  REDUCE_TEST(long long, ListLLong, long long, -50)
+  REDUCE_TEST(size_t, ListSizeT, unsigned long long, 0)
+  test_extremes();
+  printf("Testing floating lists:\n");
+  REDUCE_TEST(float, ListFloat, double, -50)
+  REDUCE_TEST(double, ListDouble, double, -50)
+  REDUCE_TEST(long double, ListLDouble, long double, -50)
+  test_accuracy();
+  printf("Testing parallel reductions:\n");
+  test_parallel();
+  printf("done!\n");
+  return 0;
+}
+
+void test_extremes() {
+  /* The limits of the type, and the first of equal extremes. */
+  ListInt *list = ListInt_new();
+  for (int i = 0; i < 10000; i++) ListInt_add(list, i % 7);
+  list->_arr[3000] = list->_arr[9000] = INT32_MIN;
+  list->_arr[5000] = list->_arr[5001] = INT32_MAX;
+  myassert(ListInt_min(list) == INT32_MIN && ListInt_argmin(list) == 3000);
+  myassert(ListInt_max(list) == INT32_MAX && ListInt_argmax(list) == 5000);
+  /* Sums are accumulated in 64 bits. */
+  myassert(ListInt_sum(list) == 2ll * INT32_MIN + 2ll * INT32_MAX + 29980);
+  ListInt_delete(list);
+
+  /* Narrow elements are summed in narrow lanes, that must not overflow. */
+  ListSChar *chars = ListSChar_new();
+  ListUShort *shorts = ListUShort_new();
+  for (int i = 0; i < 100000; i++) {
+    ListSChar_add(chars, -128);
+    ListUShort_add(shorts, 65535);
+  }
+  myassert(ListSChar_sum(chars) == -12800000ll);
+  myassert(ListUShort_sum(shorts) == 6553500000ull);
+  ListSChar_delete(chars);
+  ListUShort_delete(shorts);
+
+  ListULLong *big = ListULLong_new();
+  for (int i = 0; i < 100; i++) ListULLong_add(big, UINT64_MAX - i);
+  myassert(ListULLong_max(big) == UINT64_MAX && ListULLong_argmin(big) == 99);
+  ListULLong_delete(big);
+}
+
+void test_accuracy() {
+  /* A million tenths, the exact sum of the doubles closest to 0.1. */
+  ListDouble *list = ListDouble_new();
+  for (int i = 0; i < 1000000; i++) ListDouble_add(list, 0.1);
+  long double exact = 1000000.0L * 0.1;
+  double plain = 0;
+  for (size_t i = 0; i < list->_size; i++) plain += list->_arr[i];
+  myassert(fabsl(ListDouble_sum(list) - exact) <= fabsl(plain - exact));
+  myassert(fabsl(ListDouble_sumPairwise(list) - exact) < 1e-9);
+  myassert(ListDouble_sumKahan(list) == (double)exact);
+  ListDouble_delete(list);
+
+  /* Floats are summed in doubles, and long doubles with loops. */
+  ListFloat *floats = ListFloat_new();
+  for (int i = 0; i < 100000; i++) ListFloat_add(floats, 0.1f);
+  myassert(fabs(ListFloat_sumKahan(floats) - 100000.0 * 0.1f) < 1e-6);
+  ListFloat_delete(floats);
+  ListLDouble *ldoubles = ListLDouble_new();
+  for (int i = 0; i < 1000; i++) ListLDouble_add(ldoubles, 0.1L);
+  myassert(fabsl(ListLDouble_sumKahan(ldoubles) - 100.0L) < 1e-15L);
+  myassert(fabsl(ListLDouble_sumPairwise(ldoubles) - 100.0L) < 1e-15L);
+  ListLDouble_delete(ldoubles);
+}
+
+void test_parallel() {
+  ListLong *list = ListLong_new(), *other = ListLong_new();
+  ListDouble *doubles = ListDouble_new();
+  for (int i = 0; i < 1000003; i++) {
+    ListLong_add(list, rand() - RAND_MAX / 2);
+    ListLong_add(other, rand() % 1000);
+    ListDouble_add(doubles, rand() % 1000);
+  }
+  myassert(ListLong_parallelSum(list, 4) == ListLong_sum(list));
+  myassert(ListLong_parallelSum(list, 0) == ListLong_sum(list));
+  myassert(ListLong_parallelDot(list, other, 3) == ListLong_dot(list, other));
+  myassert(ListDouble_parallelSum(doubles, 4) == ListDouble_sum(doubles));
+
+  /* Short lists are reduced on the calling thread. */
+  ListLong_resize(list, 1000, 0);
+  ListLong_resize(other, 1000, 0);
+  myassert(ListLong_parallelDot(list, other, 4) == ListLong_dot(list, other));
+  ListLong_delete(list);
+  ListLong_delete(other);
+  ListDouble_delete(doubles);
+}
@@ -0,0 +1,78 @@
+#include<stdio.h>
+#include<assert.h>
+#include<stdbool.h>
+#include "list.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+STRUCT_LIST(int, ListInt)
+
+void test_remove_range();
+void test_remove_if();
+void test_swap_remove();
+
+int main() {
+  printf("Testing removeRange:\n");
+  test_remove_range();
+  printf("Testing removeIf:\n");
+  test_remove_if();
+  printf("Testing swapRemove:\n");
+  test_swap_remove();
+  printf("done!\n");
+  return 0;
+}
+
+static ListInt * make_list(int size) {
+  ListInt *list = ListInt_new();
+  for (int i = 0; i < size; i++) ListInt_add(list, i);
+  return list;
+}
+
+void test_remove_range() {
+  ListInt *list = make_list(20);
+  ListInt_removeRange(list, 5, 10);
+  myassert(list->_size == 10);
+  myassert(list->_arr[4] == 4 && list->_arr[5] == 15 && list->_arr[9] == 19);
+  ListInt_removeRange(list, 10, 0);
+  myassert(list->_size == 10);
+  ListInt_removeRange(list, 8, 2);
+  myassert(list->_size == 8 && list->_arr[7] == 17);
+  ListInt_remove(list, 0);
+  myassert(list->_size == 7 && list->_arr[0] == 1 && list->_arr[6] == 17);
+  ListInt_removeRange(list, 0, 7);
+  myassert(list->_size == 0);
+  ListInt_delete(list);
+}
+
+static int is_multiple(const int *element, void *ctx) {
+  return *element % *(int*)ctx == 0;
+}
+
+void test_remove_if() {
+  ListInt *list = make_list(100);
+  int factor = 3;
+  myassert(ListInt_removeIf(list, is_multiple, &factor) == 34);
+  bool ok = list->_size == 66;
+  for (size_t i = 0; i < list->_size; i++) {
+    ok &= list->_arr[i] % 3 != 0 && (i == 0 || list->_arr[i] > list->_arr[i - 1]);
+  }
+  myassert(ok);
+  factor = 1000;
+  myassert(ListInt_removeIf(list, is_multiple, &factor) == 0 && list->_size == 66);
+  factor = 1;
+  myassert(ListInt_removeIf(list, is_multiple, &factor) == 66 && list->_size == 0);
+  ListInt_delete(list);
+}
+
+void test_swap_remove() {
+  ListInt *list = make_list(5);
+  ListInt_swapRemove(list, 1);
+  myassert(list->_size == 4 && list->_arr[1] == 4 && list->_arr[3] == 3);
+  ListInt_swapRemove(list, 3);
+  myassert(list->_size == 3 && list->_arr[2] == 2);
+  ListInt_delete(list);
+}
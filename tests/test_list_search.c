@@ -0,0 +1,81 @@
+#include<stdio.h>
+#include<assert.h>
+#include<stdbool.h>
+#include<math.h>
+#include "list_types.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+/* Check the searches of a list against plain loops, on every size up to
+ * 300 and with the matches at random places. Values are from a small
+ * range, so there are many matches and many misses. */
+#define SEARCH_TEST(type, List_name) { \
+  bool ok = true; \
+  List_name *list = List_name##_new(); \
+  for (size_t size = 0; size <= 300; size++) { \
+    List_name##_resize(list, size, 0); \
+    for (size_t i = 0; i < size; i++) list->_arr[i] = (type)(rand() % 50 * 3); \
+    for (int v = -3; v < 160; v += 3) { \
+      type value = (type)v; \
+      ssize_t first = -1, last = -1; \
+      size_t count = 0; \
+      for (size_t i = 0; i < size; i++) { \
+        if (list->_arr[i] != value) continue; \
+        if (first == -1) first = i; \
+        last = i; \
+        count++; \
+      } \
+      ok &= List_name##_indexOf(list, value) == first; \
+      ok &= List_name##_lastIndexOf(list, value) == last; \
+      ok &= List_name##_contains(list, value) == (first != -1); \
+      ok &= List_name##_count(list, value) == count; \
+    } \
+  } \
+  List_name##_delete(list); \
+  myassert(ok); \
+}
+
+void test_floats();
+
+int main() {
+  srand(5);
+  printf("Testing integer lists:\n");
+  SEARCH_TEST(char, ListChar)
+  SEARCH_TEST(unsigned char, ListUChar)
+  SEARCH_TEST(short, ListShort)
+  SEARCH_TEST(int, ListInt)
+  SEARCH_TEST(unsigned int, ListUInt)
+  SEARCH_TEST(long, ListLong)
+  SEARCH_TEST(long long, ListLLong)
+  SEARCH_TEST(size_t, ListSizeT)
+  printf("Testing floating lists:\n");
+  SEARCH_TEST(float, ListFloat)
+  SEARCH_TEST(double, ListDouble)
+  SEARCH_TEST(long double, ListLDouble)
+  test_floats();
+  printf("done!\n");
+  return 0;
+}
+
+void test_floats() {
+  ListDouble *list = ListDouble_new();
+  for (int i = 0; i < 40; i++) ListDouble_add(list, i);
+  list->_arr[5] = NAN;
+  list->_arr[30] = -0.0;
+  /* Floats compare by value, not by their bits. */
+  myassert(ListDouble_indexOf(list, NAN) == -1);
+  myassert(ListDouble_indexOf(list, 0.0) == 0);
+  myassert(ListDouble_lastIndexOf(list, 0.0) == 30);
+  myassert(ListDouble_count(list, -0.0) == 2);
+  ListDouble_delete(list);
+
+  ListFloat *floats = ListFloat_new();
+  for (int i = 0; i < 40; i++) ListFloat_add(floats, i * 0.5f);
+  myassert(ListFloat_indexOf(floats, 7.5f) == 15);
+  myassert(ListFloat_contains(floats, 7.25f) == 0);
+  ListFloat_delete(floats);
+}
@@ -0,0 +1,197 @@
+#include<stdio.h>
+#include<assert.h>
+#include<stdbool.h>
+#include<math.h>
+#include "list_types.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+/* Records sorted by key, and by descending key. */
+typedef struct Record { long key; int id; } Record;
+#define RECORD_LESS(a, b) ((a).key < (b).key)
+#define RECORD_GREATER(a, b) ((a).key > (b).key)
+STRUCT_LIST(Record, ListRecord)
+LIST_SORT(Record, ListRecord, RECORD_LESS)
+LIST_SORT_PARALLEL(Record, ListRecord, RECORD_LESS)
+STRUCT_LIST(Record, ListRecordDesc)
+LIST_SORT(Record, ListRecordDesc, RECORD_GREATER)
+
+LIST_SORT_PARALLEL(long, ListLong, LIST_LESS)
+
+int compare_longs(const void *a, const void *b) {
+  long x = *(const long*)a, y = *(const long*)b;
+  return (x > y) - (x < y);
+}
+
+/* Fill a list with one of the patterns that are hard for quicksorts. */
+void fill(ListLong *list, size_t size, int pattern) {
+  ListLong_resize(list, size, 0);
+  for (size_t i = 0; i < size; i++) {
+    switch (pattern) {
+      case 0: list->_arr[i] = rand() - RAND_MAX / 2; break;
+      case 1: list->_arr[i] = i; break;
+      case 2: list->_arr[i] = size - i; break;
+      case 3: list->_arr[i] = 7; break;
+      case 4: list->_arr[i] = i < size / 2 ? i : size - i; break;
+      case 5: list->_arr[i] = rand() % 4; break;
+    }
+  }
+}
+
+/* Sort the list with every sort, and check them against qsort. */
+bool check_sorts(ListLong *list) {
+  size_t size = list->_size;
+  long *expected = malloc((size + 1) * sizeof(long));
+  memcpy(expected, list->_arr, size * sizeof(long));
+  qsort(expected, size, sizeof(long), compare_longs);
+  ListLong *copy = ListLong_newa(list->_arr, size);
+  ListLong_sort(copy);
+  bool ok = memcmp(copy->_arr, expected, size * sizeof(long)) == 0;
+  memcpy(copy->_arr, list->_arr, size * sizeof(long));
+  ListLong_radixSort(copy);
+  ok &= memcmp(copy->_arr, expected, size * sizeof(long)) == 0;
+  memcpy(copy->_arr, list->_arr, size * sizeof(long));
+  ListLong_parallelSort(copy, 4);
+  ok &= memcmp(copy->_arr, expected, size * sizeof(long)) == 0;
+  /* The fallback of deep recursions. */
+  memcpy(copy->_arr, list->_arr, size * sizeof(long));
+  ListLong_heapSort(copy->_arr, size);
+  ok &= memcmp(copy->_arr, expected, size * sizeof(long)) == 0;
+  ListLong_delete(copy);
+  free(expected);
+  return ok;
+}
+
+/* Radix sort a list of random bits, and check it against sort. */
+#define RADIX_TEST(type, List_name) { \
+  List_name *list = List_name##_new(); \
+  for (size_t i = 0; i < 5000; i++) { \
+    unsigned long long bits = (unsigned long long)rand() << 33 ^ (unsigned long long)rand() << 11 ^ rand(); \
+    type element; \
+    memcpy(&element, &bits, sizeof(type)); \
+    List_name##_add(list, element); \
+  } \
+  List_name *copy = List_name##_newa(list->_arr, list->_size); \
+  List_name##_sort(list); \
+  List_name##_radixSort(copy); \
+  myassert(memcmp(list->_arr, copy->_arr, list->_size * sizeof(type)) == 0); \
+  List_name##_delete(list); \
+  List_name##_delete(copy); \
+}
+
+void test_floats();
+void test_records();
+void test_parallel();
+
+int main() {
+  srand(8);
+  printf("Testing patterns:\n");
+  ListLong *list = ListLong_new();
+  bool ok = true;
+  for (int pattern = 0; pattern < 6; pattern++) {
+    for (size_t size = 0; size <= 300; size++) {
+      fill(list, size, pattern);
+      ok &= check_sorts(list);
+    }
+    fill(list, 100000, pattern);
+    ok &= check_sorts(list);
+  }
+  myassert(ok);
+  ListLong_delete(list);
+  printf("Testing radix sorts:\n");
+  RADIX_TEST(char, ListChar)
+  RADIX_TEST(unsigned char, ListUChar)
+  RADIX_TEST(short, ListShort)
+  RADIX_TEST(unsigned short, ListUShort)
+  RADIX_TEST(int, ListInt)
+  RADIX_TEST(unsigned int, ListUInt)
+  RADIX_TEST(long long, ListLLong)
+  RADIX_TEST(size_t, ListSizeT)
+  test_floats();
+  printf("Testing records:\n");
+  test_records();
+  printf("Testing parallel sorts:\n");
+  test_parallel();
+  printf("done!\n");
+  return 0;
+}
+
+void test_floats() {
+  double values[] = {3.5, -0.0, INFINITY, -2, 0.0, -INFINITY, 1e-310, -1e300, 2};
+  ListDouble *list = ListDouble_newa(values, 9);
+  ListDouble_radixSort(list);
+  bool ok = true;
+  for (size_t i = 1; i < list->_size; i++) ok &= list->_arr[i - 1] <= list->_arr[i];
+  myassert(ok);
+  myassert(signbit(list->_arr[3]) && !signbit(list->_arr[4]));
+
+  /* Random floats, without NaN's, against sort. */
+  ListFloat *floats = ListFloat_new();
+  for (int i = 0; i < 10000; i++) ListFloat_add(floats, (rand() - RAND_MAX / 2) / 1000.0f);
+  ListFloat *copy = ListFloat_newa(floats->_arr, floats->_size);
+  ListFloat_sort(floats);
+  ListFloat_radixSort(copy);
+  myassert(memcmp(floats->_arr, copy->_arr, floats->_size * sizeof(float)) == 0);
+  ListFloat_delete(floats);
+  ListFloat_delete(copy);
+
+  /* NaN's aren't ordered, but sort still ends. */
+  for (int i = 0; i < 1000; i++) list->_arr[rand() % list->_size] = NAN;
+  for (int i = 0; i < 1000; i++) ListDouble_add(list, i % 3 ? NAN : rand());
+  ListDouble_sort(list);
+  myassert(list->_size == 1009);
+  ListDouble_delete(list);
+}
+
+void test_records() {
+  ListRecord *list = ListRecord_new();
+  for (int i = 0; i < 100000; i++) ListRecord_add(list, (Record){rand() % 1000, i});
+  ListRecordDesc *desc = ListRecordDesc_newa(list->_arr, list->_size);
+
+  ListRecord_sort(list);
+  ListRecordDesc_sort(desc);
+  bool ok = true;
+  for (size_t i = 1; i < list->_size; i++) {
+    ok &= list->_arr[i - 1].key <= list->_arr[i].key;
+    ok &= desc->_arr[i - 1].key >= desc->_arr[i].key;
+  }
+  myassert(ok);
+  /* Every record is still there once. */
+  long ids = 0;
+  for (size_t i = 0; i < list->_size; i++) ids += list->_arr[i].id;
+  myassert(ids == 99999l * 100000 / 2);
+  ListRecord_delete(list);
+  ListRecordDesc_delete(desc);
+}
+
+void test_parallel() {
+  ListLong *list = ListLong_new();
+  fill(list, 3000017, 0);
+  ListLong *copy = ListLong_newa(list->_arr, list->_size);
+  ListLong_radixSort(list);
+  for (size_t nthreads = 2; nthreads <= 7; nthreads++) {
+    memcpy(copy->_arr, list->_arr, list->_size * sizeof(long));
+    for (size_t i = 0; i < list->_size; i++) {
+      size_t j = rand() % list->_size;
+      long tmp = copy->_arr[i];
+      copy->_arr[i] = copy->_arr[j];
+      copy->_arr[j] = tmp;
+    }
+    ListLong_parallelSort(copy, nthreads);
+    myassert(memcmp(list->_arr, copy->_arr, list->_size * sizeof(long)) == 0);
+  }
+  ListLong_delete(list);
+  ListLong_delete(copy);
+
+  ListRecord *records = ListRecord_new();
+  for (int i = 0; i < 2000000; i++) ListRecord_add(records, (Record){rand() % 100, i});
+  ListRecord_parallelSort(records, 0);
+  bool ok = true;
+  for (size_t i = 1; i < records->_size; i++) ok &= records->_arr[i - 1].key <= records->_arr[i].key;
+  myassert(ok);
+  ListRecord_delete(records);
+}
@@ -0,0 +1,168 @@
+#include<stdio.h>
+#include<assert.h>
+#include<stdbool.h>
+#include<limits.h>
+#include "list_types.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+/* Records sorted by key, searched with a comparator. */
+typedef struct Record { long key; int id; } Record;
+#define RECORD_LESS(a, b) ((a).key < (b).key)
+STRUCT_LIST(Record, ListRecord)
+LIST_SORT(Record, ListRecord, RECORD_LESS)
+LIST_SORTED(Record, ListRecord, RECORD_LESS)
+
+/* A sorted list of up to 'size' distinct elements from 'low' to below 'high', each one of
+ * 'step' apart values is taken with a chance of 1 in 'odds'. */
+#define RANDOM_SET(type, List_name, size, step, odds, low, high) ({ \
+  List_name *_set = List_name##_new(); \
+  for (long _v = (low); _set->_size < (size_t)(size) && _v < (high); _v += (step)) \
+    if (rand() % (odds) == 0) List_name##_add(_set, (type)_v); \
+  _set; \
+})
+
+/* Check the set operations of two lists against plain loops, on sizes around the blocks
+ * of the kernels and on lists that gallop. Narrow types get shorter lists. */
+#define SET_TEST(type, List_name, low, high) { \
+  bool ok = true; \
+  size_t sizes[][2] = {{0, 0}, {0, 50}, {1, 1}, {3, 40}, {31, 33}, {100, 100}, \
+    {257, 300}, {1000, 999}, {10, 5000}, {5000, 3}, {2000, 2000}}; \
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) { \
+    for (int odds = 1; odds <= 3; odds++) { \
+      List_name *a = RANDOM_SET(type, List_name, sizes[s][0], 1, odds, low, high); \
+      List_name *b = RANDOM_SET(type, List_name, sizes[s][1], 1, odds + 1, low, high); \
+      List_name *merged = List_name##_merge(a, b); \
+      List_name *both = List_name##_union(a, b); \
+      List_name *common = List_name##_intersection(a, b); \
+      List_name *left = List_name##_difference(a, b); \
+      size_t n_both = 0, n_common = 0, n_left = 0; \
+      ok &= merged->_size == a->_size + b->_size; \
+      for (size_t i = 1; i < merged->_size; i++) ok &= merged->_arr[i - 1] <= merged->_arr[i]; \
+      for (size_t i = 0; i < merged->_size; i++) { \
+        type x = merged->_arr[i]; \
+        if (i > 0 && merged->_arr[i - 1] == x) continue; \
+        bool in_a = List_name##_binarySearch(a, x) >= 0, in_b = List_name##_binarySearch(b, x) >= 0; \
+        ok &= n_both < both->_size && both->_arr[n_both++] == x; \
+        if (in_a && in_b) ok &= n_common < common->_size && common->_arr[n_common++] == x; \
+        if (in_a && !in_b) ok &= n_left < left->_size && left->_arr[n_left++] == x; \
+      } \
+      ok &= n_both == both->_size && n_common == common->_size && n_left == left->_size; \
+      List_name *swapped = List_name##_intersection(b, a); \
+      ok &= swapped->_size == common->_size; \
+      ok &= memcmp(swapped->_arr, common->_arr, common->_size * sizeof(type)) == 0; \
+      List_name##_delete(a); \
+      List_name##_delete(b); \
+      List_name##_delete(merged); \
+      List_name##_delete(both); \
+      List_name##_delete(common); \
+      List_name##_delete(left); \
+      List_name##_delete(swapped); \
+    } \
+  } \
+  myassert(ok); \
+}
+
+void test_bounds();
+void test_eytzinger();
+void test_records();
+
+int main() {
+  srand(9);
+  printf("Testing bounds:\n");
+  test_bounds();
+  printf("Testing Eytzinger copies:\n");
+  test_eytzinger();
+  printf("Testing set operations:\n");
+  SET_TEST(signed char, ListSChar, -128, 128)
+  SET_TEST(unsigned char, ListUChar, 0, 256)
+  SET_TEST(short, ListShort, -3000, 32768)
+  SET_TEST(unsigned short, ListUShort, 60000, 65536)
+  SET_TEST(int, ListInt, -5000, INT_MAX)
+  SET_TEST(unsigned int, ListUInt, 4000000000, UINT_MAX)
+  SET_TEST(long long, ListLLong, -5000, LONG_MAX)
+  SET_TEST(size_t, ListSizeT, 0, LONG_MAX)
+  SET_TEST(double, ListDouble, -5000, LONG_MAX)
+  printf("Testing records:\n");
+  test_records();
+  printf("done!\n");
+  return 0;
+}
+
+void test_bounds() {
+  /* Every value around a list with repeated elements, on every size up to 100. */
+  bool ok = true;
+  ListInt *list = ListInt_new();
+  for (size_t size = 0; size <= 100; size++) {
+    ListInt_resize(list, size, 0);
+    for (size_t i = 0; i < size; i++) list->_arr[i] = (int)(i / 3 * 2);
+    for (int x = -2; x <= (int)size + 2; x++) {
+      size_t lower = 0, upper = 0;
+      while (lower < size && list->_arr[lower] < x) lower++;
+      while (upper < size && list->_arr[upper] <= x) upper++;
+      ok &= ListInt_lowerBound(list, x) == lower;
+      ok &= ListInt_upperBound(list, x) == upper;
+      ok &= ListInt_binarySearch(list, x) == (lower < upper ? (ssize_t)lower : -1);
+    }
+  }
+  myassert(ok);
+  ListInt_delete(list);
+
+  ListUInt *limits = ListUInt_new();
+  ListUInt_add(limits, 0);
+  ListUInt_add(limits, UINT32_MAX);
+  myassert(ListUInt_lowerBound(limits, UINT32_MAX) == 1 && ListUInt_upperBound(limits, UINT32_MAX) == 2);
+  myassert(ListUInt_binarySearch(limits, 0) == 0 && ListUInt_binarySearch(limits, 1) == -1);
+  ListUInt_delete(limits);
+}
+
+void test_eytzinger() {
+  /* The copy finds the same bounds as the list, on sizes that fill and don't fill the last level. */
+  bool ok = true;
+  size_t sizes[] = {0, 1, 2, 3, 7, 8, 15, 16, 100, 1023, 1024, 100000};
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) {
+    ListLong *list = RANDOM_SET(long, ListLong, sizes[s], 2, 2, -1000, LONG_MAX);
+    ListLong_eytzinger_t *tree = ListLong_newEytzinger(list);
+    for (int q = 0; q < 2000; q++) {
+      long x = list->_size ? list->_arr[rand() % list->_size] + rand() % 3 - 1 : q;
+      size_t index = ListLong_lowerBound(list, x);
+      const long *bound = ListLong_eytzingerLowerBound(tree, x);
+      ok &= index == list->_size ? bound == NULL : bound && *bound == list->_arr[index];
+      ok &= ListLong_eytzingerContains(tree, x) == (ListLong_binarySearch(list, x) >= 0);
+    }
+    ListLong_deleteEytzinger(tree);
+    ListLong_delete(list);
+  }
+  myassert(ok);
+}
+
+void test_records() {
+  ListRecord *list = ListRecord_new();
+  for (int i = 0; i < 1000; i++) ListRecord_add(list, (Record){rand() % 100, i});
+  ListRecord_sort(list);
+  ssize_t index = ListRecord_binarySearch(list, (Record){50, 0});
+  myassert(index == -1 || list->_arr[index].key == 50);
+  myassert(index <= 0 || list->_arr[index - 1].key < 50);
+  size_t lower = ListRecord_lowerBound(list, (Record){50, 0});
+  size_t upper = ListRecord_upperBound(list, (Record){50, 0});
+  bool ok = true;
+  for (size_t i = lower; i < upper; i++) ok &= list->_arr[i].key == 50;
+  myassert(ok && (upper == list->_size || list->_arr[upper].key > 50));
+
+  /* Merging keeps the records of the first list before equal ones of the second. */
+  ListRecord *other = ListRecord_newa(list->_arr, list->_size);
+  for (size_t i = 0; i < other->_size; i++) other->_arr[i].id = -1;
+  ListRecord *merged = ListRecord_merge(list, other);
+  for (size_t i = 1; i < merged->_size; i++) {
+    ok &= merged->_arr[i - 1].key <= merged->_arr[i].key;
+    if (merged->_arr[i - 1].key == merged->_arr[i].key) ok &= merged->_arr[i - 1].id >= 0 || merged->_arr[i].id < 0;
+  }
+  myassert(ok && merged->_size == 2000);
+  ListRecord_delete(list);
+  ListRecord_delete(other);
+  ListRecord_delete(merged);
+}
@@ -0,0 +1,244 @@
+#include<stdio.h>
+#include<assert.h>
+#include<pthread.h>
+#include "persistentmap.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+unsigned long hash(const long *key) { return *key; }
+/* Every key has the same hash, all of them end in one collision node. */
+unsigned long hash_same(const long *key) { return 7; }
+bool keycmp(const long *key1, const long *key2) { return *key1 == *key2; }
+
+PersistentMap(Versions, long, long, unsigned long, hash, keycmp)
+PersistentMap(Colliding, long, long, unsigned long, hash_same, keycmp)
+
+void test_basic();
+void test_snapshots();
+void test_collisions();
+void test_random();
+void test_readers();
+
+int main() {
+  printf("Testing basic operations:\n");
+  test_basic();
+  printf("Testing snapshots:\n");
+  test_snapshots();
+  printf("Testing colliding hashes:\n");
+  test_collisions();
+  printf("Testing random operations:\n");
+  test_random();
+  printf("Testing readers on other threads:\n");
+  test_readers();
+  printf("done!\n");
+  return 0;
+}
+
+void test_basic() {
+  Versions *map = Versions_new();
+  long key, val;
+  myassert(map != NULL);
+  key = 1;
+  myassert(Versions_get(map, &key) == NULL);
+  myassert(Versions_remove(map, &key) == ERR_KEYNOTFOUND);
+
+  val = 10;
+  myassert(Versions_put(map, &key, &val) == HMP_ADD);
+  val = 11;
+  myassert(Versions_put(map, &key, &val) == HMP_SET);
+  myassert(*Versions_get(map, &key) == 11);
+  for (key = 2; key < 1000; key++) {
+    val = key * 10;
+    myassert(Versions_put(map, &key, &val) == HMP_ADD);
+  }
+  myassert(map->size == 999);
+  key = 500;
+  myassert(*Versions_get(map, &key) == 5000);
+  myassert(Versions_remove(map, &key) == DS_SUCCESS);
+  myassert(!Versions_has(map, &key));
+  myassert(Versions_remove(map, &key) == ERR_KEYNOTFOUND);
+  myassert(map->size == 998);
+  for (key = 1; key < 1000; key++) Versions_remove(map, &key);
+  myassert(map->size == 0 && map->root == NULL);
+  Versions_free(map);
+}
+
+static void sum_values(const long *key, const long *val, void *ctx) {
+  *(long*)ctx += *val;
+}
+
+void test_snapshots() {
+  Versions *map = Versions_new();
+  long key, val, sum;
+  for (key = 0; key < 100; key++) {
+    val = key;
+    Versions_put(map, &key, &val);
+  }
+  Versions_view_t *first = Versions_snapshot(map);
+  myassert(first != NULL && first->size == 100);
+  /* The views share the root until the writer changes the map. */
+  myassert(first->root == map->root);
+
+  for (key = 0; key < 50; key++) Versions_remove(map, &key);
+  for (key = 50; key < 100; key++) {
+    val = -key;
+    Versions_put(map, &key, &val);
+  }
+  key = 1000; val = 1000;
+  Versions_put(map, &key, &val);
+  Versions_view_t *second = Versions_snapshot(map);
+  myassert(first->root != map->root);
+
+  /* The first view still sees the map as it was. */
+  sum = 0;
+  Versions_view_for_each(first, sum_values, &sum);
+  myassert(sum == 99 * 100 / 2);
+  key = 10;
+  myassert(*Versions_view_get(first, &key) == 10);
+  myassert(!Versions_view_has(second, &key));
+  key = 60;
+  myassert(*Versions_view_get(first, &key) == 60);
+  myassert(*Versions_view_get(second, &key) == -60);
+  key = 1000;
+  myassert(!Versions_view_has(first, &key));
+
+  /* Views outlive the map, and every reference has to be released. */
+  Versions_view_t *shared = Versions_view_retain(second);
+  Versions_free(map);
+  Versions_view_release(first);
+  Versions_view_release(second);
+  sum = 0;
+  Versions_view_for_each(shared, sum_values, &sum);
+  myassert(sum == 1000 - (50 + 99) * 50 / 2);
+  Versions_view_release(shared);
+}
+
+void test_collisions() {
+  Colliding *map = Colliding_new();
+  long key, val;
+  for (key = 0; key < 20; key++) {
+    val = key;
+    myassert(Colliding_put(map, &key, &val) == HMP_ADD);
+  }
+  Colliding_view_t *view = Colliding_snapshot(map);
+  for (key = 0; key < 20; key += 2) myassert(Colliding_remove(map, &key) == DS_SUCCESS);
+  key = 3; val = 33;
+  myassert(Colliding_put(map, &key, &val) == HMP_SET);
+  myassert(*Colliding_get(map, &key) == 33);
+  myassert(*Colliding_view_get(view, &key) == 3);
+  key = 4;
+  myassert(!Colliding_has(map, &key) && Colliding_view_has(view, &key));
+  for (key = 1; key < 19; key += 2) Colliding_remove(map, &key);
+  /* The last entry is pulled up from the collision node to the root. */
+  key = 19;
+  myassert(map->size == 1 && *Colliding_get(map, &key) == 19);
+  myassert(map->root->count == 1 && map->root->datamap != 0);
+  Colliding_view_release(view);
+  Colliding_free(map);
+}
+
+static unsigned long next_random(unsigned long *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+#define RANDOM_KEYS 512
+#define RANDOM_VERSIONS 8
+
+void test_random() {
+  /* Compare every version with a plain array of it's contents. */
+  static long expected[RANDOM_VERSIONS][RANDOM_KEYS];
+  Versions_view_t *views[RANDOM_VERSIONS];
+  long current[RANDOM_KEYS];
+  unsigned long state = 88172645463325252ul;
+  Versions *map = Versions_new();
+  bool ok = true;
+  for (long i = 0; i < RANDOM_KEYS; i++) current[i] = -1;
+
+  for (int v = 0; v < RANDOM_VERSIONS; v++) {
+    for (int op = 0; op < 2000; op++) {
+      /* Spread the keys over the whole hash, and over many levels. */
+      long index = next_random(&state) % RANDOM_KEYS;
+      long key = (long)(index * 0x9e3779b97f4a7c1ul);
+      if (next_random(&state) % 3 == 0) {
+        ok &= Versions_remove(map, &key) == (current[index] >= 0 ? DS_SUCCESS : ERR_KEYNOTFOUND);
+        current[index] = -1;
+      } else {
+        long val = next_random(&state) % 1000;
+        ok &= Versions_put(map, &key, &val) == (current[index] >= 0 ? HMP_SET : HMP_ADD);
+        current[index] = val;
+      }
+    }
+    memcpy(expected[v], current, sizeof(current));
+    views[v] = Versions_snapshot(map);
+  }
+  for (int v = 0; v < RANDOM_VERSIONS; v++) {
+    size_t size = 0;
+    for (long index = 0; index < RANDOM_KEYS; index++) {
+      long key = (long)(index * 0x9e3779b97f4a7c1ul);
+      const long *val = Versions_view_get(views[v], &key);
+      ok &= expected[v][index] >= 0 ? val != NULL && *val == expected[v][index] : val == NULL;
+      size += expected[v][index] >= 0;
+    }
+    ok &= views[v]->size == size;
+  }
+  myassert(ok);
+  for (int v = 0; v < RANDOM_VERSIONS; v++) Versions_view_release(views[v]);
+  Versions_free(map);
+}
+
+#define READERS 3
+#define READER_KEYS 2000
+
+static Versions_view_t *published;
+static pthread_mutex_t published_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* A reader takes the latest view, and checks that it's consistent: every
+ * version has keys [0, size) with the value size. */
+static void* reader(void *arg) {
+  bool *ok = arg;
+  for (int round = 0; round < 200; round++) {
+    pthread_mutex_lock(&published_lock);
+    Versions_view_t *view = Versions_view_retain(published);
+    pthread_mutex_unlock(&published_lock);
+    for (long key = 0; key < (long)view->size; key += 7) {
+      const long *val = Versions_view_get(view, &key);
+      *ok &= val != NULL && *val == (long)view->size;
+    }
+    Versions_view_release(view);
+  }
+  return NULL;
+}
+
+void test_readers() {
+  Versions *map = Versions_new();
+  pthread_t threads[READERS];
+  bool ok[READERS];
+  published = Versions_snapshot(map);
+  for (int i = 0; i < READERS; i++) {
+    ok[i] = true;
+    pthread_create(&threads[i], NULL, reader, &ok[i]);
+  }
+  for (long size = 1; size <= READER_KEYS; size++) {
+    /* Rewrite every value to the new size, then publish the version. */
+    for (long key = 0; key < size; key++) Versions_put(map, &key, &size);
+    Versions_view_t *view = Versions_snapshot(map);
+    pthread_mutex_lock(&published_lock);
+    Versions_view_t *old = published;
+    published = view;
+    pthread_mutex_unlock(&published_lock);
+    Versions_view_release(old);
+  }
+  for (int i = 0; i < READERS; i++) {
+    pthread_join(threads[i], NULL);
+    myassert(ok[i]);
+  }
+  Versions_view_release(published);
+  Versions_free(map);
+}
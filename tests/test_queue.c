@@ -0,0 +1,155 @@
+#include<stdio.h>
+#include<assert.h>
+#include<stdbool.h>
+#include<pthread.h>
+#include "queue.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+STRUCT_SPSC_QUEUE(long, SpscLong)
+STRUCT_MPMC_QUEUE(long, MpmcLong)
+
+void test_spsc_basic();
+void test_mpmc_basic();
+void test_spsc_threads();
+void test_mpmc_threads();
+
+int main() {
+  printf("Testing the SPSC queue:\n");
+  test_spsc_basic();
+  printf("Testing the MPMC queue:\n");
+  test_mpmc_basic();
+  printf("Testing the SPSC queue on two threads:\n");
+  test_spsc_threads();
+  printf("Testing the MPMC queue on many threads:\n");
+  test_mpmc_threads();
+  printf("done!\n");
+  return 0;
+}
+
+/* The same checks for both queues, they have the same API. */
+#define BASIC_TEST(Queue_name) { \
+  Queue_name *queue = Queue_name##_new(5); \
+  long value, values[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}, out[10]; \
+  myassert(Queue_name##_dequeue(queue, &value) == 0); \
+  for (long i = 0; i < 8; i++) myassert(Queue_name##_enqueue(queue, i) == 1); \
+  myassert(Queue_name##_enqueue(queue, 8) == 0); \
+  myassert(Queue_name##_size(queue) == 8); \
+  myassert(Queue_name##_dequeue(queue, &value) == 1 && value == 0); \
+  myassert(Queue_name##_dequeueArray(queue, out, 3) == 3 && out[0] == 1 && out[2] == 3); \
+  /* Only 4 fit, wrapping around the end of the ring. */ \
+  myassert(Queue_name##_enqueueArray(queue, values, 10) == 4); \
+  myassert(Queue_name##_dequeueArray(queue, out, 10) == 8); \
+  myassert(out[0] == 4 && out[3] == 7 && out[4] == 0 && out[7] == 3); \
+  myassert(Queue_name##_size(queue) == 0); \
+  Queue_name##_delete(queue); \
+}
+
+void test_spsc_basic() BASIC_TEST(SpscLong)
+void test_mpmc_basic() BASIC_TEST(MpmcLong)
+
+#define THREAD_ITEMS 200000
+
+static void* spsc_producer(void *arg) {
+  SpscLong *queue = arg;
+  long batch[7];
+  for (long next = 0; next < THREAD_ITEMS;) {
+    size_t size = next % 7 + 1;
+    if (next + (long)size > THREAD_ITEMS) size = THREAD_ITEMS - next;
+    for (size_t i = 0; i < size; i++) batch[i] = next + i;
+    size_t sent = SpscLong_enqueueArray(queue, batch, size);
+    if (!sent) sched_yield();
+    next += sent;
+  }
+  return NULL;
+}
+
+void test_spsc_threads() {
+  SpscLong *queue = SpscLong_new(64);
+  pthread_t producer;
+  pthread_create(&producer, NULL, spsc_producer, queue);
+  bool ok = true;
+  long expected = 0, out[5];
+  while (expected < THREAD_ITEMS) {
+    size_t got = expected % 2 ? SpscLong_dequeueArray(queue, out, 5) :
+      SpscLong_dequeue(queue, out);
+    if (!got) sched_yield();
+    for (size_t i = 0; i < got; i++) ok &= out[i] == expected++;
+  }
+  pthread_join(producer, NULL);
+  myassert(ok && SpscLong_size(queue) == 0);
+  SpscLong_delete(queue);
+}
+
+#define PRODUCERS 3
+#define CONSUMERS 3
+
+static MpmcLong *mpmc;
+static atomic_long consumed;
+
+/* A producer sends it's index in the low bits and a counter above them. */
+static void* mpmc_producer(void *arg) {
+  long id = (long)(intptr_t)arg;
+  long batch[4];
+  for (long next = 0; next < THREAD_ITEMS;) {
+    size_t size = id % 2 ? 1 : 4;
+    if (next + (long)size > THREAD_ITEMS) size = THREAD_ITEMS - next;
+    for (size_t i = 0; i < size; i++) batch[i] = (next + i) * PRODUCERS + id;
+    size_t sent = MpmcLong_enqueueArray(mpmc, batch, size);
+    if (!sent) sched_yield();
+    next += sent;
+  }
+  return NULL;
+}
+
+typedef struct ConsumerResult {
+  long sum;
+  bool ordered;
+} ConsumerResult;
+
+/* Every consumer sees the elements of every producer in order. */
+static void* mpmc_consumer(void *arg) {
+  ConsumerResult *result = arg;
+  long last[PRODUCERS], out[3];
+  for (int i = 0; i < PRODUCERS; i++) last[i] = -1;
+  result->sum = 0;
+  result->ordered = true;
+  while (atomic_load(&consumed) < (long)PRODUCERS * THREAD_ITEMS) {
+    size_t got = MpmcLong_dequeueArray(mpmc, out, 3);
+    if (!got) sched_yield();
+    for (size_t i = 0; i < got; i++) {
+      long id = out[i] % PRODUCERS, counter = out[i] / PRODUCERS;
+      result->ordered &= counter > last[id];
+      last[id] = counter;
+      result->sum += out[i];
+    }
+    atomic_fetch_add(&consumed, got);
+  }
+  return NULL;
+}
+
+void test_mpmc_threads() {
+  mpmc = MpmcLong_new(128);
+  pthread_t producers[PRODUCERS], consumers[CONSUMERS];
+  ConsumerResult results[CONSUMERS];
+  for (long i = 0; i < CONSUMERS; i++) pthread_create(&consumers[i], NULL, mpmc_consumer, &results[i]);
+  for (long i = 0; i < PRODUCERS; i++) {
+    pthread_create(&producers[i], NULL, mpmc_producer, (void*)(intptr_t)i);
+  }
+  for (int i = 0; i < PRODUCERS; i++) pthread_join(producers[i], NULL);
+  for (int i = 0; i < CONSUMERS; i++) pthread_join(consumers[i], NULL);
+
+  long sum = 0, n = (long)PRODUCERS * THREAD_ITEMS;
+  bool ordered = true;
+  for (int i = 0; i < CONSUMERS; i++) {
+    sum += results[i].sum;
+    ordered &= results[i].ordered;
+  }
+  myassert(ordered);
+  myassert(atomic_load(&consumed) == n && sum == n * (n - 1) / 2);
+  MpmcLong_delete(mpmc);
+}
@@ -0,0 +1,196 @@
+#include<stdio.h>
+#include<assert.h>
+#include "strhashmap.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+StrHashMap(Words, int)
+
+void test_basic();
+void test_long_keys();
+void test_random();
+
+int main() {
+  printf("Testing basic operations:\n");
+  test_basic();
+  printf("Testing long keys:\n");
+  test_long_keys();
+  printf("Testing random operations:\n");
+  test_random();
+  printf("done!\n");
+  return 0;
+}
+
+void test_basic() {
+  Words map;
+  int val;
+  myassert(Words_init(&map, 0) == DS_SUCCESS);
+
+  char key[32];
+  strcpy(key, "hello");
+  val = 1;
+  myassert(Words_put(&map, key, &val) == HMP_ADD);
+  /* The map owns a copy of the key. */
+  strcpy(key, "world");
+  myassert(Words_has(&map, "hello") && !Words_has(&map, "world"));
+  val = 2;
+  myassert(Words_put(&map, "hello", &val) == HMP_SET);
+  myassert(*Words_get(&map, "hello") == 2);
+  myassert(Words_get(&map, "hell") == NULL);
+  myassert(Words_get(&map, "") == NULL);
+  val = 0;
+  myassert(Words_put(&map, "", &val) == HMP_ADD && *Words_get(&map, "") == 0);
+  /* The longest inline key, and the shortest long one. */
+  myassert(Words_put(&map, "abcdefghijklmnopqrstuvw", &val) == HMP_ADD);
+  myassert(map.arena_size == 0);
+  myassert(Words_put(&map, "abcdefghijklmnopqrstuvwx", &val) == HMP_ADD);
+  myassert(map.arena_size == 25);
+  myassert(Words_has(&map, "abcdefghijklmnopqrstuvw"));
+  myassert(Words_has(&map, "abcdefghijklmnopqrstuvwx"));
+  myassert(!Words_has(&map, "abcdefghijklmnopqrstuvwy"));
+
+  myassert(Words_remove(&map, "hello") == DS_SUCCESS);
+  myassert(Words_remove(&map, "hello") == ERR_KEYNOTFOUND);
+  myassert(map.size == 3);
+
+  size_t count = 0, bucket;
+  Words_entry_t *entry;
+  map_for_each_entry(&map, entry, bucket) {
+    assert(strlen(strmap_entry_key(&map, entry)) == entry->key.len);
+    count++;
+  }
+  myassert(count == 3);
+
+  Words_clear(&map);
+  myassert(map.size == 0 && !Words_has(&map, "") && map.arena_size == 0);
+  Words_destroy(&map);
+}
+
+void test_long_keys() {
+  Words *map = Words_new();
+  char key[128];
+  /* Long keys that share their prefix, only the arena tells them apart. */
+  for (int i = 0; i < 2000; i++) {
+    sprintf(key, "a long key with a shared prefix, number %d", i);
+    Words_put(map, key, &i);
+  }
+  bool ok = true;
+  for (int i = 0; i < 2000; i++) {
+    sprintf(key, "a long key with a shared prefix, number %d", i);
+    int *val = Words_get(map, key);
+    ok = ok && val != NULL && *val == i;
+  }
+  myassert(ok);
+
+  /* Removed keys are dropped from the arena when the map resizes. */
+  for (int i = 0; i < 2000; i++) {
+    if (i % 4 == 0) continue;
+    sprintf(key, "a long key with a shared prefix, number %d", i);
+    Words_remove(map, key);
+  }
+  size_t before = map->arena_size;
+  myassert(Words_resize(map, map->cap * 2) == DS_SUCCESS);
+  myassert(map->arena_garbage == 0 && map->arena_size < before / 2);
+  for (int i = 0; i < 2000; i++) {
+    sprintf(key, "a long key with a shared prefix, number %d", i);
+    int *val = Words_get(map, key);
+    ok = ok && (i % 4 ? val == NULL : val != NULL && *val == i);
+  }
+  myassert(ok);
+  Words_free(map);
+
+  /* Removing and putting long keys at a steady size doesn't grow the arena. */
+  map = Words_new();
+  for (int i = 0; i < 1000; i++) {
+    sprintf(key, "a long key with a shared prefix, number %d", i);
+    Words_put(map, key, &i);
+  }
+  size_t arena_cap = map->arena_cap;
+  for (int i = 0; i < 200000; i++) {
+    sprintf(key, "a long key with a shared prefix, number %d", i);
+    Words_remove(map, key);
+    sprintf(key, "a long key with a shared prefix, number %d", i + 1000);
+    Words_put(map, key, &i);
+  }
+  myassert(map->size == 1000 && map->arena_cap <= 2 * arena_cap);
+  Words_free(map);
+
+  /* Shrinking moves the entries past the new capacity below it. */
+  map = Words_new();
+  for (int i = 0; i < 1000; i++) {
+    sprintf(key, i % 2 ? "k%d" : "a long key with a shared prefix, number %d", i);
+    Words_put(map, key, &i);
+  }
+  for (int i = 0; i < 990; i++) {
+    sprintf(key, i % 2 ? "k%d" : "a long key with a shared prefix, number %d", i);
+    Words_remove(map, key);
+  }
+  myassert(Words_resize(map, 11) == DS_SUCCESS && map->cap == 11);
+  for (int i = 0; i < 1000; i++) {
+    sprintf(key, i % 2 ? "k%d" : "a long key with a shared prefix, number %d", i);
+    int *val = Words_get(map, key);
+    ok = ok && (i < 990 ? val == NULL : val != NULL && *val == i);
+  }
+  myassert(ok);
+  /* The empty entries are reused before the map grows again. */
+  for (int i = 0; i < 100; i++) {
+    sprintf(key, "k%d", i * 2);
+    Words_put(map, key, &i);
+  }
+  for (int i = 0; i < 100; i++) {
+    sprintf(key, "k%d", i * 2);
+    int *val = Words_get(map, key);
+    ok = ok && val != NULL && *val == i;
+  }
+  myassert(ok && map->size == 110);
+  /* Shrinking to the size leaves room for the next put. */
+  int one = 1;
+  myassert(Words_resize(map, 1) == ERR_TOOSMALL);
+  myassert(Words_resize(map, map->size) == DS_SUCCESS && map->cap > map->size);
+  myassert(Words_put(map, "k1", &one) == HMP_ADD && map->size == 111);
+  Words_free(map);
+}
+
+#define RANGE 1000
+#define OPS 200000
+
+void test_random() {
+  Words *map = Words_new();
+  static int expected[RANGE];
+  static bool present[RANGE];
+  size_t size = 0;
+  char key[64];
+  srand(99);
+
+  bool ok = true;
+  for (int op = 0; op < OPS && ok; op++) {
+    int i = rand() % RANGE;
+    /* Short and long keys mixed. */
+    sprintf(key, i % 2 ? "k%d" : "a much longer key number %d", i);
+    int val = rand();
+    switch (rand() % 3) {
+    case 0:
+      ok = Words_put(map, key, &val) == (present[i] ? HMP_SET : HMP_ADD);
+      if (!present[i]) size++;
+      present[i] = true;
+      expected[i] = val;
+      break;
+    case 1:
+      ok = Words_remove(map, key) == (present[i] ? DS_SUCCESS : ERR_KEYNOTFOUND);
+      if (present[i]) size--;
+      present[i] = false;
+      break;
+    default: {
+      int *got = Words_get(map, key);
+      ok = present[i] ? got != NULL && *got == expected[i] : got == NULL;
+    }
+    }
+    ok = ok && map->size == size;
+  }
+  myassert(ok);
+  Words_free(map);
+}
@@ -0,0 +1,119 @@
+#include<stdio.h>
+#include<assert.h>
+#include<stdbool.h>
+#include "list_types.h"
+#include "strsort.h"
+
+#define myassert(expression)  { \
+  printf("Asserting line: `%s`: ", #expression); \
+  assert(expression); \
+  printf("Success!\n"); \
+}
+
+LIST_SORT_STRINGS(ListCharPtr)
+
+int compare_strings(const void *a, const void *b) {
+  return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/* Sort the strings, and check them against qsort and strcmp. */
+bool check_sort(char **strings, size_t size) {
+  char **expected = malloc((size + 1) * sizeof(char*));
+  memcpy(expected, strings, size * sizeof(char*));
+  qsort(expected, size, sizeof(char*), compare_strings);
+  bool ok = ds_strsort(strings, size) == DS_SUCCESS;
+  for (size_t i = 0; i < size; i++) ok &= strcmp(strings[i], expected[i]) == 0;
+  free(expected);
+  return ok;
+}
+
+/* A random string of up to `length` bytes from a small alphabet, with high
+ * bytes, so there are many common prefixes. */
+char *random_string(size_t length) {
+  size_t size = rand() % (length + 1);
+  char *str = malloc(size + 1);
+  for (size_t i = 0; i < size; i++) str[i] = "ab\x80\xff"[rand() % 4];
+  str[size] = '\0';
+  return str;
+}
+
+void test_random();
+void test_prefixes();
+void test_patterns();
+void test_list();
+
+int main() {
+  srand(9);
+  printf("Testing random strings:\n");
+  test_random();
+  printf("Testing common prefixes:\n");
+  test_prefixes();
+  printf("Testing patterns:\n");
+  test_patterns();
+  printf("Testing lists:\n");
+  test_list();
+  printf("done!\n");
+  return 0;
+}
+
+void test_random() {
+  bool ok = true;
+  char *strings[300];
+  for (size_t size = 0; size <= 300; size += 7) {
+    for (size_t length = 1; length <= 20; length += 6) {
+      for (size_t i = 0; i < size; i++) strings[i] = random_string(length);
+      ok &= check_sort(strings, size);
+      for (size_t i = 0; i < size; i++) free(strings[i]);
+    }
+  }
+  myassert(ok);
+}
+
+void test_prefixes() {
+  /* Log keys, a long common prefix and lengths around the cached 8 bytes. */
+  size_t size = 100000;
+  char **strings = malloc(size * sizeof(char*));
+  for (size_t i = 0; i < size; i++) {
+    strings[i] = malloc(64);
+    switch (i % 4) {
+      case 0: sprintf(strings[i], "2024-06-01T12:00:00 host-%d", rand() % 500); break;
+      case 1: sprintf(strings[i], "2024-06-01T12:00:00 host-%d.%d", rand() % 50, rand() % 50); break;
+      case 2: sprintf(strings[i], "%.*s", rand() % 17, "2024-06-01T12:00:00"); break;
+      case 3: sprintf(strings[i], "12345678"); break;
+    }
+  }
+  myassert(check_sort(strings, size));
+  for (size_t i = 0; i < size; i++) free(strings[i]);
+  free(strings);
+}
+
+void test_patterns() {
+  /* Sorted, reversed, organ pipe and sawtooth numbers, in the first cached
+   * bytes and behind a common prefix. */
+  bool ok = true;
+  size_t size = 200000;
+  char **strings = malloc(size * sizeof(char*));
+  for (int pattern = 0; pattern < 8; pattern++) {
+    for (size_t i = 0; i < size; i++) {
+      size_t n = pattern % 4 == 0 ? i : pattern % 4 == 1 ? size - i :
+        pattern % 4 == 2 ? (i < size / 2 ? i : size - i) : i % 1000;
+      strings[i] = malloc(32);
+      sprintf(strings[i], "%s%08zu", pattern < 4 ? "" : "common prefix ", n);
+    }
+    ok &= check_sort(strings, size);
+    for (size_t i = 0; i < size; i++) free(strings[i]);
+  }
+  free(strings);
+  myassert(ok);
+}
+
+void test_list() {
+  ListCharPtr *list = ListCharPtr_new();
+  char *words[] = {"pear", "apple", "", "apples", "applesauce", "apple", "b"};
+  for (int i = 0; i < 7; i++) ListCharPtr_add(list, words[i]);
+  ListCharPtr_sortStrings(list);
+  myassert(strcmp(list->_arr[0], "") == 0 && strcmp(list->_arr[1], "apple") == 0);
+  myassert(strcmp(list->_arr[2], "apple") == 0 && strcmp(list->_arr[3], "apples") == 0);
+  myassert(strcmp(list->_arr[4], "applesauce") == 0 && strcmp(list->_arr[6], "pear") == 0);
+  ListCharPtr_delete(list);
+}